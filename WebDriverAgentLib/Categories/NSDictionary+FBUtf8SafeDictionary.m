@@ -14,33 +14,55 @@ const unichar REPLACER = 0xfffd;
 
 - (instancetype)fb_utf8SafeStringWithReplacement:(unichar)replacement
 {
-  if ([self canBeConvertedToEncoding:NSUTF8StringEncoding]) {
+  CFStringRef cfSelf = (__bridge CFStringRef)self;
+  if (NULL != CFStringGetCStringPtr(cfSelf, kCFStringEncodingASCII)) {
+    // Pure ASCII strings are always safe
     return self;
   }
 
-  NSData *data = [self dataUsingEncoding:NSUTF8StringEncoding allowLossyConversion:YES];
-  NSString *convertedString = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
-  NSMutableString *result = [NSMutableString string];
-  NSString *replacementStr = [NSString stringWithCharacters:&replacement length:1];
-  NSUInteger originalIdx = 0;
-  NSUInteger convertedIdx = 0;
-  while (originalIdx < [self length] && convertedIdx < [convertedString length]) {
-    unichar originalChar = [self characterAtIndex:originalIdx];
-    unichar convertedChar = [convertedString characterAtIndex:convertedIdx];
+  NSUInteger length = self.length;
+  // Scan the internal storage directly if it is available, so clean strings are never copied
+  const unichar *chars = CFStringGetCharactersPtr(cfSelf);
+  unichar *buffer = NULL;
+  if (NULL == chars) {
+    buffer = (unichar *)malloc(length * sizeof(unichar));
+    if (NULL == buffer) {
+      return self;
+    }
+    [self getCharacters:buffer range:NSMakeRange(0, length)];
+    chars = buffer;
+  }
 
-    if (originalChar == convertedChar) {
-      [result appendString:[NSString stringWithCharacters:&originalChar length:1]];
-      originalIdx++;
-      convertedIdx++;
+  unichar *result = NULL;
+  for (NSUInteger i = 0; i < length; i++) {
+    unichar c = chars[i];
+    if (!CFStringIsSurrogateHighCharacter(c) && !CFStringIsSurrogateLowCharacter(c)) {
       continue;
     }
-
-    while (originalChar != convertedChar && originalIdx < [self length]) {
-      [result appendString:replacementStr];
-      originalChar = [self characterAtIndex:++originalIdx];
+    if (CFStringIsSurrogateHighCharacter(c) && i + 1 < length && CFStringIsSurrogateLowCharacter(chars[i + 1])) {
+      // Skip the valid surrogate pair
+      i++;
+      continue;
+    }
+    if (NULL == result) {
+      // All the chars before the first unpaired surrogate are already in place
+      if (NULL == buffer) {
+        buffer = (unichar *)malloc(length * sizeof(unichar));
+        if (NULL == buffer) {
+          return self;
+        }
+        memcpy(buffer, chars, length * sizeof(unichar));
+      }
+      result = buffer;
     }
+    result[i] = replacement;
   }
-  return result.copy;
+
+  if (NULL == result) {
+    free(buffer);
+    return self;
+  }
+  return [[NSString alloc] initWithCharactersNoCopy:result length:length freeWhenDone:YES];
 }
 
 @end
@@ -8,23 +8,115 @@
 
 #import "NSString+FBXMLSafeString.h"
 
+// Char ::= #x9 | #xA | #xD | [#x20-#xD7FF] | [#xE000-#xFFFD] | [#x10000-#x10FFFF]
+// Chars beyond #xFFFF are represented by surrogate pairs and are checked separately
+static inline BOOL FBIsValidXMLCodeUnit(unichar c)
+{
+  if (c >= 0x20) {
+    return c <= 0xD7FF || (c >= 0xE000 && c <= 0xFFFD);
+  }
+  return c == 0x9 || c == 0xA || c == 0xD;
+}
+
+/**
+ Walks through the string chars and counts invalid ones. If `output` is provided
+ then the string is also copied into it with each invalid char replaced by `replacement`.
+ */
+static NSUInteger FBProcessXMLChars(CFStringInlineBuffer *input,
+                                    CFIndex length,
+                                    unichar *output,
+                                    const unichar *replacement,
+                                    NSUInteger replacementLength)
+{
+  NSUInteger invalidCount = 0;
+  NSUInteger outputIdx = 0;
+  for (CFIndex i = 0; i < length; i++) {
+    unichar c = CFStringGetCharacterFromInlineBuffer(input, i);
+    if (CFStringIsSurrogateHighCharacter(c) && i + 1 < length
+        && CFStringIsSurrogateLowCharacter(CFStringGetCharacterFromInlineBuffer(input, i + 1))) {
+      if (NULL != output) {
+        output[outputIdx++] = c;
+        output[outputIdx++] = CFStringGetCharacterFromInlineBuffer(input, i + 1);
+      }
+      i++;
+      continue;
+    }
+    if (FBIsValidXMLCodeUnit(c)) {
+      if (NULL != output) {
+        output[outputIdx++] = c;
+      }
+      continue;
+    }
+    invalidCount++;
+    if (NULL != output && replacementLength > 0) {
+      memcpy(output + outputIdx, replacement, replacementLength * sizeof(unichar));
+      outputIdx += replacementLength;
+    }
+  }
+  return invalidCount;
+}
+
+/**
+ Builds the sanitized string without intermediate buffers. This is only used
+ if there is not enough memory to allocate them
+ */
+static NSString *FBXMLSafeStringWithAppendedRuns(NSString *string,
+                                                 CFStringInlineBuffer *input,
+                                                 CFIndex length,
+                                                 NSString *replacement)
+{
+  NSMutableString *result = [NSMutableString string];
+  CFIndex runStart = 0;
+  for (CFIndex i = 0; i < length; i++) {
+    unichar c = CFStringGetCharacterFromInlineBuffer(input, i);
+    if (CFStringIsSurrogateHighCharacter(c) && i + 1 < length
+        && CFStringIsSurrogateLowCharacter(CFStringGetCharacterFromInlineBuffer(input, i + 1))) {
+      i++;
+      continue;
+    }
+    if (FBIsValidXMLCodeUnit(c)) {
+      continue;
+    }
+    [result appendString:[string substringWithRange:NSMakeRange((NSUInteger)runStart, (NSUInteger)(i - runStart))]];
+    [result appendString:replacement];
+    runStart = i + 1;
+  }
+  [result appendString:[string substringFromIndex:(NSUInteger)runStart]];
+  return result.copy;
+}
+
 @implementation NSString (FBXMLSafeString)
 
 - (NSString *)fb_xmlSafeStringWithReplacement:(NSString *)replacement
 {
-  static NSMutableCharacterSet *invalidSet;
-  static dispatch_once_t onceToken;
-  dispatch_once(&onceToken, ^{
-    // Char ::= #x9 | #xA | #xD | [#x20-#xD7FF] | [#xE000-#xFFFD] | [#x10000-#x10FFFF]
-    invalidSet = [NSMutableCharacterSet characterSetWithRange:NSMakeRange(0x9, 1)];
-    [invalidSet addCharactersInRange:NSMakeRange(0xA, 1)];
-    [invalidSet addCharactersInRange:NSMakeRange(0xD, 1)];
-    [invalidSet addCharactersInRange:NSMakeRange(0x20, 0xD7FF - 0x20 + 1)];
-    [invalidSet addCharactersInRange:NSMakeRange(0xE000, 0xFFFD - 0xE000 + 1)];
-    [invalidSet addCharactersInRange:NSMakeRange(0x10000, 0x10FFFF - 0x10000 + 1)];
-    [invalidSet invert];
-  });
-  return [[self componentsSeparatedByCharactersInSet:invalidSet] componentsJoinedByString:replacement];
+  CFStringRef cfSelf = (__bridge CFStringRef)self;
+  CFIndex length = CFStringGetLength(cfSelf);
+  CFStringInlineBuffer inputBuffer;
+  CFStringInitInlineBuffer(cfSelf, &inputBuffer, CFRangeMake(0, length));
+  NSUInteger invalidCount = FBProcessXMLChars(&inputBuffer, length, NULL, NULL, 0);
+  if (0 == invalidCount) {
+    // This is the case for the vast majority of strings
+    return self;
+  }
+
+  NSUInteger replacementLength = replacement.length;
+  unichar *replacementChars = NULL;
+  if (replacementLength > 0) {
+    replacementChars = (unichar *)malloc(replacementLength * sizeof(unichar));
+    if (NULL == replacementChars) {
+      return FBXMLSafeStringWithAppendedRuns(self, &inputBuffer, length, replacement);
+    }
+    [replacement getCharacters:replacementChars range:NSMakeRange(0, replacementLength)];
+  }
+  NSUInteger resultLength = (NSUInteger)length - invalidCount + invalidCount * replacementLength;
+  unichar *result = (unichar *)malloc(MAX(resultLength, 1) * sizeof(unichar));
+  if (NULL == result) {
+    free(replacementChars);
+    return FBXMLSafeStringWithAppendedRuns(self, &inputBuffer, length, replacement);
+  }
+  FBProcessXMLChars(&inputBuffer, length, result, replacementChars, replacementLength);
+  free(replacementChars);
+  return [[NSString alloc] initWithCharactersNoCopy:result length:resultLength freeWhenDone:YES];
 }
 
 @end
@@ -0,0 +1,47 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "XCUIApplication+FBHelpers.h"
+
+@class FBXCElementSnapshotWrapper;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Describes an optional attribute of elements in the tree returned by `fb_tree:`
+ */
+@interface FBTreeAttributeAccessor : NSObject
+/*! The attribute name, which could be provided in excluded attributes */
+@property (nonatomic, readonly) NSString *key;
+/*! The attribute name in the resulting tree */
+@property (nonatomic, readonly) NSString *name;
+/*! Returns whether elements of the given type have the attribute. NULL means all elements have it */
+@property (nonatomic, readonly, nullable) BOOL (*isSupportedByType)(XCUIElementType elementType);
+/*! Retrieves the attribute value of the given snapshot */
+@property (nonatomic, readonly) id _Nullable (^valueGetter)(FBXCElementSnapshotWrapper *snapshot);
+@end
+
+/**
+ Resolves the tree attributes once per request, so the tree generation
+ only needs to evaluate attribute values for each element
+
+ @param excludedAttributes Attribute keys to skip. nil or an empty set means all attributes are included
+ @return The accessors of the remaining attributes in the order they are added to the tree
+ */
+NSArray<FBTreeAttributeAccessor *> *FBTreeAttributeAccessorsExcluding(NSSet<NSString *> * _Nullable excludedAttributes);
+
+/**
+ Same as FBTreeAttributeAccessorsExcluding, but also skips the frame,
+ which is already stored as the node rect of the binary source
+
+ @param excludedAttributes Attribute keys to skip
+ @return The accessors of the remaining attributes in the order they are added to the binary source
+ */
+NSArray<FBTreeAttributeAccessor *> *FBBinarySourceAttributeAccessorsExcluding(NSSet<NSString *> * _Nullable excludedAttributes);
+
+NS_ASSUME_NONNULL_END
@@ -36,6 +36,27 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (NSDictionary *)fb_tree:(nullable NSSet<NSString *> *) excludedAttributes;
 
+/**
+ Return application elements tree in the compact binary format described in FBBinarySourceWriter.h.
+ The tree contains the same attributes as `fb_tree:` does, except for the frame one,
+ which is stored as the node rect
+
+ @param excludedAttributes Set of possible attributes to be excluded i.e frame, enabled, visible, accessible, focused. If set to nil or an empty array then no attributes will be excluded from the resulting tree
+ @return application elements tree in the binary format
+ */
+- (NSData *)fb_binarySource:(nullable NSSet<NSString *> *)excludedAttributes;
+
+/**
+ Return application elements tree as a flat array of dictionaries in depth-first order.
+ Each dictionary contains the same attributes as `fb_tree:` does, but instead of nested children
+ it has the element 'uid', the 'parent' element uid and the array of 'children' uids.
+ Element uids are based on accessibility identifiers of elements, so they stay the same between snapshots
+
+ @param excludedAttributes Set of possible attributes to be excluded i.e frame, enabled, visible, accessible, focused. If set to nil or an empty array then no attributes will be excluded from the resulting tree
+ @return application elements tree as flat array of dictionaries
+ */
+- (NSArray<NSDictionary *> *)fb_flatTree:(nullable NSSet<NSString *> *)excludedAttributes;
+
 /**
  Return application elements accessibility tree in form of nested dictionaries
  */
@@ -57,6 +78,15 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable NSString *)fb_xmlRepresentationWithOptions:(nullable FBXMLGenerationOptions *)options;
 
+/**
+ Return application elements tree in a form of UTF-8 encoded xml bytes.
+ This is cheaper than `fb_xmlRepresentationWithOptions:` for big trees, since no string conversion is made
+
+ @param options Optional values that affect the resulting XML generation process.
+ @return nil if there was a failure while retriveing the page source.
+ */
+- (nullable NSData *)fb_xmlDataRepresentationWithOptions:(nullable FBXMLGenerationOptions *)options;
+
 /**
  Return application elements tree in form of internal XCTest debugDescription string
  */
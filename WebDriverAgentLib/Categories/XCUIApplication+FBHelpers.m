@@ -7,8 +7,11 @@
  */
 
 #import "XCUIApplication+FBHelpers.h"
+#import "XCUIApplication+FBHelpers-Private.h"
 
 #import "FBActiveAppDetectionPoint.h"
+#import "FBBinarySourceWriter.h"
+#import "FBElementUtils.h"
 #import "FBElementTypeTransformer.h"
 #import "FBKeyboard.h"
 #import "FBLogger.h"
@@ -16,6 +19,7 @@
 #import "FBMacros.h"
 #import "FBMathUtils.h"
 #import "FBRunLoopSpinner.h"
+#import "FBSourceDiffer.h"
 #import "FBXCodeCompatibility.h"
 #import "FBXPath.h"
 #import "FBXCAccessibilityElement.h"
@@ -111,6 +115,119 @@ NSDictionary<NSString *, NSString *> *customExclusionAttributesMap(void) {
   return result;
 }
 
+@implementation FBTreeAttributeAccessor
+
+- (instancetype)initWithKey:(NSString *)key
+              isPrefixedKey:(BOOL)isPrefixedKey
+          isSupportedByType:(nullable BOOL (*)(XCUIElementType))isSupportedByType
+                valueGetter:(id _Nullable (^)(FBXCElementSnapshotWrapper *))valueGetter
+{
+  if ((self = [super init])) {
+    _key = key;
+    // Boolean attributes get the 'is' prefix, e.g. 'enabled' becomes 'isEnabled'
+    _name = isPrefixedKey ? [NSString stringWithFormat:@"is%@", [key capitalizedString]] : key;
+    _isSupportedByType = isSupportedByType;
+    _valueGetter = valueGetter;
+  }
+  return self;
+}
+
+@end
+
+static NSArray<FBTreeAttributeAccessor *> *treeAttributeAccessors(void) {
+  static dispatch_once_t onceToken;
+  static NSArray<FBTreeAttributeAccessor *> *result;
+  dispatch_once(&onceToken, ^{
+    result = @[
+      [[FBTreeAttributeAccessor alloc] initWithKey:FBExclusionAttributeFrame
+                                     isPrefixedKey:NO
+                                 isSupportedByType:NULL
+                                       valueGetter:^id (FBXCElementSnapshotWrapper *snapshot) {
+        return NSStringFromCGRect(snapshot.wdFrame);
+      }],
+      [[FBTreeAttributeAccessor alloc] initWithKey:FBExclusionAttributeNativeFrame
+                                     isPrefixedKey:NO
+                                 isSupportedByType:NULL
+                                       valueGetter:^id (FBXCElementSnapshotWrapper *snapshot) {
+        return NSStringFromCGRect(snapshot.wdNativeFrame);
+      }],
+      [[FBTreeAttributeAccessor alloc] initWithKey:FBExclusionAttributeEnabled
+                                     isPrefixedKey:YES
+                                 isSupportedByType:NULL
+                                       valueGetter:^id (FBXCElementSnapshotWrapper *snapshot) {
+        return [@([snapshot isWDEnabled]) stringValue];
+      }],
+      [[FBTreeAttributeAccessor alloc] initWithKey:FBExclusionAttributeVisible
+                                     isPrefixedKey:YES
+                                 isSupportedByType:NULL
+                                       valueGetter:^id (FBXCElementSnapshotWrapper *snapshot) {
+        return [@([snapshot isWDVisible]) stringValue];
+      }],
+      [[FBTreeAttributeAccessor alloc] initWithKey:FBExclusionAttributeAccessible
+                                     isPrefixedKey:YES
+                                 isSupportedByType:NULL
+                                       valueGetter:^id (FBXCElementSnapshotWrapper *snapshot) {
+        return [@([snapshot isWDAccessible]) stringValue];
+      }],
+      [[FBTreeAttributeAccessor alloc] initWithKey:FBExclusionAttributeFocused
+                                     isPrefixedKey:YES
+                                 isSupportedByType:NULL
+                                       valueGetter:^id (FBXCElementSnapshotWrapper *snapshot) {
+        return [@([snapshot isWDFocused]) stringValue];
+      }],
+      [[FBTreeAttributeAccessor alloc] initWithKey:FBExclusionAttributeTraits
+                                     isPrefixedKey:NO
+                                 isSupportedByType:NULL
+                                       valueGetter:^id (FBXCElementSnapshotWrapper *snapshot) {
+        return snapshot.wdTraits;
+      }],
+      // Text-input placeholder (only for elements that support inner text)
+      [[FBTreeAttributeAccessor alloc] initWithKey:FBExclusionAttributePlaceholderValue
+                                     isPrefixedKey:NO
+                                 isSupportedByType:FBDoesElementSupportInnerText
+                                       valueGetter:^id (FBXCElementSnapshotWrapper *snapshot) {
+        return FBValueOrNull(snapshot.wdPlaceholderValue);
+      }],
+      // Only for elements that support min/max value
+      [[FBTreeAttributeAccessor alloc] initWithKey:FBExclusionAttributeMinValue
+                                     isPrefixedKey:NO
+                                 isSupportedByType:FBDoesElementSupportMinMaxValue
+                                       valueGetter:^id (FBXCElementSnapshotWrapper *snapshot) {
+        return snapshot.wdMinValue;
+      }],
+      [[FBTreeAttributeAccessor alloc] initWithKey:FBExclusionAttributeMaxValue
+                                     isPrefixedKey:NO
+                                 isSupportedByType:FBDoesElementSupportMinMaxValue
+                                       valueGetter:^id (FBXCElementSnapshotWrapper *snapshot) {
+        return snapshot.wdMaxValue;
+      }],
+    ];
+  });
+  return result;
+}
+
+NSArray<FBTreeAttributeAccessor *> *FBTreeAttributeAccessorsExcluding(NSSet<NSString *> * _Nullable excludedAttributes) {
+  NSArray<FBTreeAttributeAccessor *> *accessors = treeAttributeAccessors();
+  if (0 == excludedAttributes.count) {
+    return accessors;
+  }
+  NSMutableArray<FBTreeAttributeAccessor *> *result = [NSMutableArray arrayWithCapacity:accessors.count];
+  for (FBTreeAttributeAccessor *accessor in accessors) {
+    if (![excludedAttributes containsObject:accessor.key]) {
+      [result addObject:accessor];
+    }
+  }
+  return result.copy;
+}
+
+NSArray<FBTreeAttributeAccessor *> *FBBinarySourceAttributeAccessorsExcluding(NSSet<NSString *> * _Nullable excludedAttributes) {
+  NSMutableSet<NSString *> *binaryExcludedAttributes = [NSMutableSet setWithObject:FBExclusionAttributeFrame];
+  if (nil != excludedAttributes) {
+    [binaryExcludedAttributes unionSet:(NSSet *)excludedAttributes];
+  }
+  return FBTreeAttributeAccessorsExcluding(binaryExcludedAttributes);
+}
+
 @implementation XCUIApplication (FBHelpers)
 
 - (BOOL)fb_waitForAppElement:(NSTimeInterval)timeout
@@ -183,7 +300,36 @@ NSDictionary<NSString *, NSString *> *customExclusionAttributesMap(void) {
   id<FBXCElementSnapshot> snapshot = [self fb_standardSnapshot];
   return [self.class dictionaryForElement:snapshot
                                 recursive:YES
-                       excludedAttributes:excludedAttributes];
+                       attributeAccessors:FBTreeAttributeAccessorsExcluding(excludedAttributes)];
+}
+
+- (NSData *)fb_binarySource:(nullable NSSet<NSString *> *)excludedAttributes
+{
+  id<FBXCElementSnapshot> snapshot = [self fb_standardSnapshot];
+  FBBinarySourceWriter *writer = [[FBBinarySourceWriter alloc] init];
+  [self.class fb_appendElement:snapshot
+                toBinarySource:writer
+                   parentIndex:NSNotFound
+            attributeAccessors:FBBinarySourceAttributeAccessorsExcluding(excludedAttributes)];
+  return writer.data;
+}
+
+- (NSArray<NSDictionary *> *)fb_flatTree:(nullable NSSet<NSString *> *)excludedAttributes
+{
+  id<FBXCElementSnapshot> snapshot = [self fb_standardSnapshot];
+  NSMutableArray<NSDictionary *> *nodes = [NSMutableArray array];
+  NSMutableSet<NSString *> *usedUids = [NSMutableSet set];
+  NSString *uid = [self.class fb_flatTreeUidWithElement:snapshot
+                                              parentUid:nil
+                                                  index:0
+                                               usedUids:usedUids];
+  [self.class fb_appendElement:snapshot
+                       withUid:uid
+                     parentUid:nil
+                    toFlatTree:nodes
+                      usedUids:usedUids
+            attributeAccessors:FBTreeAttributeAccessorsExcluding(excludedAttributes)];
+  return nodes.copy;
 }
 
 - (NSDictionary *)fb_accessibilityTree
@@ -192,9 +338,9 @@ NSDictionary<NSString *, NSString *> *customExclusionAttributesMap(void) {
   return [self.class accessibilityInfoForElement:snapshot];
 }
 
-+ (NSDictionary *)dictionaryForElement:(id<FBXCElementSnapshot>)snapshot 
++ (NSDictionary *)dictionaryForElement:(id<FBXCElementSnapshot>)snapshot
                              recursive:(BOOL)recursive
-                    excludedAttributes:(nullable NSSet<NSString *> *)excludedAttributes
+                    attributeAccessors:(NSArray<FBTreeAttributeAccessor *> *)attributeAccessors
 {
   NSMutableDictionary *info = [[NSMutableDictionary alloc] init];
   info[@"type"] = [FBElementTypeTransformer shortStringWithElementType:snapshot.elementType];
@@ -204,27 +350,12 @@ NSDictionary<NSString *, NSString *> *customExclusionAttributesMap(void) {
   info[@"value"] = FBValueOrNull(wrappedSnapshot.wdValue);
   info[@"label"] = FBValueOrNull(wrappedSnapshot.wdLabel);
   info[@"rect"] = wrappedSnapshot.wdRect;
-  
-  NSDictionary<NSString *, NSString *(^)(void)> *attributeBlocks = [self fb_attributeBlockMapForWrappedSnapshot:wrappedSnapshot];
-
-  NSSet *nonPrefixedKeys = [NSSet setWithObjects:
-                            FBExclusionAttributeFrame,
-                            FBExclusionAttributePlaceholderValue,
-                            FBExclusionAttributeNativeFrame,
-                            FBExclusionAttributeTraits,
-                            FBExclusionAttributeMinValue,
-                            FBExclusionAttributeMaxValue,
-                            nil];
-
-  for (NSString *key in attributeBlocks) {
-      if (excludedAttributes == nil || ![excludedAttributes containsObject:key]) {
-          NSString *value = ((NSString * (^)(void))attributeBlocks[key])();
-          if ([nonPrefixedKeys containsObject:key]) {
-              info[key] = value;
-          } else {
-              info[[NSString stringWithFormat:@"is%@", [key capitalizedString]]] = value;
-          }
-      }
+
+  XCUIElementType elementType = wrappedSnapshot.elementType;
+  for (FBTreeAttributeAccessor *accessor in attributeAccessors) {
+    if (NULL == accessor.isSupportedByType || accessor.isSupportedByType(elementType)) {
+      info[accessor.name] = accessor.valueGetter(wrappedSnapshot);
+    }
   }
 
   if (!recursive) {
@@ -238,64 +369,100 @@ NSDictionary<NSString *, NSString *> *customExclusionAttributesMap(void) {
       @autoreleasepool {
         [info[@"children"] addObject:[self dictionaryForElement:childSnapshot
                                                       recursive:YES
-                                             excludedAttributes:excludedAttributes]];
+                                             attributeAccessors:attributeAccessors]];
       }
     }
   }
   return info;
 }
 
-// Helper used by `dictionaryForElement:` to assemble attribute value blocks,
-// including both common attributes and conditionally included ones like placeholderValue.
-+ (NSDictionary<NSString *, NSString *(^)(void)> *)fb_attributeBlockMapForWrappedSnapshot:(FBXCElementSnapshotWrapper *)wrappedSnapshot
-
++ (NSUInteger)fb_appendElement:(id<FBXCElementSnapshot>)snapshot
+                 toBinarySource:(FBBinarySourceWriter *)writer
+                    parentIndex:(NSUInteger)parentIndex
+             attributeAccessors:(NSArray<FBTreeAttributeAccessor *> *)attributeAccessors
 {
-  // Base attributes common to every element
-  NSMutableDictionary<NSString *, id(^)(void)> *blocks =
-  [@{
-    FBExclusionAttributeFrame: ^{
-    return NSStringFromCGRect(wrappedSnapshot.wdFrame);
-  },
-    FBExclusionAttributeNativeFrame: ^{
-    return NSStringFromCGRect(wrappedSnapshot.wdNativeFrame);
-  },
-    FBExclusionAttributeEnabled: ^{
-    return [@([wrappedSnapshot isWDEnabled]) stringValue];
-  },
-    FBExclusionAttributeVisible: ^{
-    return [@([wrappedSnapshot isWDVisible]) stringValue];
-  },
-    FBExclusionAttributeAccessible: ^{
-    return [@([wrappedSnapshot isWDAccessible]) stringValue];
-  },
-    FBExclusionAttributeFocused: ^{
-    return [@([wrappedSnapshot isWDFocused]) stringValue];
-  },
-    FBExclusionAttributeTraits: ^{
-    return wrappedSnapshot.wdTraits;
-  }
-  } mutableCopy];
-  
+  FBXCElementSnapshotWrapper *wrappedSnapshot = [FBXCElementSnapshotWrapper ensureWrapped:snapshot];
+  NSMutableDictionary<NSString *, NSString *> *attributes = [NSMutableDictionary dictionary];
+  void (^addAttribute)(NSString *, id) = ^(NSString *name, id value) {
+    if (nil == value || [value isKindOfClass:NSNull.class]) {
+      return;
+    }
+    attributes[name] = [value isKindOfClass:NSString.class] ? value : [value description];
+  };
+  addAttribute(@"rawIdentifier", [snapshot.identifier isEqual:@""] ? nil : snapshot.identifier);
+  addAttribute(@"name", wrappedSnapshot.wdName);
+  addAttribute(@"value", wrappedSnapshot.wdValue);
+  addAttribute(@"label", wrappedSnapshot.wdLabel);
   XCUIElementType elementType = wrappedSnapshot.elementType;
-  
-  // Text-input placeholder (only for elements that support inner text)
-  if (FBDoesElementSupportInnerText(elementType)) {
-    blocks[FBExclusionAttributePlaceholderValue] = ^{
-      return (NSString *)FBValueOrNull(wrappedSnapshot.wdPlaceholderValue);
-    };
+  for (FBTreeAttributeAccessor *accessor in attributeAccessors) {
+    if (NULL == accessor.isSupportedByType || accessor.isSupportedByType(elementType)) {
+      addAttribute(accessor.name, accessor.valueGetter(wrappedSnapshot));
+    }
   }
-  
-  // Only for elements that support min/max value
-  if (FBDoesElementSupportMinMaxValue(elementType)) {
-    blocks[FBExclusionAttributeMinValue] = ^{
-      return wrappedSnapshot.wdMinValue;
-    };
-    blocks[FBExclusionAttributeMaxValue] = ^{
-      return wrappedSnapshot.wdMaxValue;
-    };
+
+  NSUInteger index = [writer appendNodeWithParentIndex:parentIndex
+                                                  type:[FBElementTypeTransformer shortStringWithElementType:snapshot.elementType]
+                                                  rect:wrappedSnapshot.wdFrame
+                                            attributes:attributes.copy];
+  for (id<FBXCElementSnapshot> childSnapshot in snapshot.children) {
+    @autoreleasepool {
+      [self fb_appendElement:childSnapshot
+              toBinarySource:writer
+                 parentIndex:index
+          attributeAccessors:attributeAccessors];
+    }
   }
-  
-  return [blocks copy];
+  return index;
+}
+
++ (NSString *)fb_flatTreeUidWithElement:(id<FBXCElementSnapshot>)snapshot
+                              parentUid:(nullable NSString *)parentUid
+                                  index:(NSUInteger)index
+                               usedUids:(NSMutableSet<NSString *> *)usedUids
+{
+  NSString *uid = [FBElementUtils uidWithAccessibilityElement:snapshot.accessibilityElement];
+  if (nil == uid || [usedUids containsObject:uid]) {
+    // Fall back to the position in the tree if the element has no unique accessibility identifier
+    uid = [NSString stringWithFormat:@"%@/%lu", parentUid ?: @"", (unsigned long)index];
+  }
+  [usedUids addObject:uid];
+  return uid;
+}
+
++ (void)fb_appendElement:(id<FBXCElementSnapshot>)snapshot
+                 withUid:(NSString *)uid
+               parentUid:(nullable NSString *)parentUid
+              toFlatTree:(NSMutableArray<NSDictionary *> *)nodes
+                usedUids:(NSMutableSet<NSString *> *)usedUids
+      attributeAccessors:(NSArray<FBTreeAttributeAccessor *> *)attributeAccessors
+{
+  NSMutableDictionary *info = [[self dictionaryForElement:snapshot
+                                                recursive:NO
+                                       attributeAccessors:attributeAccessors] mutableCopy];
+  info[FBSourceDifferUidKey] = uid;
+  info[@"parent"] = FBValueOrNull(parentUid);
+  NSArray<id<FBXCElementSnapshot>> *children = snapshot.children;
+  NSMutableArray<NSString *> *childUids = [NSMutableArray arrayWithCapacity:children.count];
+  for (id<FBXCElementSnapshot> childSnapshot in children) {
+    [childUids addObject:[self fb_flatTreeUidWithElement:childSnapshot
+                                               parentUid:uid
+                                                   index:childUids.count
+                                                usedUids:usedUids]];
+  }
+  // Children order is only tracked by their parent, so an insertion does not change all the following siblings
+  info[@"children"] = childUids.copy;
+  [nodes addObject:info.copy];
+
+  [children enumerateObjectsUsingBlock:^(id<FBXCElementSnapshot> childSnapshot, NSUInteger idx, BOOL *stop) {
+    @autoreleasepool {
+      [self fb_appendElement:childSnapshot
+                     withUid:childUids[idx]
+                   parentUid:uid
+                  toFlatTree:nodes
+                    usedUids:usedUids
+          attributeAccessors:attributeAccessors];
+    }
+  }];
 }
 
 + (NSDictionary *)accessibilityInfoForElement:(id<FBXCElementSnapshot>)snapshot
@@ -345,6 +512,11 @@ NSDictionary<NSString *, NSString *> *customExclusionAttributesMap(void) {
   return [FBXPath xmlStringWithRootElement:self options:options];
 }
 
+- (NSData *)fb_xmlDataRepresentationWithOptions:(FBXMLGenerationOptions *)options
+{
+  return [FBXPath xmlDataWithRootElement:self options:options];
+}
+
 - (NSString *)fb_descriptionRepresentation
 {
   NSMutableArray<NSString *> *childrenDescriptions = [NSMutableArray array];
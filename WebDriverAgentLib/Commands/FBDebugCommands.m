@@ -8,12 +8,15 @@
 
 #import "FBDebugCommands.h"
 
+#import "FBMjpegServer.h"
 #import "FBRouteRequest.h"
 #import "FBSession.h"
+#import "FBSourceDiffer.h"
 #import "FBXMLGenerationOptions.h"
 #import "XCUIApplication+FBHelpers.h"
 #import "XCUIElement+FBUtilities.h"
 #import "FBXPath.h"
+#import "FBXPathQueryCache.h"
 
 @implementation FBDebugCommands
 
@@ -27,6 +30,8 @@
     [[FBRoute GET:@"/source"].withoutSession respondWithTarget:self action:@selector(handleGetSourceCommand:)],
     [[FBRoute GET:@"/wda/accessibleSource"] respondWithTarget:self action:@selector(handleGetAccessibleSourceCommand:)],
     [[FBRoute GET:@"/wda/accessibleSource"].withoutSession respondWithTarget:self action:@selector(handleGetAccessibleSourceCommand:)],
+    [[FBRoute GET:@"/wda/debug/caches"].withoutMainThread respondWithTarget:self action:@selector(handleGetCachesStatistics:)],
+    [[FBRoute GET:@"/wda/debug/caches"].withoutSession.withoutMainThread respondWithTarget:self action:@selector(handleGetCachesStatistics:)],
   ];
 }
 
@@ -36,6 +41,8 @@
 static NSString *const SOURCE_FORMAT_XML = @"xml";
 static NSString *const SOURCE_FORMAT_JSON = @"json";
 static NSString *const SOURCE_FORMAT_DESCRIPTION = @"description";
+static NSString *const SOURCE_FORMAT_BINARY = @"binary";
+static NSString *const SOURCE_FORMAT_DIFF = @"diff";
 
 + (id<FBResponsePayload>)handleGetSourceCommand:(FBRouteRequest *)request
 {
@@ -43,27 +50,41 @@ static NSString *const SOURCE_FORMAT_DESCRIPTION = @"description";
   XCUIApplication *application = request.session.activeApplication ?: XCUIApplication.fb_activeApplication;
   NSString *sourceType = request.parameters[@"format"] ?: SOURCE_FORMAT_XML;
   NSString *sourceScope = request.parameters[@"scope"];
+  NSString *excludedAttributesString = request.parameters[@"excluded_attributes"];
+  NSArray<NSString *> *excludedAttributesList = nil == excludedAttributesString
+    ? nil
+    : [excludedAttributesString componentsSeparatedByString:@","];
+  NSSet<NSString *> *excludedAttributes = nil == excludedAttributesList
+    ? nil
+    : [NSSet setWithArray:(NSArray *)excludedAttributesList];
   id result;
   if ([sourceType caseInsensitiveCompare:SOURCE_FORMAT_XML] == NSOrderedSame) {
-    NSArray<NSString *> *excludedAttributes = nil == request.parameters[@"excluded_attributes"]
-      ? nil
-      : [request.parameters[@"excluded_attributes"] componentsSeparatedByString:@","];
-    result = [application fb_xmlRepresentationWithOptions:
+    // XML documents of big apps might take several megabytes,
+    // so they are streamed directly to the client
+    NSData *xmlData = [application fb_xmlDataRepresentationWithOptions:
         [[[FBXMLGenerationOptions new]
-          withExcludedAttributes:excludedAttributes]
+          withExcludedAttributes:excludedAttributesList]
          withScope:sourceScope]];
-  } else if ([sourceType caseInsensitiveCompare:SOURCE_FORMAT_JSON] == NSOrderedSame) {
-    NSString *excludedAttributesString = request.parameters[@"excluded_attributes"];
-    NSSet<NSString *> *excludedAttributes = (excludedAttributesString == nil)
-          ? nil
-          : [NSSet setWithArray:[excludedAttributesString componentsSeparatedByString:@","]];
-
-    result = [application fb_tree:excludedAttributes];
+    if (nil == xmlData) {
+      return FBResponseWithUnknownErrorFormat(@"Cannot get '%@' source of the current application", sourceType);
+    }
+    return FBResponseWithStreamedStringData(xmlData);
+  } else if ([sourceType caseInsensitiveCompare:SOURCE_FORMAT_JSON] == NSOrderedSame
+             || [sourceType caseInsensitiveCompare:SOURCE_FORMAT_BINARY] == NSOrderedSame) {
+    result = [sourceType caseInsensitiveCompare:SOURCE_FORMAT_JSON] == NSOrderedSame
+      ? [application fb_tree:excludedAttributes]
+      // The binary tree is returned as base64 string, similarly to screenshots
+      : [[application fb_binarySource:excludedAttributes] base64EncodedStringWithOptions:0];
+  } else if ([sourceType caseInsensitiveCompare:SOURCE_FORMAT_DIFF] == NSOrderedSame) {
+    // The 'since' token is returned by the previous diff call. The whole tree is returned without it
+    result = [FBSourceDiffer.sharedDiffer diffWithNodes:[application fb_flatTree:excludedAttributes]
+                                              baseToken:request.parameters[@"since"]
+                                     excludedAttributes:excludedAttributes];
   } else if ([sourceType caseInsensitiveCompare:SOURCE_FORMAT_DESCRIPTION] == NSOrderedSame) {
     result = application.fb_descriptionRepresentation;
   } else {
     return FBResponseWithStatus([FBCommandStatus invalidArgumentErrorWithMessage:[NSString stringWithFormat:@"Unknown source format '%@'. Only %@ source formats are supported.",
-                                                                                  sourceType, @[SOURCE_FORMAT_XML, SOURCE_FORMAT_JSON, SOURCE_FORMAT_DESCRIPTION]] traceback:nil]);
+                                                                                  sourceType, @[SOURCE_FORMAT_XML, SOURCE_FORMAT_JSON, SOURCE_FORMAT_DESCRIPTION, SOURCE_FORMAT_BINARY, SOURCE_FORMAT_DIFF]] traceback:nil]);
   }
   if (nil == result) {
     return FBResponseWithUnknownErrorFormat(@"Cannot get '%@' source of the current application", sourceType);
@@ -78,4 +99,14 @@ static NSString *const SOURCE_FORMAT_DESCRIPTION = @"description";
   return FBResponseWithObject(application.fb_accessibilityTree ?: @{});
 }
 
++ (id<FBResponsePayload>)handleGetCachesStatistics:(FBRouteRequest *)request
+{
+  return FBResponseWithObject(@{
+    @"xpathQueries": FBXPathQueryCache.sharedCache.statistics,
+    // This method might be called without session
+    @"elements": (request.session ?: FBSession.activeSession).elementCache.statistics ?: @{},
+    @"mjpegImageProcessing": FBMjpegServer.imageProcessingStatistics,
+  });
+}
+
 @end
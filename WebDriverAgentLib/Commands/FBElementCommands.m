@@ -20,6 +20,7 @@
 #import "FBMacros.h"
 #import "FBMathUtils.h"
 #import "FBRuntimeUtils.h"
+#import "FBScreenshot.h"
 #import "NSPredicate+FBFormat.h"
 #import "XCTestPrivateSymbols.h"
 #import "XCUICoordinate.h"
@@ -38,6 +39,7 @@
 #import "FBElementTypeTransformer.h"
 #import "XCUIElement.h"
 #import "XCUIElementQuery.h"
+#import "XCUIScreen.h"
 #import "FBXCodeCompatibility.h"
 
 @interface FBElementCommands ()
@@ -57,6 +59,7 @@
     [[FBRoute GET:@"/element/:uuid/enabled"] respondWithTarget:self action:@selector(handleGetEnabled:)],
     [[FBRoute GET:@"/element/:uuid/rect"] respondWithTarget:self action:@selector(handleGetRect:)],
     [[FBRoute GET:@"/element/:uuid/attribute/:name"] respondWithTarget:self action:@selector(handleGetAttribute:)],
+    [[FBRoute POST:@"/wda/elements/attributes"].withoutSideEffects respondWithTarget:self action:@selector(handleGetAttributes:)],
     [[FBRoute GET:@"/element/:uuid/text"] respondWithTarget:self action:@selector(handleGetText:)],
     [[FBRoute GET:@"/element/:uuid/displayed"] respondWithTarget:self action:@selector(handleGetDisplayed:)],
     [[FBRoute GET:@"/element/:uuid/selected"] respondWithTarget:self action:@selector(handleGetSelected:)],
@@ -146,6 +149,55 @@
   return FBResponseWithObject(attributeValue ?: [NSNull null]);
 }
 
++ (id<FBResponsePayload>)handleGetAttributes:(FBRouteRequest *)request
+{
+  NSArray<NSString *> *uuids = request.arguments[@"elements"];
+  NSArray<NSString *> *attributeNames = request.arguments[@"attributes"];
+  if (![uuids isKindOfClass:NSArray.class] || ![attributeNames isKindOfClass:NSArray.class]) {
+    return FBResponseWithStatus([FBCommandStatus invalidArgumentErrorWithMessage:@"Both 'elements' and 'attributes' arguments must be arrays" traceback:nil]);
+  }
+  if (0 == uuids.count || 0 == attributeNames.count) {
+    return FBResponseWithObject(@[]);
+  }
+
+  // Unknown elements must be reported as stale the same way the single attribute endpoint does it,
+  // even if they could still be found in the current hierarchy
+  FBElementCache *elementCache = request.session.elementCache;
+  NSMutableDictionary<NSString *, XCUIElement *> *elementsByUid = [NSMutableDictionary dictionaryWithCapacity:uuids.count];
+  for (NSString *uuid in uuids) {
+    if (![uuid isKindOfClass:NSString.class]) {
+      return FBResponseWithStatus([FBCommandStatus invalidArgumentErrorWithMessage:@"Each item of the 'elements' argument must be an element identifier" traceback:nil]);
+    }
+    elementsByUid[uuid] = [elementCache elementForUUID:uuid];
+  }
+
+  NSDictionary<NSString *, id<FBXCElementSnapshot>> *snapshotsByUid = [self snapshotsWithUids:[NSSet setWithArray:uuids]
+                                                                                  application:request.session.activeApplication];
+  NSString *hittableAttributeName = FBStringify(XCUIElement, isWDHittable);
+  NSMutableArray<NSArray *> *result = [NSMutableArray arrayWithCapacity:uuids.count];
+  for (NSString *uuid in uuids) {
+    id<FBXCElementSnapshot> snapshot = snapshotsByUid[uuid];
+    FBXCElementSnapshotWrapper *wrappedSnapshot = nil == snapshot ? nil : [FBXCElementSnapshotWrapper ensureWrapped:snapshot];
+    // Elements, which do not belong to the active application, are resolved one by one
+    XCUIElement *element = elementsByUid[uuid];
+    NSMutableArray *values = [NSMutableArray arrayWithCapacity:attributeNames.count];
+    for (NSString *attributeName in attributeNames) {
+      id value;
+      if (nil == wrappedSnapshot) {
+        value = [element fb_valueForWDAttributeName:attributeName];
+      } else if ([[FBElementUtils wdAttributeNameForAttributeName:attributeName] isEqualToString:hittableAttributeName]) {
+        // Hittability could only be properly calculated on the native element snapshot
+        value = [element fb_valueForWDAttributeName:attributeName];
+      } else {
+        value = [wrappedSnapshot fb_valueForWDAttributeName:attributeName];
+      }
+      [values addObject:value ?: [NSNull null]];
+    }
+    [result addObject:values.copy];
+  }
+  return FBResponseWithObject(result.copy);
+}
+
 + (id<FBResponsePayload>)handleGetText:(FBRouteRequest *)request
 {
   FBElementCache *elementCache = request.session.elementCache;
@@ -567,7 +619,18 @@
                                         checkStaleness:YES];
     NSData *screenshotData = nil;
     @autoreleasepool {
-      screenshotData = [element.screenshot PNGRepresentation];
+#if !TARGET_OS_TV
+      NSTimeInterval maxCaptureAge = FBConfiguration.screenshotCacheMaxAge;
+      // Recent captures are always in portrait orientation, while element frames follow the app orientation
+      if (maxCaptureAge > 0 && element.application.interfaceOrientation == UIInterfaceOrientationPortrait) {
+        screenshotData = [FBScreenshot cachedPngWithRect:element.frame
+                                                screenID:[XCUIScreen.mainScreen displayID]
+                                                  maxAge:maxCaptureAge];
+      }
+#endif
+      if (nil == screenshotData) {
+        screenshotData = [element.screenshot PNGRepresentation];
+      }
       if (nil == screenshotData) {
         NSString *errMsg = [NSString stringWithFormat:@"Cannot take a screenshot of %@", element.description];
         return FBResponseWithStatus([FBCommandStatus unableToCaptureScreenErrorWithMessage:errMsg
@@ -635,6 +698,37 @@ static const NSInteger DEFAULT_MAX_PICKER_ATTEMPTS = 25;
 
 #pragma mark - Helpers
 
+/**
+ Takes a single snapshot of the whole application hierarchy and picks
+ the descendants having the given unique identifiers
+
+ @param uids The set of element identifiers to look for
+ @param application The application whose hierarchy is going to be snapshotted
+ @return uid -> snapshot mapping. Elements that have not been found are not included
+ */
++ (NSDictionary<NSString *, id<FBXCElementSnapshot>> *)snapshotsWithUids:(NSSet<NSString *> *)uids
+                                                             application:(XCUIApplication *)application
+{
+  NSMutableDictionary<NSString *, id<FBXCElementSnapshot>> *result = [NSMutableDictionary dictionary];
+  // The native descendants enumeration cannot be interrupted, so the tree is traversed manually
+  // in the same depth-first order, which allows to stop as soon as all the requested elements are found
+  NSMutableArray<id<FBXCElementSnapshot>> *stack = [NSMutableArray array];
+  id<FBXCElementSnapshot> root = [application fb_customSnapshot];
+  if (nil != root) {
+    [stack addObject:root];
+  }
+  while (stack.count > 0 && result.count < uids.count) {
+    id<FBXCElementSnapshot> snapshot = stack.lastObject;
+    [stack removeLastObject];
+    NSString *uid = [FBXCElementSnapshotWrapper wdUIDWithSnapshot:snapshot];
+    if (nil != uid && [uids containsObject:uid] && nil == result[uid]) {
+      result[uid] = snapshot;
+    }
+    [stack addObjectsFromArray:snapshot.children.reverseObjectEnumerator.allObjects];
+  }
+  return result.copy;
+}
+
 + (id<FBResponsePayload>)handleScrollElementToVisible:(XCUIElement *)element withRequest:(FBRouteRequest *)request
 {
   NSError *error;
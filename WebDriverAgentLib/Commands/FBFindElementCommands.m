@@ -38,10 +38,10 @@ static id<FBResponsePayload> FBNoSuchElementErrorResponseForRequest(FBRouteReque
 {
   return
   @[
-    [[FBRoute POST:@"/element"] respondWithTarget:self action:@selector(handleFindElement:)],
-    [[FBRoute POST:@"/elements"] respondWithTarget:self action:@selector(handleFindElements:)],
-    [[FBRoute POST:@"/element/:uuid/element"] respondWithTarget:self action:@selector(handleFindSubElement:)],
-    [[FBRoute POST:@"/element/:uuid/elements"] respondWithTarget:self action:@selector(handleFindSubElements:)],
+    [[FBRoute POST:@"/element"].withoutSideEffects respondWithTarget:self action:@selector(handleFindElement:)],
+    [[FBRoute POST:@"/elements"].withoutSideEffects respondWithTarget:self action:@selector(handleFindElements:)],
+    [[FBRoute POST:@"/element/:uuid/element"].withoutSideEffects respondWithTarget:self action:@selector(handleFindSubElement:)],
+    [[FBRoute POST:@"/element/:uuid/elements"].withoutSideEffects respondWithTarget:self action:@selector(handleFindSubElements:)],
     [[FBRoute GET:@"/wda/element/:uuid/getVisibleCells"] respondWithTarget:self action:@selector(handleFindVisibleCells:)],
 #if TARGET_OS_TV
     [[FBRoute GET:@"/element/active"] respondWithTarget:self action:@selector(handleGetFocusedElement:)],
@@ -8,7 +8,21 @@
 
 #import "FBScreenshotCommands.h"
 
+@import UniformTypeIdentifiers;
+
+#import "FBConfiguration.h"
+#import "FBElementCache.h"
+#import "FBImageProcessor.h"
+#import "FBRoute.h"
+#import "FBRouteRequest.h"
+#import "FBScreenshot.h"
+#import "FBSession.h"
 #import "XCUIDevice+FBHelpers.h"
+#import "XCUIElement.h"
+#import "XCUIScreen.h"
+
+static const NSTimeInterval REGION_SCREENSHOT_TIMEOUT = 20.;
+static const NSUInteger DEFAULT_REGION_SCREENSHOT_QUALITY = 80;
 
 @implementation FBScreenshotCommands
 
@@ -18,8 +32,10 @@
 {
   return
   @[
-    [[FBRoute GET:@"/screenshot"].withoutSession respondWithTarget:self action:@selector(handleGetScreenshot:)],
-    [[FBRoute GET:@"/screenshot"] respondWithTarget:self action:@selector(handleGetScreenshot:)],
+    [[FBRoute GET:@"/screenshot"].withoutSession.withoutMainThread respondWithTarget:self action:@selector(handleGetScreenshot:)],
+    [[FBRoute GET:@"/screenshot"].withoutMainThread respondWithTarget:self action:@selector(handleGetScreenshot:)],
+    [[FBRoute POST:@"/wda/screenshot/region"].withoutSession.withoutSideEffects.withoutMainThread respondWithTarget:self action:@selector(handleGetRegionScreenshot:)],
+    [[FBRoute POST:@"/wda/screenshot/region"].withoutSideEffects respondWithTarget:self action:@selector(handleGetRegionScreenshot:)],
   ];
 }
 
@@ -37,4 +53,122 @@
   return FBResponseWithObject(screenshot);
 }
 
+// Crops and scales the screen region given by 'rect' or by the 'element' frame on the device
++ (id<FBResponsePayload>)handleGetRegionScreenshot:(FBRouteRequest *)request
+{
+  CGRect region;
+  NSDictionary *rect = request.arguments[@"rect"];
+  NSString *elementUuid = request.arguments[@"element"];
+  if ([rect isKindOfClass:NSDictionary.class]) {
+    for (NSString *name in @[@"x", @"y", @"width", @"height"]) {
+      BOOL allowsZero = [name isEqualToString:@"x"] || [name isEqualToString:@"y"];
+      NSString *message = [self invalidNumberMessageWithValue:rect[name]
+                                                         name:[NSString stringWithFormat:@"rect.%@", name]
+                                                   allowsZero:allowsZero];
+      if (nil != message) {
+        return FBResponseWithStatus([FBCommandStatus invalidArgumentErrorWithMessage:message traceback:nil]);
+      }
+    }
+    region = CGRectMake([rect[@"x"] doubleValue], [rect[@"y"] doubleValue],
+                        [rect[@"width"] doubleValue], [rect[@"height"] doubleValue]);
+  } else if ([elementUuid isKindOfClass:NSString.class]) {
+    id paddingArgument = request.arguments[@"padding"];
+    NSString *message = nil == paddingArgument
+      ? nil
+      : [self invalidNumberMessageWithValue:paddingArgument name:@"padding" allowsZero:YES];
+    if (nil != message) {
+      return FBResponseWithStatus([FBCommandStatus invalidArgumentErrorWithMessage:message traceback:nil]);
+    }
+    if (nil == request.session) {
+      return FBResponseWithStatus([FBCommandStatus invalidArgumentErrorWithMessage:@"Element screenshots require an active session"
+                                                                         traceback:nil]);
+    }
+    XCUIElement *element = [request.session.elementCache elementForUUID:elementUuid checkStaleness:YES];
+    CGFloat padding = [request.arguments[@"padding"] doubleValue];
+    region = CGRectInset(element.frame, -padding, -padding);
+  } else {
+    return FBResponseWithStatus([FBCommandStatus invalidArgumentErrorWithMessage:@"Either 'rect' or 'element' argument must be provided"
+                                                                       traceback:nil]);
+  }
+  if (CGRectIsNull(region) || region.size.width <= 0 || region.size.height <= 0) {
+    NSString *message = [NSString stringWithFormat:@"The screenshot region %@ must not be empty", NSStringFromCGRect(region)];
+    return FBResponseWithStatus([FBCommandStatus invalidArgumentErrorWithMessage:message traceback:nil]);
+  }
+
+  id formatArgument = request.arguments[@"format"];
+  if (nil != formatArgument && ![formatArgument isKindOfClass:NSString.class]) {
+    return FBResponseWithStatus([FBCommandStatus invalidArgumentErrorWithMessage:@"The screenshot format must be a string"
+                                                                       traceback:nil]);
+  }
+  NSString *format = [formatArgument lowercaseString] ?: @"png";
+  UTType *uti;
+  if ([format isEqualToString:@"png"]) {
+    uti = UTTypePNG;
+  } else if ([format isEqualToString:@"jpeg"] || [format isEqualToString:@"jpg"]) {
+    uti = UTTypeJPEG;
+  } else {
+    NSString *message = [NSString stringWithFormat:@"The screenshot format '%@' is not supported. Only 'png' and 'jpeg' are", format];
+    return FBResponseWithStatus([FBCommandStatus invalidArgumentErrorWithMessage:message traceback:nil]);
+  }
+  for (NSString *name in @[@"scale", @"quality"]) {
+    id value = request.arguments[name];
+    NSString *message = nil == value ? nil : [self invalidNumberMessageWithValue:value name:name allowsZero:NO];
+    if (nil != message) {
+      return FBResponseWithStatus([FBCommandStatus invalidArgumentErrorWithMessage:message traceback:nil]);
+    }
+  }
+  NSNumber *scale = request.arguments[@"scale"];
+  CGFloat scalingFactor = nil == scale ? FBMaxScalingFactor : scale.doubleValue;
+  NSNumber *quality = request.arguments[@"quality"];
+  CGFloat compressionQuality = MAX(FBMinCompressionQuality,
+                                   MIN(FBMaxCompressionQuality, (nil == quality ? DEFAULT_REGION_SCREENSHOT_QUALITY : quality.doubleValue) / 100.0));
+
+  NSError *error;
+  XCUIScreen *mainScreen = XCUIScreen.mainScreen;
+  // The whole screen is captured as PNG, so the region is only encoded once to the requested format
+  NSData *screenshotData = [FBScreenshot takeInOriginalResolutionWithScreenID:mainScreen.displayID
+                                                           compressionQuality:FBMaxCompressionQuality
+                                                                          uti:UTTypePNG
+                                                                      timeout:REGION_SCREENSHOT_TIMEOUT
+                                                                       maxAge:FBConfiguration.screenshotCacheMaxAge
+                                                                        error:&error];
+  if (nil == screenshotData) {
+    return FBResponseWithStatus([FBCommandStatus unableToCaptureScreenErrorWithMessage:error.description traceback:nil]);
+  }
+  CGFloat screenScale = [mainScreen scale];
+  CGRect regionInPixels = CGRectMake(region.origin.x * screenScale, region.origin.y * screenScale,
+                                     region.size.width * screenScale, region.size.height * screenScale);
+  NSData *regionData = [[[FBImageProcessor alloc] init] croppedImageWithData:screenshotData
+                                                                        rect:regionInPixels
+                                                                         uti:uti
+                                                               scalingFactor:scalingFactor
+                                                          compressionQuality:compressionQuality
+                                                                       error:&error];
+  if (nil == regionData) {
+    return FBResponseWithStatus([FBCommandStatus unableToCaptureScreenErrorWithMessage:error.description traceback:nil]);
+  }
+  return FBResponseWithObject([regionData base64EncodedStringWithOptions:0]);
+}
+
+
+#pragma mark - Helpers
+
+/**
+ @return The error message if the given argument value is not a positive number
+ (or not a non-negative one if zero is allowed) or nil if the value is valid
+ */
++ (nullable NSString *)invalidNumberMessageWithValue:(nullable id)value
+                                                name:(NSString *)name
+                                          allowsZero:(BOOL)allowsZero
+{
+  if ([value isKindOfClass:NSNumber.class]) {
+    double number = [(NSNumber *)value doubleValue];
+    if (number > 0 || (allowsZero && 0 == number)) {
+      return nil;
+    }
+  }
+  return [NSString stringWithFormat:@"The '%@' argument must be a %@ number. '%@' is given instead",
+          name, allowsZero ? @"non-negative" : @"positive", value];
+}
+
 @end
@@ -45,7 +45,7 @@
     [[FBRoute GET:@"/wda/apps/list"] respondWithTarget:self action:@selector(handleGetActiveAppsList:)],
     [[FBRoute GET:@""] respondWithTarget:self action:@selector(handleGetActiveSession:)],
     [[FBRoute DELETE:@""] respondWithTarget:self action:@selector(handleDeleteSession:)],
-    [[FBRoute GET:@"/status"].withoutSession respondWithTarget:self action:@selector(handleGetStatus:)],
+    [[FBRoute GET:@"/status"].withoutSession.withoutMainThread respondWithTarget:self action:@selector(handleGetStatus:)],
 
     // Health check might modify simulator state so it should only be called in-between testing sessions
     [[FBRoute GET:@"/wda/healthcheck"].withoutSession respondWithTarget:self action:@selector(handleGetHealthCheck:)],
@@ -335,6 +335,9 @@
       FB_SETTING_MJPEG_SERVER_FRAMERATE: @([FBConfiguration mjpegServerFramerate]),
       FB_SETTING_MJPEG_SCALING_FACTOR: @([FBConfiguration mjpegScalingFactor]),
       FB_SETTING_MJPEG_FIX_ORIENTATION: @([FBConfiguration mjpegShouldFixOrientation]),
+      FB_SETTING_MJPEG_ADAPTIVE_STREAMING: @([FBConfiguration mjpegAdaptiveStreaming]),
+      FB_SETTING_MJPEG_MAX_BANDWIDTH: @([FBConfiguration mjpegMaxBandwidth]),
+      FB_SETTING_MJPEG_MAX_IDLE_INTERVAL: @([FBConfiguration mjpegMaxIdleInterval]),
       FB_SETTING_SCREENSHOT_QUALITY: @([FBConfiguration screenshotQuality]),
       FB_SETTING_KEYBOARD_AUTOCORRECTION: @([FBConfiguration keyboardAutocorrection]),
       FB_SETTING_KEYBOARD_PREDICTION: @([FBConfiguration keyboardPrediction]),
@@ -358,6 +361,11 @@
       FB_SETTING_INCLUDE_NATIVE_FRAME_IN_PAGE_SOURCE: @([FBConfiguration includeNativeFrameInPageSource]),
       FB_SETTING_INCLUDE_MIN_MAX_VALUE_IN_PAGE_SOURCE: @([FBConfiguration includeMinMaxValueInPageSource]),
       FB_SETTING_LIMIT_XPATH_CONTEXT_SCOPE: @([FBConfiguration limitXpathContextScope]),
+      FB_SETTING_XPATH_DOCUMENT_CACHE_MAX_AGE: @([FBConfiguration xpathDocumentCacheMaxAge]),
+      FB_SETTING_COMPACT_JSON_RESPONSES: @([FBConfiguration compactJsonResponses]),
+      FB_SETTING_ELEMENT_CACHE_MEMORY_LIMIT: @([FBConfiguration elementCacheMemoryLimit]),
+      FB_SETTING_ELEMENT_CACHE_TIME_TO_LIVE: @([FBConfiguration elementCacheTimeToLive]),
+      FB_SETTING_SCREENSHOT_CACHE_MAX_AGE: @([FBConfiguration screenshotCacheMaxAge]),
 #if !TARGET_OS_TV
       FB_SETTING_SCREENSHOT_ORIENTATION: [FBConfiguration humanReadableScreenshotOrientation],
 #endif
@@ -392,6 +400,15 @@
   if (nil != [settings objectForKey:FB_SETTING_MJPEG_FIX_ORIENTATION]) {
     [FBConfiguration setMjpegShouldFixOrientation:[[settings objectForKey:FB_SETTING_MJPEG_FIX_ORIENTATION] boolValue]];
   }
+  if (nil != [settings objectForKey:FB_SETTING_MJPEG_ADAPTIVE_STREAMING]) {
+    [FBConfiguration setMjpegAdaptiveStreaming:[[settings objectForKey:FB_SETTING_MJPEG_ADAPTIVE_STREAMING] boolValue]];
+  }
+  if (nil != [settings objectForKey:FB_SETTING_MJPEG_MAX_BANDWIDTH]) {
+    [FBConfiguration setMjpegMaxBandwidth:[[settings objectForKey:FB_SETTING_MJPEG_MAX_BANDWIDTH] unsignedIntegerValue]];
+  }
+  if (nil != [settings objectForKey:FB_SETTING_MJPEG_MAX_IDLE_INTERVAL]) {
+    [FBConfiguration setMjpegMaxIdleInterval:[[settings objectForKey:FB_SETTING_MJPEG_MAX_IDLE_INTERVAL] doubleValue]];
+  }
   if (nil != [settings objectForKey:FB_SETTING_KEYBOARD_AUTOCORRECTION]) {
     [FBConfiguration setKeyboardAutocorrection:[[settings objectForKey:FB_SETTING_KEYBOARD_AUTOCORRECTION] boolValue]];
   }
@@ -471,6 +488,21 @@
   if (nil != [settings objectForKey:FB_SETTING_LIMIT_XPATH_CONTEXT_SCOPE]) {
     [FBConfiguration setLimitXpathContextScope:[[settings objectForKey:FB_SETTING_LIMIT_XPATH_CONTEXT_SCOPE] boolValue]];
   }
+  if (nil != [settings objectForKey:FB_SETTING_XPATH_DOCUMENT_CACHE_MAX_AGE]) {
+    [FBConfiguration setXpathDocumentCacheMaxAge:[[settings objectForKey:FB_SETTING_XPATH_DOCUMENT_CACHE_MAX_AGE] doubleValue]];
+  }
+  if (nil != [settings objectForKey:FB_SETTING_COMPACT_JSON_RESPONSES]) {
+    [FBConfiguration setCompactJsonResponses:[[settings objectForKey:FB_SETTING_COMPACT_JSON_RESPONSES] boolValue]];
+  }
+  if (nil != [settings objectForKey:FB_SETTING_ELEMENT_CACHE_MEMORY_LIMIT]) {
+    [FBConfiguration setElementCacheMemoryLimit:[[settings objectForKey:FB_SETTING_ELEMENT_CACHE_MEMORY_LIMIT] unsignedIntegerValue]];
+  }
+  if (nil != [settings objectForKey:FB_SETTING_ELEMENT_CACHE_TIME_TO_LIVE]) {
+    [FBConfiguration setElementCacheTimeToLive:[[settings objectForKey:FB_SETTING_ELEMENT_CACHE_TIME_TO_LIVE] doubleValue]];
+  }
+  if (nil != [settings objectForKey:FB_SETTING_SCREENSHOT_CACHE_MAX_AGE]) {
+    [FBConfiguration setScreenshotCacheMaxAge:[[settings objectForKey:FB_SETTING_SCREENSHOT_CACHE_MAX_AGE] doubleValue]];
+  }
 
 #if !TARGET_OS_TV
   if (nil != [settings objectForKey:FB_SETTING_SCREENSHOT_ORIENTATION]) {
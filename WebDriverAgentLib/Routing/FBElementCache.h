@@ -56,6 +56,15 @@ extern const int ELEMENT_CACHE_SIZE;
  */
 - (BOOL)hasElementWithUUID:(nullable NSString *)uuid;
 
+/**
+ Returns the cache usage counters: the count of stored elements, their estimated
+ retained memory size in bytes and the count of evicted and expired elements.
+ The retained memory size is only estimated while the cache memory limit is set
+
+ @returns Dictionary with counters
+ */
+- (NSDictionary<NSString *, NSNumber *> *)statistics;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -10,6 +10,7 @@
 
 #import "LRUCache.h"
 #import "FBAlert.h"
+#import "FBConfiguration.h"
 #import "FBExceptions.h"
 #import "FBXCodeCompatibility.h"
 #import "XCTestPrivateSymbols.h"
@@ -22,9 +23,12 @@
 #import "XCUIElementQuery.h"
 
 const int ELEMENT_CACHE_SIZE = 1024;
+// Rough estimation of the memory retained by a single snapshot node with its attributes
+static const NSUInteger SNAPSHOT_NODE_SIZE_ESTIMATE = 1024;
 
 @interface FBElementCache ()
 @property (nonatomic, strong) LRUCache *elementCache;
+@property (atomic) NSUInteger expirationsCount;
 @end
 
 @implementation FBElementCache
@@ -45,9 +49,13 @@ const int ELEMENT_CACHE_SIZE = 1024;
   if (nil == uuid) {
     return nil;
   }
-  @synchronized (self.elementCache) {
-    [self.elementCache setObject:element forKey:uuid];
-  }
+  [self removeExpiredElements];
+  NSUInteger memoryLimit = FBConfiguration.elementCacheMemoryLimit;
+  self.elementCache.totalCostLimit = memoryLimit;
+  // Costs are only taken into account if the memory limit is set, so skip the snapshot traversal otherwise
+  [self.elementCache setObject:element
+                        forKey:uuid
+                          cost:memoryLimit > 0 ? [self.class estimatedRetainedSizeWithElement:element] : 0];
   return uuid;
 }
 
@@ -63,10 +71,8 @@ const int ELEMENT_CACHE_SIZE = 1024;
     @throw [NSException exceptionWithName:FBInvalidArgumentException reason:reason userInfo:@{}];
   }
 
-  XCUIElement *element;
-  @synchronized (self.elementCache) {
-    element = [self.elementCache objectForKey:uuid];
-  }
+  [self removeExpiredElements];
+  XCUIElement *element = [self.elementCache objectForKey:uuid];
   if (nil == element) {
     NSString *reason = [NSString stringWithFormat:@"The element identified by \"%@\" is either not present or it has expired from the internal cache. Try to find it again", uuid];
     @throw [NSException exceptionWithName:FBStaleElementException reason:reason userInfo:@{}];
@@ -77,9 +83,7 @@ const int ELEMENT_CACHE_SIZE = 1024;
     } @catch (NSException *exception) {
       //  if the snapshot method threw FBStaleElementException (implying the element is stale) we need to explicitly remove it from the cache, PR: https://github.com/appium/WebDriverAgent/pull/985
       if ([exception.name isEqualToString:FBStaleElementException]) {
-        @synchronized (self.elementCache) {
-          [self.elementCache removeObjectForKey:uuid];
-        }
+        [self.elementCache removeObjectForKey:uuid];
       }
       @throw exception;
     }
@@ -92,9 +96,51 @@ const int ELEMENT_CACHE_SIZE = 1024;
   if (nil == uuid) {
     return NO;
   }
-  @synchronized (self.elementCache) {
-    return nil != [self.elementCache objectForKey:(NSString *)uuid];
+  [self removeExpiredElements];
+  return [self.elementCache containsObjectForKey:(NSString *)uuid];
+}
+
+- (NSDictionary<NSString *, NSNumber *> *)statistics
+{
+  return @{
+    @"capacity": @(self.elementCache.capacity),
+    @"count": @(self.elementCache.count),
+    @"retainedBytes": @(self.elementCache.totalCost),
+    @"memoryLimit": @(self.elementCache.totalCostLimit),
+    @"evictions": @(self.elementCache.evictionsCount),
+    @"expirations": @(self.expirationsCount),
+  };
+}
+
+- (void)removeExpiredElements
+{
+  NSTimeInterval timeToLive = FBConfiguration.elementCacheTimeToLive;
+  if (timeToLive <= 0) {
+    return;
+  }
+  NSUInteger removedCount = [self.elementCache removeObjectsNotAccessedWithin:timeToLive];
+  if (removedCount > 0) {
+    @synchronized (self) {
+      self.expirationsCount += removedCount;
+    }
   }
 }
 
+/**
+ Estimates the amount of memory retained by the cached element,
+ which is mostly occupied by its recent snapshot subtree
+
+ @param element The element to estimate
+ @returns The estimated size in bytes
+ */
++ (NSUInteger)estimatedRetainedSizeWithElement:(XCUIElement *)element
+{
+  id<FBXCElementSnapshot> snapshot = element.lastSnapshot;
+  __block NSUInteger nodesCount = 1;
+  [snapshot enumerateDescendantsUsingBlock:^(id<FBXCElementSnapshot> descendant) {
+    nodesCount++;
+  }];
+  return nodesCount * SNAPSHOT_NODE_SIZE_ESTIMATE;
+}
+
 @end
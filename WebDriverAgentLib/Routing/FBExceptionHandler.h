@@ -9,6 +9,8 @@
 #import <Foundation/Foundation.h>
 #import <WebDriverAgentLib/FBWebServer.h>
 
+@protocol FBResponsePayload;
+
 NS_ASSUME_NONNULL_BEGIN
 
 /**
@@ -24,6 +26,14 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)handleException:(NSException *)exception forResponse:(RouteResponse *)response;
 
+/**
+ Converts 'exception' raised by a command handler to the corresponding error payload
+
+ @param exception exception that needs handling
+ @return error response payload
+ */
+- (id<FBResponsePayload>)payloadForException:(NSException *)exception;
+
 @end
 
 NS_ASSUME_NONNULL_END
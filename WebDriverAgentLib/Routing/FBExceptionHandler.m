@@ -16,6 +16,11 @@
 @implementation FBExceptionHandler
 
 - (void)handleException:(NSException *)exception forResponse:(RouteResponse *)response
+{
+  [[self payloadForException:exception] dispatchWithResponse:response];
+}
+
+- (id<FBResponsePayload>)payloadForException:(NSException *)exception
 {
   FBCommandStatus *commandStatus;
   NSString *traceback = [NSString stringWithFormat:@"%@", exception.callStackSymbols];
@@ -51,8 +56,7 @@
     commandStatus = [FBCommandStatus unknownErrorWithMessage:exception.reason
                                                    traceback:traceback];
   }
-  id<FBResponsePayload> payload = FBResponseWithStatus(commandStatus);
-  [payload dispatchWithResponse:response];
+  return FBResponseWithStatus(commandStatus);
 }
 
 @end
@@ -0,0 +1,24 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBResponseJSONPayload.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Validates the given bytes sequence in a single pass without creating any intermediate objects.
+ Overlong sequences, surrogate code points and code points beyond U+10FFFF are considered invalid,
+ which is consistent with what NSString accepts.
+
+ @param bytes The bytes to validate
+ @param length The count of bytes
+ @return YES if the given bytes are a valid UTF-8 sequence
+ */
+BOOL FBIsValidUTF8(const uint8_t *bytes, NSUInteger length);
+
+NS_ASSUME_NONNULL_END
@@ -6,8 +6,9 @@
  * LICENSE file in the root directory of this source tree.
  */
 
-#import "FBResponseJSONPayload.h"
+#import "FBResponseJSONPayload-Private.h"
 
+#import "FBConfiguration.h"
 #import "FBLogger.h"
 #import "NSDictionary+FBUtf8SafeDictionary.h"
 #import "RouteResponse.h"
@@ -19,6 +20,53 @@
 
 @end
 
+BOOL FBIsValidUTF8(const uint8_t *bytes, NSUInteger length)
+{
+  NSUInteger i = 0;
+  while (i < length) {
+    uint8_t lead = bytes[i];
+    if (lead < 0x80) {
+      i++;
+      continue;
+    }
+
+    NSUInteger continuationsCount;
+    uint32_t codePoint;
+    uint32_t minCodePoint;
+    if (0xC0 == (lead & 0xE0)) {
+      continuationsCount = 1;
+      codePoint = lead & 0x1F;
+      minCodePoint = 0x80;
+    } else if (0xE0 == (lead & 0xF0)) {
+      continuationsCount = 2;
+      codePoint = lead & 0x0F;
+      minCodePoint = 0x800;
+    } else if (0xF0 == (lead & 0xF8)) {
+      continuationsCount = 3;
+      codePoint = lead & 0x07;
+      minCodePoint = 0x10000;
+    } else {
+      return NO;
+    }
+    if (length - i <= continuationsCount) {
+      return NO;
+    }
+    for (NSUInteger j = 1; j <= continuationsCount; j++) {
+      uint8_t continuation = bytes[i + j];
+      if (0x80 != (continuation & 0xC0)) {
+        return NO;
+      }
+      codePoint = (codePoint << 6) | (continuation & 0x3F);
+    }
+    if (codePoint < minCodePoint || codePoint > 0x10FFFF
+        || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+      return NO;
+    }
+    i += continuationsCount + 1;
+  }
+  return YES;
+}
+
 @implementation FBResponseJSONPayload
 
 - (instancetype)initWithDictionary:(NSDictionary *)dictionary
@@ -37,17 +85,23 @@
   return self;
 }
 
+- (id)value
+{
+  return self.dictionary[@"value"];
+}
+
 - (void)dispatchWithResponse:(RouteResponse *)response
 {
+  NSJSONWritingOptions options = FBConfiguration.compactJsonResponses ? 0 : NSJSONWritingPrettyPrinted;
   NSError *error;
   NSData *jsonData = [NSJSONSerialization dataWithJSONObject:self.dictionary
-                                                     options:NSJSONWritingPrettyPrinted
+                                                     options:options
                                                        error:&error];
   NSCAssert(jsonData, @"Valid JSON must be responded, error of %@", error);
-  if (nil == [[NSString alloc] initWithData:jsonData encoding:NSUTF8StringEncoding]) {
+  if (!FBIsValidUTF8((const uint8_t *)jsonData.bytes, jsonData.length)) {
     [FBLogger log:@"The incoming data cannot be encoded to UTF-8 JSON. Applying lossy conversion as a workaround."];
     jsonData = [NSJSONSerialization dataWithJSONObject:[self.dictionary fb_utf8SafeDictionary]
-                                               options:NSJSONWritingPrettyPrinted
+                                               options:options
                                                  error:&error];
   }
   NSCAssert(jsonData, @"Valid JSON must be responded, error of %@", error);
@@ -9,6 +9,7 @@
 #import <Foundation/Foundation.h>
 
 #import <WebDriverAgentLib/FBCommandStatus.h>
+#import <WebDriverAgentLib/FBHTTPStatusCodes.h>
 
 @class FBElementCache;
 @class RouteResponse;
@@ -27,6 +28,12 @@ id<FBResponsePayload> FBResponseWithOK(void);
  */
 id<FBResponsePayload> FBResponseWithObject(id _Nullable object);
 
+/**
+ Returns 'FBCommandStatusNoError' response payload with the string represented by given UTF-8 encoded 'data'.
+ The string is streamed to the client instead of being converted to a JSON document in memory
+ */
+id<FBResponsePayload> FBResponseWithStreamedStringData(NSData *data);
+
 /**
  Returns 'FBCommandStatusNoError' response payload with given 'element', which will be also cached in 'elementCache'
  */
@@ -64,6 +71,12 @@ NSDictionary *FBDictionaryResponseWithElement(XCUIElement *element, BOOL compact
  */
 @protocol FBResponsePayload <NSObject>
 
+/*! HTTP status code of the response */
+@property (nonatomic, readonly) HTTPStatusCode httpStatusCode;
+
+/*! The object sent to the client under the 'value' key of the response */
+@property (nonatomic, readonly, nullable) id value;
+
 /**
  Dispatch constructed payload into given response
  */
@@ -10,6 +10,7 @@
 
 #import "FBElementCache.h"
 #import "FBResponseJSONPayload.h"
+#import "FBResponseStreamPayload.h"
 #import "FBSession.h"
 #import "FBMathUtils.h"
 #import "FBConfiguration.h"
@@ -33,6 +34,13 @@ id<FBResponsePayload> FBResponseWithObject(id object)
   return FBResponseWithStatus([FBCommandStatus okWithValue:object]);
 }
 
+id<FBResponsePayload> FBResponseWithStreamedStringData(NSData *data)
+{
+  return [[FBResponseStreamPayload alloc] initWithValueData:data
+                                                  sessionId:[FBSession activeSession].identifier
+                                             httpStatusCode:kHTTPStatusCodeOK];
+}
+
 XCUIElement *maybeStable(XCUIElement *element)
 {
   BOOL useNativeCachingStrategy = nil == FBSession.activeSession
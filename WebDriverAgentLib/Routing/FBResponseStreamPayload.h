@@ -0,0 +1,36 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <WebDriverAgentLib/FBResponsePayload.h>
+#import <WebDriverAgentLib/FBHTTPStatusCodes.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Class that represents WebDriverAgent JSON response, whose value is a big string.
+ The value is JSON-escaped on the fly and sent using chunked transfer encoding,
+ so neither the intermediate NSString nor the complete JSON document are ever created in memory.
+ */
+@interface FBResponseStreamPayload : NSObject <FBResponsePayload>
+
+/**
+ Initializer for the streamed JSON response
+
+ @param valueData UTF-8 encoded bytes of the string to be sent as the response value
+ @param sessionId The identifier of the current session or nil if there is none
+ @param httpStatusCode HTTP status code of the response
+ */
+- (instancetype)initWithValueData:(NSData *)valueData
+                        sessionId:(nullable NSString *)sessionId
+                   httpStatusCode:(HTTPStatusCode)httpStatusCode;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,197 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBResponseStreamPayload.h"
+
+#import "FBConfiguration.h"
+#import "HTTPResponse.h"
+#import "RouteResponse.h"
+
+// The longest escape sequence is \u00XX
+static const NSUInteger MAX_ESCAPED_CHAR_LENGTH = 6;
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+/**
+ Chunked HTTP response, which sends the given prefix, then the JSON-escaped value
+ and then the given suffix. Only the chunk requested by the connection is escaped at once.
+ */
+@interface FBJSONStringChunkedResponse : NSObject <HTTPResponse>
+
+- (instancetype)initWithPrefix:(NSData *)prefix
+                         value:(NSData *)value
+                        suffix:(NSData *)suffix;
+
+@end
+
+@implementation FBJSONStringChunkedResponse
+{
+  NSData *_prefix;
+  NSData *_value;
+  NSData *_suffix;
+  NSUInteger _valuePosition;
+  BOOL _isPrefixSent;
+  BOOL _isDone;
+  UInt64 _offset;
+}
+
+- (instancetype)initWithPrefix:(NSData *)prefix
+                         value:(NSData *)value
+                        suffix:(NSData *)suffix
+{
+  if ((self = [super init])) {
+    _prefix = prefix;
+    _value = value;
+    _suffix = suffix;
+    _valuePosition = 0;
+    _isPrefixSent = NO;
+    _isDone = NO;
+    _offset = 0;
+  }
+  return self;
+}
+
+- (UInt64)contentLength
+{
+  // The actual length is not known in advance, since it depends on the escaped chars count
+  return 0;
+}
+
+- (UInt64)offset
+{
+  return _offset;
+}
+
+- (void)setOffset:(UInt64)offset
+{
+  // Range requests are not supported for chunked responses
+}
+
+- (BOOL)isChunked
+{
+  return YES;
+}
+
+- (BOOL)isDone
+{
+  return _isDone;
+}
+
+- (NSData *)readDataOfLength:(NSUInteger)length
+{
+  if (_isDone) {
+    return nil;
+  }
+
+  NSMutableData *chunk = [NSMutableData dataWithCapacity:length];
+  if (!_isPrefixSent) {
+    [chunk appendData:_prefix];
+    _isPrefixSent = YES;
+  }
+
+  const uint8_t *bytes = (const uint8_t *)_value.bytes;
+  NSUInteger valueLength = _value.length;
+  // The connection waits for more data to become available if nothing is returned,
+  // so make sure each call produces at least one char even if the requested length is tiny
+  while (_valuePosition < valueLength
+         && (0 == chunk.length || chunk.length + MAX_ESCAPED_CHAR_LENGTH <= length)) {
+    // Copy the longest run of chars, which do not need to be escaped, at once
+    NSUInteger runEnd = _valuePosition;
+    NSUInteger runLimit = MIN(valueLength, _valuePosition + MAX(length, chunk.length + 1) - chunk.length);
+    while (runEnd < runLimit && bytes[runEnd] >= 0x20 && bytes[runEnd] != '"' && bytes[runEnd] != '\\') {
+      runEnd++;
+    }
+    if (runEnd > _valuePosition) {
+      [chunk appendBytes:bytes + _valuePosition length:runEnd - _valuePosition];
+      _valuePosition = runEnd;
+      continue;
+    }
+
+    uint8_t c = bytes[_valuePosition++];
+    char escaped[MAX_ESCAPED_CHAR_LENGTH] = {'\\', 0, 0, 0, 0, 0};
+    NSUInteger escapedLength = 2;
+    switch (c) {
+      case '"': escaped[1] = '"'; break;
+      case '\\': escaped[1] = '\\'; break;
+      case '\n': escaped[1] = 'n'; break;
+      case '\r': escaped[1] = 'r'; break;
+      case '\t': escaped[1] = 't'; break;
+      case '\b': escaped[1] = 'b'; break;
+      case '\f': escaped[1] = 'f'; break;
+      default:
+        escaped[1] = 'u';
+        escaped[2] = '0';
+        escaped[3] = '0';
+        escaped[4] = HEX_DIGITS[c >> 4];
+        escaped[5] = HEX_DIGITS[c & 0xF];
+        escapedLength = MAX_ESCAPED_CHAR_LENGTH;
+        break;
+    }
+    [chunk appendBytes:escaped length:escapedLength];
+  }
+
+  if (_valuePosition >= valueLength && (0 == chunk.length || chunk.length + _suffix.length <= length)) {
+    [chunk appendData:_suffix];
+    _isDone = YES;
+  }
+  _offset += chunk.length;
+  return chunk.length > 0 ? chunk.copy : nil;
+}
+
+@end
+
+@interface FBResponseStreamPayload ()
+
+@property (nonatomic, readonly) NSData *valueData;
+@property (nonatomic, copy, readonly, nullable) NSString *sessionId;
+@property (nonatomic, readonly) HTTPStatusCode httpStatusCode;
+
+@end
+
+@implementation FBResponseStreamPayload
+
+- (instancetype)initWithValueData:(NSData *)valueData
+                        sessionId:(NSString *)sessionId
+                   httpStatusCode:(HTTPStatusCode)httpStatusCode
+{
+  if ((self = [super init])) {
+    _valueData = valueData;
+    _sessionId = [sessionId copy];
+    _httpStatusCode = httpStatusCode;
+  }
+  return self;
+}
+
+- (id)value
+{
+  return [[NSString alloc] initWithData:self.valueData encoding:NSUTF8StringEncoding];
+}
+
+- (void)dispatchWithResponse:(RouteResponse *)response
+{
+  NSError *error;
+  NSData *sessionIdData = [NSJSONSerialization dataWithJSONObject:@[self.sessionId ?: NSNull.null]
+                                                          options:0
+                                                            error:&error];
+  NSCAssert(sessionIdData, @"Valid JSON must be responded, error of %@", error);
+  // Strip the enclosing brackets of the single-item array
+  NSString *sessionIdJson = [[NSString alloc] initWithData:[sessionIdData subdataWithRange:NSMakeRange(1, sessionIdData.length - 2)]
+                                                  encoding:NSUTF8StringEncoding];
+  BOOL isCompact = FBConfiguration.compactJsonResponses;
+  NSString *prefixString = isCompact
+    ? [NSString stringWithFormat:@"{\"sessionId\":%@,\"value\":\"", sessionIdJson]
+    : [NSString stringWithFormat:@"{\n  \"sessionId\" : %@,\n  \"value\" : \"", sessionIdJson];
+  NSData *prefix = [prefixString dataUsingEncoding:NSUTF8StringEncoding];
+  NSData *suffix = [(isCompact ? @"\"}" : @"\"\n}") dataUsingEncoding:NSUTF8StringEncoding];
+  [response setHeader:@"Content-Type" value:@"application/json;charset=UTF-8"];
+  [response setStatusCode:self.httpStatusCode];
+  response.response = [[FBJSONStringChunkedResponse alloc] initWithPrefix:prefix
+                                                                    value:self.valueData
+                                                                   suffix:suffix];
+}
+
+@end
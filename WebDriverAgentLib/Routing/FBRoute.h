@@ -27,6 +27,9 @@ typedef __nonnull id<FBResponsePayload> (^FBRouteSyncHandler)(FBRouteRequest *re
 /*! Route's path */
 @property (nonatomic, copy, readonly) NSString *path;
 
+/*! Whether the route handler must be executed on the main thread. YES by default */
+@property (nonatomic, assign, readonly) BOOL requiresMainThread;
+
 /**
  Convenience constructor for GET route with given pathPattern
  */
@@ -67,6 +70,24 @@ typedef __nonnull id<FBResponsePayload> (^FBRouteSyncHandler)(FBRouteRequest *re
  */
 - (instancetype)withoutSession;
 
+/**
+ Chain-able constructor for route that does NOT change the state of the application under test,
+ for example element lookups. All routes except of GET ones are expected to have side effects by default
+ */
+- (instancetype)withoutSideEffects;
+
+/**
+ Chain-able constructor for route whose handler does NOT interact with XCTest UI APIs
+ and thus could be executed on a background queue. Such routes are not blocked
+ by long-running commands being executed on the main thread at the same time
+ */
+- (instancetype)withoutMainThread;
+
+/**
+ Handles the request and returns the resulting payload without dispatching it
+ */
+- (id<FBResponsePayload>)payloadForRequest:(FBRouteRequest *)request;
+
 /**
  Dispatches response for request
  */
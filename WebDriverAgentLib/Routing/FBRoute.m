@@ -14,10 +14,14 @@
 #import "FBExceptionHandler.h"
 #import "FBExceptions.h"
 #import "FBResponsePayload.h"
+#import "FBScreenshot-Private.h"
 #import "FBSession.h"
+#import "FBXPathDocumentCache.h"
 
 @interface FBRoute ()
 @property (nonatomic, assign, readwrite) BOOL requiresSession;
+@property (nonatomic, assign, readwrite) BOOL hasSideEffects;
+@property (nonatomic, assign, readwrite) BOOL requiresMainThread;
 @property (nonatomic, copy, readwrite) NSString *verb;
 @property (nonatomic, copy, readwrite) NSString *path;
 
@@ -35,15 +39,14 @@ static NSString *const FBRouteSessionPrefix = @"/session/:sessionID";
 
 @implementation FBRoute_TargetAction
 
-- (void)mountRequest:(FBRouteRequest *)request intoResponse:(RouteResponse *)response
+- (id<FBResponsePayload>)payloadForRequest:(FBRouteRequest *)request
 {
   [self decorateRequest:request];
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wcast-function-type-strict"
   id<FBResponsePayload> (*requestMsgSend)(id, SEL, FBRouteRequest *) = ((id<FBResponsePayload>(*)(id, SEL, FBRouteRequest *))objc_msgSend);
 #pragma clang diagnostic pop
-  id<FBResponsePayload> payload = requestMsgSend(self.target, self.action, request);
-  [payload dispatchWithResponse:response];
+  return requestMsgSend(self.target, self.action, request);
 }
 
 @end
@@ -56,11 +59,10 @@ static NSString *const FBRouteSessionPrefix = @"/session/:sessionID";
 
 @implementation FBRoute_Sync
 
-- (void)mountRequest:(FBRouteRequest *)request intoResponse:(RouteResponse *)response
+- (id<FBResponsePayload>)payloadForRequest:(FBRouteRequest *)request
 {
   [self decorateRequest:request];
-  id<FBResponsePayload> payload = self.handler(request);
-  [payload dispatchWithResponse:response];
+  return self.handler(request);
 }
 
 @end
@@ -68,12 +70,21 @@ static NSString *const FBRouteSessionPrefix = @"/session/:sessionID";
 
 @implementation FBRoute
 
+- (instancetype)init
+{
+  if ((self = [super init])) {
+    _requiresMainThread = YES;
+  }
+  return self;
+}
+
 + (instancetype)withVerb:(NSString *)verb path:(NSString *)pathPattern requiresSession:(BOOL)requiresSession
 {
   FBRoute *route = [self new];
   route.verb = verb;
   route.path = [FBRoute pathPatternWithSession:pathPattern requiresSession:requiresSession];
   route.requiresSession = requiresSession;
+  route.hasSideEffects = ![verb isEqualToString:@"GET"];
   return route;
 }
 
@@ -126,9 +137,23 @@ static NSString *const FBRouteSessionPrefix = @"/session/:sessionID";
   return self;
 }
 
+- (instancetype)withoutSideEffects
+{
+  self.hasSideEffects = NO;
+  return self;
+}
+
+- (instancetype)withoutMainThread
+{
+  self.requiresMainThread = NO;
+  return self;
+}
+
 - (instancetype)respondWithBlock:(FBRouteSyncHandler)handler
 {
   FBRoute_Sync *route = [FBRoute_Sync withVerb:self.verb path:self.path requiresSession:self.requiresSession];
+  route.hasSideEffects = self.hasSideEffects;
+  route.requiresMainThread = self.requiresMainThread;
   route.handler = handler;
   return route;
 }
@@ -136,6 +161,8 @@ static NSString *const FBRouteSessionPrefix = @"/session/:sessionID";
 - (instancetype)respondWithTarget:(id)target action:(SEL)action
 {
   FBRoute_TargetAction *route = [FBRoute_TargetAction withVerb:self.verb path:self.path requiresSession:self.requiresSession];
+  route.hasSideEffects = self.hasSideEffects;
+  route.requiresMainThread = self.requiresMainThread;
   route.target = target;
   route.action = action;
   return route;
@@ -143,6 +170,12 @@ static NSString *const FBRouteSessionPrefix = @"/session/:sessionID";
 
 - (void)decorateRequest:(FBRouteRequest *)request
 {
+  if (self.hasSideEffects) {
+    // The screen might change after this command, so documents built for previous lookups
+    // and recent screen captures are not valid anymore
+    [FBXPathDocumentCache.sharedCache invalidate];
+    [FBScreenshot invalidateCachedCaptures];
+  }
   if (!self.requiresSession) {
     return;
   }
@@ -164,11 +197,15 @@ static NSString *const FBRouteSessionPrefix = @"/session/:sessionID";
   [[NSException exceptionWithName:FBSessionDoesNotExistException reason:@"Session does not exist" userInfo:nil] raise];
 }
 
+- (id<FBResponsePayload>)payloadForRequest:(FBRouteRequest *)request
+{
+  return FBResponseWithStatus([FBCommandStatus unknownCommandErrorWithMessage:@"Unhandled route"
+                                                                    traceback:[NSString stringWithFormat:@"%@", NSThread.callStackSymbols]]);
+}
+
 - (void)mountRequest:(FBRouteRequest *)request intoResponse:(RouteResponse *)response
 {
-  id<FBResponsePayload> payload = FBResponseWithStatus([FBCommandStatus unknownCommandErrorWithMessage:@"Unhandled route"
-                                                                                             traceback:[NSString stringWithFormat:@"%@", NSThread.callStackSymbols]]);
-  [payload dispatchWithResponse:response];
+  [[self payloadForRequest:request] dispatchWithResponse:response];
 }
 
 @end
@@ -22,6 +22,7 @@
 #import "FBScreenRecordingRequest.h"
 #import "FBXCodeCompatibility.h"
 #import "FBXCTestDaemonsProxy.h"
+#import "FBXPathDocumentCache.h"
 #import "XCUIApplication+FBQuiescence.h"
 #import "XCUIElement.h"
 #import "XCUIElement+FBClassChain.h"
@@ -186,6 +187,8 @@ static FBSession *_activeSession = nil;
     [FBScreenRecordingContainer.sharedInstance reset];
   }
 
+  [FBXPathDocumentCache.sharedCache invalidate];
+
   if (nil != self.testedApplication
       && FBConfiguration.shouldTerminateApp
       && self.testedApplication.running
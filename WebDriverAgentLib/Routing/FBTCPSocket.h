@@ -23,8 +23,9 @@ NS_ASSUME_NONNULL_BEGIN
  The callback which is fired when the TCP server receives a data from a connected client
 
  @param client The client, which sent the data
+ @param data The data received from the client
 */
-- (void)didClientSendData:(GCDAsyncSocket *)client;
+- (void)didClientSendData:(GCDAsyncSocket *)client data:(NSData *)data;
 
 /**
  The callback which is fired when TCP client disconnects
@@ -33,6 +34,16 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)didClientDisconnect:(GCDAsyncSocket *)client;
 
+@optional
+
+/**
+ The callback which is fired when the data queued for the client has been completely written
+
+ @param client The client, which received the data
+ @param tag The tag the data has been queued with
+ */
+- (void)didClientReceiveData:(GCDAsyncSocket *)client withTag:(long)tag;
+
 @end
 
 
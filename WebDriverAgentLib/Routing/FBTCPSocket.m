@@ -71,7 +71,15 @@
 
 - (void)socket:(GCDAsyncSocket *)sock didReadData:(NSData *)data withTag:(long)tag
 {
-  [self.delegate didClientSendData:sock];
+  [self.delegate didClientSendData:sock data:data];
+}
+
+- (void)socket:(GCDAsyncSocket *)sock didWriteDataWithTag:(long)tag
+{
+  id<FBTCPSocketDelegate> delegate = self.delegate;
+  if ([(id)delegate respondsToSelector:@selector(didClientReceiveData:withTag:)]) {
+    [delegate didClientReceiveData:sock withTag:tag];
+  }
 }
 
 - (void)socketDidDisconnect:(GCDAsyncSocket *)sock withError:(NSError *)err
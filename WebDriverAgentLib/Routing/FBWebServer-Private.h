@@ -0,0 +1,30 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <WebDriverAgentLib/FBWebServer.h>
+
+@protocol FBCommandHandler;
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface FBWebServer ()
+
+/*! The underlying routing server. It is not listening until the service is started */
+@property (nonatomic, strong, readonly) RoutingHTTPServer *server;
+
+/**
+ Creates the routing server and registers routes of the given command handlers
+ followed by the server key routes. The server does not start listening.
+
+ @param commandHandlerClasses The list of command handler classes to register routes for
+ */
+- (void)setUpServerWithCommandHandlers:(NSArray<Class<FBCommandHandler>> *)commandHandlerClasses;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -7,14 +7,19 @@
  */
 
 #import "FBWebServer.h"
+#import "FBWebServer-Private.h"
 
+#import "Route.h"
 #import "RoutingConnection.h"
 #import "RoutingHTTPServer.h"
 
 #import "FBCommandHandler.h"
+#import "FBCommandStatus.h"
 #import "FBErrorBuilder.h"
 #import "FBExceptionHandler.h"
 #import "FBMjpegServer.h"
+#import "FBResponsePayload.h"
+#import "FBRoute.h"
 #import "FBRouteRequest.h"
 #import "FBRuntimeUtils.h"
 #import "FBSession.h"
@@ -27,6 +32,7 @@
 
 static NSString *const FBServerURLBeginMarker = @"ServerURLHere->";
 static NSString *const FBServerURLEndMarker = @"<-ServerURLHere";
+static NSString *const FBBatchRoutePath = @"/wda/batch";
 
 @interface FBHTTPConnection : RoutingConnection
 @end
@@ -44,7 +50,10 @@ static NSString *const FBServerURLEndMarker = @"<-ServerURLHere";
 
 @interface FBWebServer ()
 @property (nonatomic, strong) FBExceptionHandler *exceptionHandler;
-@property (nonatomic, strong) RoutingHTTPServer *server;
+@property (nonatomic, strong, readwrite) RoutingHTTPServer *server;
+@property (nonatomic, strong) dispatch_queue_t backgroundRoutesQueue;
+/*! Command routes by the routing server routes they have been registered with */
+@property (nonatomic, strong) NSMapTable<Route *, FBRoute *> *commandRoutes;
 @property (atomic, assign) BOOL keepAlive;
 @property (nonatomic, nullable) FBTCPSocket *screenshotsBroadcaster;
 @end
@@ -69,7 +78,6 @@ static NSString *const FBServerURLEndMarker = @"<-ServerURLHere";
 - (void)startServing
 {
   [FBLogger logFmt:@"Built at %s %s", __DATE__, __TIME__];
-  self.exceptionHandler = [FBExceptionHandler new];
   [self startHTTPServer];
   [self initScreenshotsBroadcaster];
 
@@ -79,17 +87,27 @@ static NSString *const FBServerURLEndMarker = @"<-ServerURLHere";
          [runLoop runMode:NSDefaultRunLoopMode beforeDate:[NSDate distantFuture]]);
 }
 
-- (void)startHTTPServer
+- (void)setUpServerWithCommandHandlers:(NSArray<Class<FBCommandHandler>> *)commandHandlerClasses
 {
+  self.exceptionHandler = [FBExceptionHandler new];
   self.server = [[RoutingHTTPServer alloc] init];
-  [self.server setRouteQueue:dispatch_get_main_queue()];
+  // Each route decides on its own where it should be executed (see FBRoute.requiresMainThread),
+  // so the server itself invokes handlers on connection queues
+  [self.server setRouteQueue:NULL];
+  self.backgroundRoutesQueue = dispatch_queue_create("com.facebook.wda.routes", DISPATCH_QUEUE_CONCURRENT);
+  self.commandRoutes = [NSMapTable strongToStrongObjectsMapTable];
   [self.server setDefaultHeader:@"Server" value:@"WebDriverAgent/1.0"];
   [self.server setDefaultHeader:@"Access-Control-Allow-Origin" value:@"*"];
   [self.server setDefaultHeader:@"Access-Control-Allow-Headers" value:@"Content-Type, X-Requested-With"];
   [self.server setConnectionClass:[FBHTTPConnection self]];
 
-  [self registerRouteHandlers:[self.class collectCommandHandlerClasses]];
+  [self registerRouteHandlers:commandHandlerClasses];
   [self registerServerKeyRouteHandlers];
+}
+
+- (void)startHTTPServer
+{
+  [self setUpServerWithCommandHandlers:[self.class collectCommandHandlerClasses]];
 
   NSRange serverPortRange = FBConfiguration.bindingPortRange;
   NSString *bindingIP = FBConfiguration.bindingIPAddress;
@@ -195,7 +213,7 @@ static NSString *const FBServerURLEndMarker = @"<-ServerURLHere";
   for (Class<FBCommandHandler> commandHandler in commandHandlerClasses) {
     NSArray *routes = [commandHandler routes];
     for (FBRoute *route in routes) {
-      [self.server handleMethod:route.verb withPath:route.path block:^(RouteRequest *request, RouteResponse *response) {
+      Route *serverRoute = [self.server handleMethod:route.verb withPath:route.path block:^(RouteRequest *request, RouteResponse *response) {
         NSDictionary *arguments = [NSJSONSerialization JSONObjectWithData:request.body options:NSJSONReadingMutableContainers error:NULL];
         FBRouteRequest *routeParams = [FBRouteRequest
           routeRequestWithURL:request.url
@@ -205,20 +223,41 @@ static NSString *const FBServerURLEndMarker = @"<-ServerURLHere";
 
         [FBLogger verboseLog:routeParams.description];
 
-        @try {
-          [route mountRequest:routeParams intoResponse:response];
-        }
-        @catch (NSException *exception) {
-          [self handleException:exception forResponse:response];
-        }
+        [self dispatchPayload:[self payloadForRoute:route request:routeParams] withResponse:response];
       }];
+      [self.commandRoutes setObject:route forKey:serverRoute];
     }
   }
 }
 
-- (void)handleException:(NSException *)exception forResponse:(RouteResponse *)response
+- (id<FBResponsePayload>)payloadForRoute:(FBRoute *)route request:(FBRouteRequest *)request
 {
-  [self.exceptionHandler handleException:exception forResponse:response];
+  dispatch_queue_t queue = route.requiresMainThread ? dispatch_get_main_queue() : self.backgroundRoutesQueue;
+  __block id<FBResponsePayload> payload;
+  dispatch_sync(queue, ^{
+    @autoreleasepool {
+      @try {
+        payload = [route payloadForRequest:request];
+      }
+      @catch (NSException *exception) {
+        payload = [self.exceptionHandler payloadForException:exception];
+      }
+    }
+  });
+  return payload;
+}
+
+- (void)dispatchPayload:(id<FBResponsePayload>)payload withResponse:(RouteResponse *)response
+{
+  // Payload serialization runs on the connection queue, so it must not throw past the server
+  @autoreleasepool {
+    @try {
+      [payload dispatchWithResponse:response];
+    }
+    @catch (NSException *exception) {
+      [[self.exceptionHandler payloadForException:exception] dispatchWithResponse:response];
+    }
+  }
 }
 
 - (void)registerServerKeyRouteHandlers
@@ -239,10 +278,77 @@ static NSString *const FBServerURLEndMarker = @"<-ServerURLHere";
 
   [self.server get:@"/wda/shutdown" withBlock:^(RouteRequest *request, RouteResponse *response) {
     [response respondWithString:@"Shutting down"];
-    [self.delegate webServerDidRequestShutdown:self];
+    dispatch_sync(dispatch_get_main_queue(), ^{
+      [self.delegate webServerDidRequestShutdown:self];
+    });
+  }];
+
+  [self.server post:FBBatchRoutePath withBlock:^(RouteRequest *request, RouteResponse *response) {
+    id<FBResponsePayload> payload = [self handleBatchRequest:request connection:response.connection];
+    [self dispatchPayload:payload withResponse:response];
   }];
 
   [self registerRouteHandlers:@[FBUnknownCommands.class]];
 }
 
+#pragma mark - Batch Commands
+
+- (id<FBResponsePayload>)handleBatchRequest:(RouteRequest *)request connection:(HTTPConnection *)connection
+{
+  id arguments = [NSJSONSerialization JSONObjectWithData:request.body options:NSJSONReadingMutableContainers error:NULL];
+  NSArray *commands = [arguments isKindOfClass:NSDictionary.class] ? arguments[@"commands"] : nil;
+  if (![commands isKindOfClass:NSArray.class]) {
+    NSString *message = @"The 'commands' argument must be an array of {method, path, body} items";
+    return FBResponseWithStatus([FBCommandStatus invalidArgumentErrorWithMessage:message traceback:nil]);
+  }
+  BOOL stopOnError = [arguments[@"stopOnError"] boolValue];
+
+  NSMutableArray<NSDictionary *> *results = [NSMutableArray arrayWithCapacity:commands.count];
+  for (id command in commands) {
+    id<FBResponsePayload> payload = [self payloadForBatchCommand:command connection:connection];
+    [results addObject:@{
+      @"status": @(payload.httpStatusCode),
+      @"value": payload.value ?: NSNull.null,
+    }];
+    if (stopOnError && payload.httpStatusCode >= 400) {
+      break;
+    }
+  }
+  return FBResponseWithObject(results.copy);
+}
+
+- (id<FBResponsePayload>)payloadForBatchCommand:(id)command connection:(HTTPConnection *)connection
+{
+  NSString *method = [command isKindOfClass:NSDictionary.class] ? command[@"method"] : nil;
+  NSString *path = [command isKindOfClass:NSDictionary.class] ? command[@"path"] : nil;
+  NSURL *url = [path isKindOfClass:NSString.class] ? [NSURL URLWithString:path] : nil;
+  id body = [command isKindOfClass:NSDictionary.class] ? command[@"body"] : nil;
+  if (![method isKindOfClass:NSString.class] || nil == url || nil == url.path) {
+    NSString *message = [NSString stringWithFormat:@"Each batch item must contain valid 'method' and 'path' values. Got %@ instead", command];
+    return FBResponseWithStatus([FBCommandStatus invalidArgumentErrorWithMessage:message traceback:nil]);
+  }
+  if ([url.path.lowercaseString isEqualToString:FBBatchRoutePath]) {
+    NSString *message = @"Batch commands cannot be nested";
+    return FBResponseWithStatus([FBCommandStatus invalidArgumentErrorWithMessage:message traceback:nil]);
+  }
+  if (nil != body && ![body isKindOfClass:NSNull.class] && ![body isKindOfClass:NSDictionary.class]) {
+    NSString *message = [NSString stringWithFormat:@"The 'body' of a batch item must be an object. Got %@ instead", body];
+    return FBResponseWithStatus([FBCommandStatus invalidArgumentErrorWithMessage:message traceback:nil]);
+  }
+
+  NSDictionary *params = (nil == url.query ? nil : [connection parseParams:url.query]) ?: @{};
+  Route *serverRoute = [self.server routeForMethod:method.uppercaseString withPath:url.path parameters:&params];
+  FBRoute *route = nil == serverRoute ? nil : [self.commandRoutes objectForKey:serverRoute];
+  if (nil == route) {
+    NSString *message = [NSString stringWithFormat:@"Unhandled endpoint: %@ %@", method, path];
+    return FBResponseWithStatus([FBCommandStatus unknownCommandErrorWithMessage:message traceback:nil]);
+  }
+  FBRouteRequest *routeParams = [FBRouteRequest routeRequestWithURL:url
+                                                         parameters:params
+                                                          arguments:[body isKindOfClass:NSDictionary.class] ? body : @{}];
+  [FBLogger verboseLog:routeParams.description];
+  // The command is executed on the same queue as if it has been sent separately
+  return [self payloadForRoute:route request:routeParams];
+}
+
 @end
@@ -0,0 +1,59 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*! The current version of the binary page source format */
+extern const uint8_t FBBinarySourceFormatVersion;
+
+/**
+ Serializes an elements tree into the compact binary page source format.
+ All integers are unsigned LEB128 varints, signed ones are zigzag-encoded first.
+
+ magic     4 bytes 'WDAS'
+ version   1 byte
+ precision varint. Rect values are stored multiplied by this number and rounded
+ strings   varint count, then each string as varint UTF-8 length followed by its bytes
+ nodes     varint count, then each node in depth-first order as:
+           varint parent node index plus one, zero for the root node
+           varint type string index
+           zigzag varint x, y, width and height
+           varint attributes count, then each attribute as varint name and value string indexes
+
+ Element types, attribute names and values are stored in the strings table only once,
+ so repeated values like 'true' or 'Button' take a single byte per node.
+ */
+@interface FBBinarySourceWriter : NSObject
+
+/**
+ Appends a node to the tree. Parents must be appended before their children
+
+ @param parentIndex The index of the parent node, returned by a previous call, or NSNotFound for the root node
+ @param type The element type name
+ @param rect The element rect in points
+ @param attributes The element attributes. Attributes with missing values must not be included
+ @return The index of the appended node
+ */
+- (NSUInteger)appendNodeWithParentIndex:(NSUInteger)parentIndex
+                                   type:(NSString *)type
+                                   rect:(CGRect)rect
+                             attributes:(NSDictionary<NSString *, NSString *> *)attributes;
+
+/**
+ Assembles the serialized tree
+
+ @return The binary page source of all appended nodes
+ */
+- (NSData *)data;
+
+@end
+
+NS_ASSUME_NONNULL_END
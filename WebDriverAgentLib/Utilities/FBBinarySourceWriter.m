@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBBinarySourceWriter.h"
+
+const uint8_t FBBinarySourceFormatVersion = 1;
+
+static const char FBBinarySourceMagic[] = {'W', 'D', 'A', 'S'};
+// Element frames are already integral (see wdFrame), so rects are stored in whole points.
+// The precision is still written to the header, so readers do not depend on this value
+static const NSUInteger FBBinarySourceRectPrecision = 1;
+
+static void FBAppendVarint(NSMutableData *buffer, uint64_t value)
+{
+  uint8_t bytes[10];
+  NSUInteger length = 0;
+  do {
+    uint8_t byte = value & 0x7F;
+    value >>= 7;
+    bytes[length++] = value > 0 ? (byte | 0x80) : byte;
+  } while (value > 0);
+  [buffer appendBytes:bytes length:length];
+}
+
+static void FBAppendSignedVarint(NSMutableData *buffer, int64_t value)
+{
+  FBAppendVarint(buffer, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+@interface FBBinarySourceWriter ()
+@property (nonatomic, readonly) NSMutableDictionary<NSString *, NSNumber *> *stringIndexes;
+@property (nonatomic, readonly) NSMutableArray<NSString *> *strings;
+@property (nonatomic, readonly) NSMutableData *nodesData;
+@property (nonatomic) NSUInteger nodesCount;
+@end
+
+@implementation FBBinarySourceWriter
+
+- (instancetype)init
+{
+  if ((self = [super init])) {
+    _stringIndexes = [NSMutableDictionary dictionary];
+    _strings = [NSMutableArray array];
+    _nodesData = [NSMutableData data];
+  }
+  return self;
+}
+
+- (NSUInteger)indexOfString:(NSString *)string
+{
+  NSNumber *index = self.stringIndexes[string];
+  if (nil != index) {
+    return index.unsignedIntegerValue;
+  }
+  NSUInteger newIndex = self.strings.count;
+  [self.strings addObject:string];
+  self.stringIndexes[string] = @(newIndex);
+  return newIndex;
+}
+
+- (void)appendRectValue:(CGFloat)value
+{
+  FBAppendSignedVarint(self.nodesData, (int64_t)llround(value * FBBinarySourceRectPrecision));
+}
+
+- (NSUInteger)appendNodeWithParentIndex:(NSUInteger)parentIndex
+                                   type:(NSString *)type
+                                   rect:(CGRect)rect
+                             attributes:(NSDictionary<NSString *, NSString *> *)attributes
+{
+  NSMutableData *buffer = self.nodesData;
+  FBAppendVarint(buffer, NSNotFound == parentIndex ? 0 : parentIndex + 1);
+  FBAppendVarint(buffer, [self indexOfString:type]);
+  [self appendRectValue:rect.origin.x];
+  [self appendRectValue:rect.origin.y];
+  [self appendRectValue:rect.size.width];
+  [self appendRectValue:rect.size.height];
+  FBAppendVarint(buffer, attributes.count);
+  for (NSString *name in attributes) {
+    FBAppendVarint(buffer, [self indexOfString:name]);
+    FBAppendVarint(buffer, [self indexOfString:attributes[name]]);
+  }
+  return self.nodesCount++;
+}
+
+- (NSData *)data
+{
+  NSMutableData *result = [NSMutableData dataWithCapacity:self.nodesData.length + self.strings.count * 16];
+  [result appendBytes:FBBinarySourceMagic length:sizeof(FBBinarySourceMagic)];
+  [result appendBytes:&FBBinarySourceFormatVersion length:1];
+  FBAppendVarint(result, FBBinarySourceRectPrecision);
+  FBAppendVarint(result, self.strings.count);
+  for (NSString *string in self.strings) {
+    NSData *utf8Data = [string dataUsingEncoding:NSUTF8StringEncoding allowLossyConversion:YES] ?: [NSData data];
+    FBAppendVarint(result, utf8Data.length);
+    [result appendData:utf8Data];
+  }
+  FBAppendVarint(result, self.nodesCount);
+  [result appendData:self.nodesData];
+  return result.copy;
+}
+
+@end
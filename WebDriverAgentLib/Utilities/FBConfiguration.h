@@ -144,6 +144,35 @@ extern NSString *const FBSnapshotMaxDepthKey;
 + (CGFloat)mjpegScalingFactor;
 + (void)setMjpegScalingFactor:(CGFloat)scalingFactor;
 
+/**
+ Whether the mjpeg stream should automatically tune its quality, scaling factor and framerate
+ based on the measured capture, encoding and network delivery performance. Disabled by default.
+ Being enabled, mjpegServerScreenshotQuality, mjpegScalingFactor and mjpegServerFramerate
+ settings are used as upper bounds for the corresponding stream parameters.
+ */
++ (BOOL)mjpegAdaptiveStreaming;
++ (void)setMjpegAdaptiveStreaming:(BOOL)enabled;
+
+/**
+ The maximum bandwidth the mjpeg stream is allowed to consume in bytes per second.
+ Only applied if mjpegAdaptiveStreaming is enabled. The default value is zero,
+ which means the bandwidth is only limited by clients' ability to receive frames.
+ */
++ (NSUInteger)mjpegMaxBandwidth;
++ (void)setMjpegMaxBandwidth:(NSUInteger)bytesPerSecond;
+
+/**
+ The maximum interval in float seconds between two consecutive frames of the mjpeg stream
+ while the screen content is not changing. Frames identical to the previous one are neither
+ encoded nor sent to clients until this interval passes, after which the previous frame is
+ repeated to keep the connection alive. Screenshots are captured with the maximum quality
+ while the suppression is enabled, so equal screens always produce equal captures.
+ The default value is zero, which disables the duplicate frames suppression,
+ so frames are always sent at the configured framerate.
+ */
++ (NSTimeInterval)mjpegMaxIdleInterval;
++ (void)setMjpegMaxIdleInterval:(NSTimeInterval)interval;
+
 /**
  YES if verbose logging is enabled. NO otherwise.
  */
@@ -376,6 +405,59 @@ typedef NS_ENUM(NSInteger, FBConfigurationKeyboardPreference) {
 + (void)setIncludeMinMaxValueInPageSource:(BOOL)enabled;
 + (BOOL)includeMinMaxValueInPageSource;
 
+/**
+ * The maximum age in float seconds of XML documents, which are reused between
+ * consecutive XPath lookups on the same screen. Cached documents are dropped as soon as
+ * any action that might change the screen state is invoked.
+ * Setting it to zero (the default value) disables XPath documents caching.
+ *
+ * @param maxAge The maximum document age in float seconds
+ */
++ (void)setXpathDocumentCacheMaxAge:(NSTimeInterval)maxAge;
++ (NSTimeInterval)xpathDocumentCacheMaxAge;
+
+/**
+ * Whether to encode JSON responses without indentation and line breaks.
+ * Compact responses are noticeably smaller for big payloads, like page sources or lists of elements.
+ * Disabled by default.
+ *
+ * @param enabled Either YES or NO
+ */
++ (void)setCompactJsonResponses:(BOOL)enabled;
++ (BOOL)compactJsonResponses;
+
+/**
+ * The maximum estimated amount of memory in bytes, which could be retained by elements
+ * stored in the session elements cache. The estimation is based on the size of element snapshots.
+ * The least recently used elements are evicted from the cache as soon as the limit is exceeded.
+ * Setting it to zero (the default value) only limits the cache by the count of elements.
+ *
+ * @param limit The maximum size in bytes
+ */
++ (void)setElementCacheMemoryLimit:(NSUInteger)limit;
++ (NSUInteger)elementCacheMemoryLimit;
+
+/**
+ * The time in float seconds after which elements, which have not been
+ * retrieved from the session elements cache, are dropped from it.
+ * Setting it to zero (the default value) keeps elements in the cache until they are evicted.
+ *
+ * @param timeToLive The time to live in float seconds
+ */
++ (void)setElementCacheTimeToLive:(NSTimeInterval)timeToLive;
++ (NSTimeInterval)elementCacheTimeToLive;
+
+/**
+ * The maximum age in float seconds of a recent screen capture, which could be reused
+ * by screenshot requests instead of taking a new one. The capture is shared between
+ * screenshots, element screenshots and the mjpeg stream if its quality is not lower
+ * than the requested one. Setting it to zero (the default value) disables captures reuse.
+ *
+ * @param maxAge The maximum capture age in float seconds
+ */
++ (void)setScreenshotCacheMaxAge:(NSTimeInterval)maxAge;
++ (NSTimeInterval)screenshotCacheMaxAge;
+
 @end
 
 NS_ASSUME_NONNULL_END
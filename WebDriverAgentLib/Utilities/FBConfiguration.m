@@ -40,6 +40,9 @@ static CGFloat FBMjpegScalingFactor = 100.0;
 static BOOL FBMjpegShouldFixOrientation = NO;
 static NSUInteger FBMjpegServerScreenshotQuality = 25;
 static NSUInteger FBMjpegServerFramerate = 10;
+static BOOL FBMjpegAdaptiveStreaming = NO;
+static NSUInteger FBMjpegMaxBandwidth = 0;
+static NSTimeInterval FBMjpegMaxIdleInterval = 0.;
 
 // Session-specific settings
 static BOOL FBShouldTerminateApp;
@@ -57,6 +60,11 @@ static BOOL FBShouldUseCompactResponses;
 static NSString *FBElementResponseAttributes;
 static BOOL FBUseClearTextShortcut;
 static BOOL FBLimitXpathContextScope = YES;
+static NSTimeInterval FBXpathDocumentCacheMaxAge;
+static BOOL FBCompactJsonResponses = NO;
+static NSUInteger FBElementCacheMemoryLimit = 0;
+static NSTimeInterval FBElementCacheTimeToLive = 0.;
+static NSTimeInterval FBScreenshotCacheMaxAge = 0.;
 #if !TARGET_OS_TV
 static UIInterfaceOrientation FBScreenshotOrientation;
 #endif
@@ -180,6 +188,36 @@ static BOOL FBShouldIncludeMinMaxValueInPageSource = NO;
   FBMjpegShouldFixOrientation = enabled;
 }
 
++ (BOOL)mjpegAdaptiveStreaming
+{
+  return FBMjpegAdaptiveStreaming;
+}
+
++ (void)setMjpegAdaptiveStreaming:(BOOL)enabled
+{
+  FBMjpegAdaptiveStreaming = enabled;
+}
+
++ (NSUInteger)mjpegMaxBandwidth
+{
+  return FBMjpegMaxBandwidth;
+}
+
++ (void)setMjpegMaxBandwidth:(NSUInteger)bytesPerSecond
+{
+  FBMjpegMaxBandwidth = bytesPerSecond;
+}
+
++ (NSTimeInterval)mjpegMaxIdleInterval
+{
+  return FBMjpegMaxIdleInterval;
+}
+
++ (void)setMjpegMaxIdleInterval:(NSTimeInterval)interval
+{
+  FBMjpegMaxIdleInterval = interval;
+}
+
 + (BOOL)verboseLoggingEnabled
 {
   return [NSProcessInfo.processInfo.environment[@"VERBOSE_LOGGING"] boolValue];
@@ -473,6 +511,56 @@ static BOOL FBShouldIncludeMinMaxValueInPageSource = NO;
   FBLimitXpathContextScope = enabled;
 }
 
++ (NSTimeInterval)xpathDocumentCacheMaxAge
+{
+  return FBXpathDocumentCacheMaxAge;
+}
+
++ (void)setXpathDocumentCacheMaxAge:(NSTimeInterval)maxAge
+{
+  FBXpathDocumentCacheMaxAge = maxAge;
+}
+
++ (BOOL)compactJsonResponses
+{
+  return FBCompactJsonResponses;
+}
+
++ (void)setCompactJsonResponses:(BOOL)enabled
+{
+  FBCompactJsonResponses = enabled;
+}
+
++ (NSUInteger)elementCacheMemoryLimit
+{
+  return FBElementCacheMemoryLimit;
+}
+
++ (void)setElementCacheMemoryLimit:(NSUInteger)limit
+{
+  FBElementCacheMemoryLimit = limit;
+}
+
++ (NSTimeInterval)elementCacheTimeToLive
+{
+  return FBElementCacheTimeToLive;
+}
+
++ (void)setElementCacheTimeToLive:(NSTimeInterval)timeToLive
+{
+  FBElementCacheTimeToLive = timeToLive;
+}
+
++ (NSTimeInterval)screenshotCacheMaxAge
+{
+  return FBScreenshotCacheMaxAge;
+}
+
++ (void)setScreenshotCacheMaxAge:(NSTimeInterval)maxAge
+{
+  FBScreenshotCacheMaxAge = maxAge;
+}
+
 #if !TARGET_OS_TV
 + (BOOL)setScreenshotOrientation:(NSString *)orientation error:(NSError **)error
 {
@@ -540,6 +628,11 @@ static BOOL FBShouldIncludeMinMaxValueInPageSource = NO;
   FBSetCustomParameterForElementSnapshot(FBSnapshotMaxDepthKey, @50);
   FBUseClearTextShortcut = YES;
   FBLimitXpathContextScope = YES;
+  FBXpathDocumentCacheMaxAge = 0.;
+  FBCompactJsonResponses = NO;
+  FBElementCacheMemoryLimit = 0;
+  FBElementCacheTimeToLive = 0.;
+  FBScreenshotCacheMaxAge = 0.;
 #if !TARGET_OS_TV
   FBScreenshotOrientation = UIInterfaceOrientationUnknown;
 #endif
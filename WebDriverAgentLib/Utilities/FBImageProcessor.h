@@ -21,18 +21,59 @@ extern const CGFloat FBMaxCompressionQuality;
 
 @interface FBImageProcessor : NSObject
 
+/**
+ Puts the passed image on the queue and dispatches a scaling operation. If there is already a image on the
+ queue it will be replaced with the new one. Images are scaled and encoded in separate stages, so the scaling
+ of the next image overlaps with the encoding of the previous one. Completion handlers are always called in
+ the submission order, and images, which become stale before the encoding stage, are dropped
+
+ @param image The image to scale down
+ @param completionHandler called after successfully scaling down an image
+ @param scalingFactor the scaling factor in range 0.01..1.0. A value of 1.0 won't perform scaling at all
+ */
+- (void)submitImageData:(NSData *)image
+          scalingFactor:(CGFloat)scalingFactor
+      completionHandler:(void (^)(NSData *))completionHandler;
+
 /**
  Puts the passed image on the queue and dispatches a scaling operation. If there is already a image on the
  queue it will be replaced with the new one
 
  @param image The image to scale down
+ @param scalingFactor the scaling factor in range 0.01..1.0. A value of 1.0 won't perform scaling at all
+ @param compressionQuality the compression quality of the scaled JPEG image in range 0.0..1.0
  @param completionHandler called after successfully scaling down an image
+ */
+- (void)submitImageData:(NSData *)image
+          scalingFactor:(CGFloat)scalingFactor
+     compressionQuality:(CGFloat)compressionQuality
+      completionHandler:(void (^)(NSData *))completionHandler;
+
+/**
+ Puts the passed image on the queue and dispatches a scaling operation. If there is already a image on the
+ queue it will be replaced with the new one
+
+ @param image The JPEG image to scale down
  @param scalingFactor the scaling factor in range 0.01..1.0. A value of 1.0 won't perform scaling at all
+ @param compressionQuality the compression quality of the resulting JPEG image in range 0.0..1.0
+ @param sourceCompressionQuality the compression quality the source image has been encoded with.
+ Images, which do not need scaling, are still re-encoded if the requested quality is lower than this one
+ @param completionHandler called after successfully scaling down an image
  */
 - (void)submitImageData:(NSData *)image
           scalingFactor:(CGFloat)scalingFactor
+     compressionQuality:(CGFloat)compressionQuality
+sourceCompressionQuality:(CGFloat)sourceCompressionQuality
       completionHandler:(void (^)(NSData *))completionHandler;
 
+/**
+ Returns the processing statistics of submitted images: counts of processed and dropped frames
+ and average durations of the scaling and encoding stages in float seconds
+
+ @return Statistics dictionary
+ */
+- (NSDictionary<NSString *, NSNumber *> *)statistics;
+
 /**
  Scales and crops the source image
 
@@ -50,6 +91,24 @@ extern const CGFloat FBMaxCompressionQuality;
                       compressionQuality:(CGFloat)compressionQuality
                                    error:(NSError **)error;
 
+/**
+ Crops the given region of the source image, scales it and encodes the result
+
+ @param image The source image data
+ @param rect The region to crop in pixels of the source image after its orientation has been applied
+ @param uti Either UTTypePNG or UTTypeJPEG
+ @param scalingFactor Scaling factor of the cropped region in range 0.01..1.0
+ @param compressionQuality the compression quality in range 0.0..1.0. Only works if UTI is set to kUTTypeJPEG
+ @param error The actual error instance if the returned result is nil
+ @returns The cropped image data compressed according to the given UTI or nil in case of a failure
+ */
+- (nullable NSData *)croppedImageWithData:(NSData *)image
+                                     rect:(CGRect)rect
+                                      uti:(UTType *)uti
+                            scalingFactor:(CGFloat)scalingFactor
+                       compressionQuality:(CGFloat)compressionQuality
+                                    error:(NSError **)error;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -27,6 +27,14 @@ const CGFloat FBMaxCompressionQuality = 1.0f;
 @property (nonatomic) NSData *nextImage;
 @property (nonatomic, readonly) NSLock *nextImageLock;
 @property (nonatomic, readonly) dispatch_queue_t scalingQueue;
+@property (nonatomic, readonly) dispatch_queue_t encodingQueue;
+// The sequence number of the most recent frame, which has passed the scaling stage.
+// Written on the scaling queue and read on the encoding queue
+@property (atomic) NSUInteger scaledFrameNumber;
+@property (nonatomic) NSUInteger processedFramesCount;
+@property (nonatomic) NSUInteger droppedFramesCount;
+@property (nonatomic) NSTimeInterval scalingDuration;
+@property (nonatomic) NSTimeInterval encodingDuration;
 
 @end
 
@@ -38,6 +46,7 @@ const CGFloat FBMaxCompressionQuality = 1.0f;
   if (self) {
     _nextImageLock = [[NSLock alloc] init];
     _scalingQueue = dispatch_queue_create("image.scaling.queue", NULL);
+    _encodingQueue = dispatch_queue_create("image.encoding.queue", NULL);
   }
   return self;
 }
@@ -45,42 +54,180 @@ const CGFloat FBMaxCompressionQuality = 1.0f;
 - (void)submitImageData:(NSData *)image
           scalingFactor:(CGFloat)scalingFactor
       completionHandler:(void (^)(NSData *))completionHandler
+{
+  // We do not want this value to be too high because then we get images larger in size than original ones
+  // Although, we also don't want to lose too much of the quality on recompression
+  CGFloat recompressionQuality = MAX(0.9,
+                                     MIN(FBMaxCompressionQuality, FBConfiguration.mjpegServerScreenshotQuality / 100.0));
+  [self submitImageData:image
+          scalingFactor:scalingFactor
+     compressionQuality:recompressionQuality
+      completionHandler:completionHandler];
+}
+
+- (void)submitImageData:(NSData *)image
+          scalingFactor:(CGFloat)scalingFactor
+     compressionQuality:(CGFloat)compressionQuality
+      completionHandler:(void (^)(NSData *))completionHandler
+{
+  [self submitImageData:image
+          scalingFactor:scalingFactor
+     compressionQuality:compressionQuality
+sourceCompressionQuality:compressionQuality
+      completionHandler:completionHandler];
+}
+
+- (void)submitImageData:(NSData *)image
+          scalingFactor:(CGFloat)scalingFactor
+     compressionQuality:(CGFloat)compressionQuality
+sourceCompressionQuality:(CGFloat)sourceCompressionQuality
+      completionHandler:(void (^)(NSData *))completionHandler
 {
   [self.nextImageLock lock];
   if (self.nextImage != nil) {
     [FBLogger verboseLog:@"Discarding screenshot"];
+    self.droppedFramesCount++;
   }
   self.nextImage = image;
   [self.nextImageLock unlock];
 
+  // Scaling and encoding run on separate serial queues, so the next frame is already being
+  // scaled while the previous one is still encoded. Both queues are FIFO, thus frames
+  // are always delivered in the order they have been submitted
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wcompletion-handler"
   dispatch_async(self.scalingQueue, ^{
-    [self.nextImageLock lock];
-    NSData *nextImageData = self.nextImage;
-    self.nextImage = nil;
-    [self.nextImageLock unlock];
-    if (nextImageData == nil) {
-      return;
-    }
+    @autoreleasepool {
+      [self.nextImageLock lock];
+      NSData *nextImageData = self.nextImage;
+      self.nextImage = nil;
+      [self.nextImageLock unlock];
+      if (nextImageData == nil) {
+        return;
+      }
+
+      uint64_t scalingStartedAt = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+      UIImage *scaledImage = [self.class preparedImageWithData:nextImageData
+                                                 scalingFactor:scalingFactor
+      // iOS always returns screnshots in portrait orientation, but puts the real value into the metadata
+      // Use it with care. See https://github.com/appium/WebDriverAgent/pull/812
+                                                fixOrientation:FBConfiguration.mjpegShouldFixOrientation
+                                            desiredOrientation:nil];
+      NSTimeInterval scalingDuration = (clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - scalingStartedAt) / (double)NSEC_PER_SEC;
+      NSUInteger frameNumber = self.scaledFrameNumber + 1;
+      self.scaledFrameNumber = frameNumber;
+
+      dispatch_async(self.encodingQueue, ^{
+        @autoreleasepool {
+          if (frameNumber < self.scaledFrameNumber) {
+            // A newer frame has been already scaled, so there is no point to spend time on encoding this one
+            [FBLogger verboseLog:@"Discarding stale screenshot"];
+            [self.nextImageLock lock];
+            self.droppedFramesCount++;
+            [self.nextImageLock unlock];
+            return;
+          }
 
-    // We do not want this value to be too high because then we get images larger in size than original ones
-    // Although, we also don't want to lose too much of the quality on recompression
-    CGFloat recompressionQuality = MAX(0.9,
-                                       MIN(FBMaxCompressionQuality, FBConfiguration.mjpegServerScreenshotQuality / 100.0));
-    NSData *thumbnailData = [self.class fixedImageDataWithImageData:nextImageData
-                                                      scalingFactor:scalingFactor
-                                                                uti:UTTypeJPEG
-                                                 compressionQuality:recompressionQuality
-    // iOS always returns screnshots in portrait orientation, but puts the real value into the metadata
-    // Use it with care. See https://github.com/appium/WebDriverAgent/pull/812
-                                                     fixOrientation:FBConfiguration.mjpegShouldFixOrientation
-                                                 desiredOrientation:nil];
-    completionHandler(thumbnailData ?: nextImageData);
+          uint64_t encodingStartedAt = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+          NSData *thumbnailData;
+          if (nil != scaledImage) {
+            thumbnailData = [self.class encodedImageWithImage:scaledImage uti:UTTypeJPEG compressionQuality:compressionQuality];
+          } else if (compressionQuality < sourceCompressionQuality) {
+            // The source image is passed as is if it needs no scaling, unless it has a higher quality than requested
+            UIImage *sourceImage = [UIImage imageWithData:nextImageData];
+            thumbnailData = nil == sourceImage
+              ? nil
+              : [self.class encodedImageWithImage:sourceImage uti:UTTypeJPEG compressionQuality:compressionQuality];
+          } else {
+            thumbnailData = FBToJpegData(nextImageData, compressionQuality);
+          }
+          NSTimeInterval encodingDuration = (clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - encodingStartedAt) / (double)NSEC_PER_SEC;
+          [self.nextImageLock lock];
+          self.processedFramesCount++;
+          self.scalingDuration += scalingDuration;
+          self.encodingDuration += encodingDuration;
+          [self.nextImageLock unlock];
+          completionHandler(thumbnailData ?: nextImageData);
+        }
+      });
+    }
   });
 #pragma clang diagnostic pop
 }
 
+- (NSDictionary<NSString *, NSNumber *> *)statistics
+{
+  [self.nextImageLock lock];
+  NSUInteger processedFramesCount = self.processedFramesCount;
+  NSDictionary<NSString *, NSNumber *> *result = @{
+    @"processedFrames": @(processedFramesCount),
+    @"droppedFrames": @(self.droppedFramesCount),
+    @"averageScalingDuration": @(0 == processedFramesCount ? 0 : self.scalingDuration / processedFramesCount),
+    @"averageEncodingDuration": @(0 == processedFramesCount ? 0 : self.encodingDuration / processedFramesCount),
+  };
+  [self.nextImageLock unlock];
+  return result;
+}
+
+/**
+ Decodes, scales and rotates the image if needed
+
+ @return The resulting image or nil if the original image data could be used as is
+ */
++ (nullable UIImage *)preparedImageWithData:(NSData *)imageData
+                              scalingFactor:(CGFloat)scalingFactor
+                             fixOrientation:(BOOL)fixOrientation
+                         desiredOrientation:(nullable NSNumber *)orientation
+{
+  scalingFactor = MAX(FBMinScalingFactor, MIN(FBMaxScalingFactor, scalingFactor));
+  BOOL usesScaling = scalingFactor > 0.0 && scalingFactor < FBMaxScalingFactor;
+  if (!usesScaling && !fixOrientation) {
+    return nil;
+  }
+
+  UIImage *image = [UIImage imageWithData:imageData];
+  if (nil == image
+      || ((image.imageOrientation == UIImageOrientationUp || !fixOrientation) && !usesScaling)) {
+    return nil;
+  }
+
+  CGSize scaledSize = CGSizeMake(image.size.width * scalingFactor, image.size.height * scalingFactor);
+  if (!fixOrientation && usesScaling) {
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    __block UIImage *result = nil;
+    [image prepareThumbnailOfSize:scaledSize
+                completionHandler:^(UIImage * _Nullable thumbnail) {
+      result = thumbnail;
+      dispatch_semaphore_signal(semaphore);
+    }];
+    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+    return result;
+  }
+
+  UIGraphicsImageRendererFormat *format = [[UIGraphicsImageRendererFormat alloc] init];
+  format.scale = scalingFactor;
+  UIGraphicsImageRenderer *renderer = [[UIGraphicsImageRenderer alloc] initWithSize:scaledSize
+                                                                             format:format];
+  UIImageOrientation desiredOrientation = orientation == nil
+    ? image.imageOrientation
+    : (UIImageOrientation)orientation.integerValue;
+  UIImage *uiImage = [UIImage imageWithCGImage:(CGImageRef)image.CGImage
+                                         scale:image.scale
+                                   orientation:desiredOrientation];
+  return [renderer imageWithActions:^(UIGraphicsImageRendererContext * _Nonnull rendererContext) {
+    [uiImage drawInRect:CGRectMake(0, 0, scaledSize.width, scaledSize.height)];
+  }];
+}
+
++ (nullable NSData *)encodedImageWithImage:(UIImage *)image
+                                       uti:(UTType *)uti
+                        compressionQuality:(CGFloat)compressionQuality
+{
+  return [uti conformsToType:UTTypePNG]
+    ? UIImagePNGRepresentation(image)
+    : UIImageJPEGRepresentation(image, compressionQuality);
+}
+
 + (nullable NSData *)fixedImageDataWithImageData:(NSData *)imageData
                                    scalingFactor:(CGFloat)scalingFactor
                                              uti:(UTType *)uti
@@ -88,63 +235,22 @@ const CGFloat FBMaxCompressionQuality = 1.0f;
                                   fixOrientation:(BOOL)fixOrientation
                               desiredOrientation:(nullable NSNumber *)orientation
 {
-  scalingFactor = MAX(FBMinScalingFactor, MIN(FBMaxScalingFactor, scalingFactor));
-  BOOL usesScaling = scalingFactor > 0.0 && scalingFactor < FBMaxScalingFactor;
   @autoreleasepool {
-    if (!usesScaling && !fixOrientation) {
-      return [uti conformsToType:UTTypePNG] ? FBToPngData(imageData) : FBToJpegData(imageData, compressionQuality);
-    }
-  
-    UIImage *image = [UIImage imageWithData:imageData];
-    if (nil == image
-        || ((image.imageOrientation == UIImageOrientationUp || !fixOrientation) && !usesScaling)) {
+    UIImage *image = [self preparedImageWithData:imageData
+                                   scalingFactor:scalingFactor
+                                  fixOrientation:fixOrientation
+                              desiredOrientation:orientation];
+    if (nil == image) {
       return [uti conformsToType:UTTypePNG] ? FBToPngData(imageData) : FBToJpegData(imageData, compressionQuality);
     }
-    
-    CGSize scaledSize = CGSizeMake(image.size.width * scalingFactor, image.size.height * scalingFactor);
-    if (!fixOrientation && usesScaling) {
-      dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
-      __block UIImage *result = nil;
-      [image prepareThumbnailOfSize:scaledSize
-                  completionHandler:^(UIImage * _Nullable thumbnail) {
-        result = thumbnail;
-        dispatch_semaphore_signal(semaphore);
-      }];
-      dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
-      if (nil == result) {
-        return [uti conformsToType:UTTypePNG] ? FBToPngData(imageData) : FBToJpegData(imageData, compressionQuality);
-      }
-      return [uti conformsToType:UTTypePNG]
-        ? UIImagePNGRepresentation(result)
-        : UIImageJPEGRepresentation(result, compressionQuality);
-    }
-  
-    UIGraphicsImageRendererFormat *format = [[UIGraphicsImageRendererFormat alloc] init];
-    format.scale = scalingFactor;
-    UIGraphicsImageRenderer *renderer = [[UIGraphicsImageRenderer alloc] initWithSize:scaledSize
-                                                                               format:format];
-    UIImageOrientation desiredOrientation = orientation == nil
-      ? image.imageOrientation
-      : (UIImageOrientation)orientation.integerValue;
-    UIImage *uiImage = [UIImage imageWithCGImage:(CGImageRef)image.CGImage
-                                           scale:image.scale
-                                     orientation:desiredOrientation];
-    return [uti conformsToType:UTTypePNG]
-      ? [renderer PNGDataWithActions:^(UIGraphicsImageRendererContext * _Nonnull rendererContext) {
-        [uiImage drawInRect:CGRectMake(0, 0, scaledSize.width, scaledSize.height)];
-      }]
-      : [renderer JPEGDataWithCompressionQuality:compressionQuality
-                                         actions:^(UIGraphicsImageRendererContext * _Nonnull rendererContext) {
-        [uiImage drawInRect:CGRectMake(0, 0, scaledSize.width, scaledSize.height)];
-      }];
+    return [self encodedImageWithImage:image uti:uti compressionQuality:compressionQuality];
   }
 }
 
-- (nullable NSData *)scaledImageWithData:(NSData *)imageData
-                                     uti:(UTType *)uti
-                           scalingFactor:(CGFloat)scalingFactor
-                      compressionQuality:(CGFloat)compressionQuality
-                                   error:(NSError **)error
+/**
+ @return The image orientation set by FBConfiguration.screenshotOrientation or nil if it is not set
+ */
++ (nullable NSNumber *)screenshotImageOrientation
 {
   NSNumber *orientation = nil;
 #if !TARGET_OS_TV
@@ -158,13 +264,76 @@ const CGFloat FBMaxCompressionQuality = 1.0f;
     orientation = @(UIImageOrientationLeft);
   }
 #endif
+  return orientation;
+}
+
+- (nullable NSData *)scaledImageWithData:(NSData *)imageData
+                                     uti:(UTType *)uti
+                           scalingFactor:(CGFloat)scalingFactor
+                      compressionQuality:(CGFloat)compressionQuality
+                                   error:(NSError **)error
+{
   NSData *resultData = [self.class fixedImageDataWithImageData:imageData
                                                  scalingFactor:scalingFactor
                                                            uti:uti
                                             compressionQuality:compressionQuality
                                                 fixOrientation:YES
-                                            desiredOrientation:orientation];
+                                            desiredOrientation:self.class.screenshotImageOrientation];
   return resultData ?: imageData;
 }
 
+- (nullable NSData *)croppedImageWithData:(NSData *)imageData
+                                     rect:(CGRect)rect
+                                      uti:(UTType *)uti
+                            scalingFactor:(CGFloat)scalingFactor
+                       compressionQuality:(CGFloat)compressionQuality
+                                    error:(NSError **)error
+{
+  @autoreleasepool {
+    UIImage *image = [UIImage imageWithData:imageData];
+    if (nil == image) {
+      [[[FBErrorBuilder builder]
+        withDescription:@"Cannot decode the source image"]
+       buildError:error];
+      return nil;
+    }
+    NSNumber *orientation = self.class.screenshotImageOrientation;
+    if (nil != orientation) {
+      image = [UIImage imageWithCGImage:(CGImageRef)image.CGImage
+                                  scale:image.scale
+                            orientation:(UIImageOrientation)orientation.integerValue];
+    }
+
+    CGFloat imageScale = image.scale;
+    CGRect imageRect = CGRectMake(0, 0, image.size.width * imageScale, image.size.height * imageScale);
+    CGRect cropRect = CGRectIntersection(CGRectIntegral(rect), imageRect);
+    if (CGRectIsNull(cropRect) || CGRectIsEmpty(cropRect)) {
+      [[[FBErrorBuilder builder]
+        withDescriptionFormat:@"The region %@ does not intersect with the image bounds %@",
+        NSStringFromCGRect(rect), NSStringFromCGRect(imageRect)]
+       buildError:error];
+      return nil;
+    }
+
+    scalingFactor = MAX(FBMinScalingFactor, MIN(FBMaxScalingFactor, scalingFactor));
+    CGSize targetSize = CGSizeMake(MAX(1.0, round(cropRect.size.width * scalingFactor)),
+                                   MAX(1.0, round(cropRect.size.height * scalingFactor)));
+    UIGraphicsImageRendererFormat *format = [[UIGraphicsImageRendererFormat alloc] init];
+    format.scale = 1.0;
+    UIGraphicsImageRenderer *renderer = [[UIGraphicsImageRenderer alloc] initWithSize:targetSize
+                                                                               format:format];
+    // Drawing the whole image shifted by the region offset applies the orientation,
+    // the crop and the scaling in a single pass. Everything outside of the region is clipped
+    CGFloat pixelScale = scalingFactor * imageScale;
+    CGRect drawRect = CGRectMake(-cropRect.origin.x * scalingFactor, -cropRect.origin.y * scalingFactor,
+                                 image.size.width * pixelScale, image.size.height * pixelScale);
+    void (^actions)(UIGraphicsImageRendererContext *) = ^(UIGraphicsImageRendererContext *rendererContext) {
+      [image drawInRect:drawRect];
+    };
+    return [uti conformsToType:UTTypePNG]
+      ? [renderer PNGDataWithActions:actions]
+      : [renderer JPEGDataWithCompressionQuality:compressionQuality actions:actions];
+  }
+}
+
 @end
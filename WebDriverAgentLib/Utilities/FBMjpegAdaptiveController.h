@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Tunes MJPEG stream parameters based on the measured performance of the stream pipeline.
+ The controller collects capture and encode durations, frame sizes and the time clients need
+ to receive frames, and periodically lowers or raises quality, scaling factor and framerate,
+ so the stream keeps up with both the device performance and the network throughput.
+ The configured stream parameters are never exceeded.
+ */
+@interface FBMjpegAdaptiveController : NSObject
+
+/*! The recommended framerate in range 1..maxFramerate */
+@property (atomic, readonly) NSUInteger framerate;
+/*! The recommended JPEG quality in range 1..maxQuality */
+@property (atomic, readonly) NSUInteger quality;
+/*! The recommended scaling factor in percents in range 1..maxScalingFactor */
+@property (atomic, readonly) CGFloat scalingFactor;
+
+/**
+ Creates a controller, which starts with the given stream parameters
+
+ @param framerate The initial framerate
+ @param quality The initial JPEG quality in range 1..100
+ @param scalingFactor The initial scaling factor in percents in range 1..100
+ */
+- (instancetype)initWithFramerate:(NSUInteger)framerate
+                          quality:(NSUInteger)quality
+                    scalingFactor:(CGFloat)scalingFactor;
+
+/**
+ Records the measurements of a single produced frame
+
+ @param captureDuration The time spent on taking the screenshot in float seconds
+ @param encodeDuration The time spent on scaling and encoding the screenshot in float seconds
+ @param size The size of the resulting frame in bytes
+ */
+- (void)recordFrameWithCaptureDuration:(NSTimeInterval)captureDuration
+                        encodeDuration:(NSTimeInterval)encodeDuration
+                                  size:(NSUInteger)size;
+
+/**
+ Records the delivery of a single frame to a client
+
+ @param size The size of the frame in bytes
+ @param duration The time the client socket needed to send the frame in float seconds
+ */
+- (void)recordDeliveryWithSize:(NSUInteger)size duration:(NSTimeInterval)duration;
+
+/**
+ Records a frame, which has been dropped, because a client was not ready to receive it
+ */
+- (void)recordDroppedFrame;
+
+/**
+ Recalculates the recommended stream parameters based on the measurements collected
+ since the previous call and resets these measurements.
+
+ @param maxFramerate The maximum allowed framerate
+ @param maxQuality The maximum allowed JPEG quality
+ @param maxScalingFactor The maximum allowed scaling factor in percents
+ @param bandwidthLimit The maximum stream bandwidth in bytes per second. Zero means no limit
+ */
+- (void)adjustWithMaxFramerate:(NSUInteger)maxFramerate
+                    maxQuality:(NSUInteger)maxQuality
+              maxScalingFactor:(CGFloat)maxScalingFactor
+                bandwidthLimit:(NSUInteger)bandwidthLimit;
+
+@end
+
+NS_ASSUME_NONNULL_END
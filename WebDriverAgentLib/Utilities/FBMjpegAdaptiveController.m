@@ -0,0 +1,188 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBMjpegAdaptiveController.h"
+
+static const NSUInteger MIN_FRAMERATE = 1;
+static const NSUInteger FRAMERATE_STEP_UP = 2;
+static const NSUInteger MIN_QUALITY = 10;
+static const NSUInteger QUALITY_STEP = 10;
+static const CGFloat MIN_SCALING_FACTOR = 20.0;
+static const CGFloat SCALING_FACTOR_STEP = 10.0;
+// The parameters are only raised if the stream uses less than this part of the available bandwidth
+static const double BANDWIDTH_HEADROOM_RATIO = 0.5;
+
+@interface FBMjpegAdaptiveController ()
+@property (atomic, readwrite) NSUInteger framerate;
+@property (atomic, readwrite) NSUInteger quality;
+@property (atomic, readwrite) CGFloat scalingFactor;
+
+@property (nonatomic) NSUInteger framesCount;
+@property (nonatomic) NSUInteger framesSize;
+@property (nonatomic) NSTimeInterval processingDuration;
+@property (nonatomic) NSUInteger deliveredSize;
+@property (nonatomic) NSTimeInterval deliveryDuration;
+@property (nonatomic) NSTimeInterval maxDeliveryDuration;
+@property (nonatomic) NSUInteger droppedFramesCount;
+@end
+
+@implementation FBMjpegAdaptiveController
+
+- (instancetype)initWithFramerate:(NSUInteger)framerate
+                          quality:(NSUInteger)quality
+                    scalingFactor:(CGFloat)scalingFactor
+{
+  if ((self = [super init])) {
+    _framerate = MAX(framerate, MIN_FRAMERATE);
+    _quality = MAX(quality, 1);
+    _scalingFactor = MAX(scalingFactor, 1.0);
+  }
+  return self;
+}
+
+- (void)recordFrameWithCaptureDuration:(NSTimeInterval)captureDuration
+                        encodeDuration:(NSTimeInterval)encodeDuration
+                                  size:(NSUInteger)size
+{
+  @synchronized (self) {
+    self.framesCount++;
+    self.framesSize += size;
+    self.processingDuration += captureDuration + encodeDuration;
+  }
+}
+
+- (void)recordDeliveryWithSize:(NSUInteger)size duration:(NSTimeInterval)duration
+{
+  @synchronized (self) {
+    self.deliveredSize += size;
+    self.deliveryDuration += duration;
+    self.maxDeliveryDuration = MAX(self.maxDeliveryDuration, duration);
+  }
+}
+
+- (void)recordDroppedFrame
+{
+  @synchronized (self) {
+    self.droppedFramesCount++;
+  }
+}
+
+- (void)adjustWithMaxFramerate:(NSUInteger)maxFramerate
+                    maxQuality:(NSUInteger)maxQuality
+              maxScalingFactor:(CGFloat)maxScalingFactor
+                bandwidthLimit:(NSUInteger)bandwidthLimit
+{
+  @synchronized (self) {
+    maxFramerate = MAX(maxFramerate, MIN_FRAMERATE);
+    maxQuality = MAX(maxQuality, 1);
+    maxScalingFactor = MAX(maxScalingFactor, 1.0);
+    if (self.framesCount > 0) {
+      [self adjustWithBandwidthLimit:bandwidthLimit];
+    }
+    self.framerate = MIN(self.framerate, maxFramerate);
+    self.quality = MIN(self.quality, maxQuality);
+    self.scalingFactor = MIN(self.scalingFactor, maxScalingFactor);
+    if (self.framesCount > 0 && [self hasHeadroomWithBandwidthLimit:bandwidthLimit]) {
+      [self stepUpWithMaxFramerate:maxFramerate maxQuality:maxQuality maxScalingFactor:maxScalingFactor];
+    }
+    [self resetMeasurements];
+  }
+}
+
+#pragma mark - Helpers. The caller must synchronize on self
+
+- (double)averageFrameSize
+{
+  return (double)self.framesSize / self.framesCount;
+}
+
+- (NSTimeInterval)averageProcessingDuration
+{
+  return self.processingDuration / self.framesCount;
+}
+
+- (void)adjustWithBandwidthLimit:(NSUInteger)bandwidthLimit
+{
+  NSTimeInterval frameInterval = 1.0 / self.framerate;
+  // Clients cannot receive frames as fast as they are produced
+  BOOL isCongested = self.droppedFramesCount > 0 || self.maxDeliveryDuration > frameInterval;
+  BOOL isOverBudget = bandwidthLimit > 0 && self.averageFrameSize * self.framerate > bandwidthLimit;
+  if (isCongested || isOverBudget) {
+    [self stepDown];
+    return;
+  }
+  NSTimeInterval processingDuration = self.averageProcessingDuration;
+  if (processingDuration > frameInterval) {
+    // The device cannot capture and encode frames at the requested rate,
+    // so do not pretend it can
+    self.framerate = MAX(MIN_FRAMERATE, (NSUInteger)floor(1.0 / processingDuration));
+  }
+}
+
+- (BOOL)hasHeadroomWithBandwidthLimit:(NSUInteger)bandwidthLimit
+{
+  if (self.droppedFramesCount > 0) {
+    return NO;
+  }
+  NSTimeInterval frameInterval = 1.0 / self.framerate;
+  if (self.maxDeliveryDuration > frameInterval * BANDWIDTH_HEADROOM_RATIO
+      || self.averageProcessingDuration > frameInterval * BANDWIDTH_HEADROOM_RATIO) {
+    return NO;
+  }
+  double requiredBandwidth = self.averageFrameSize * self.framerate;
+  if (bandwidthLimit > 0 && requiredBandwidth > bandwidthLimit * BANDWIDTH_HEADROOM_RATIO) {
+    return NO;
+  }
+  if (self.deliveryDuration > 0) {
+    double drainRate = self.deliveredSize / self.deliveryDuration;
+    if (requiredBandwidth > drainRate * BANDWIDTH_HEADROOM_RATIO) {
+      return NO;
+    }
+  }
+  return YES;
+}
+
+- (void)stepDown
+{
+  // Lower the image quality first, since it is the cheapest way to save the bandwidth,
+  // and only then make frames smaller and rarer
+  if (self.quality > MIN_QUALITY) {
+    self.quality = MAX(MIN_QUALITY, self.quality - MIN(self.quality, QUALITY_STEP));
+  } else if (self.scalingFactor > MIN_SCALING_FACTOR) {
+    self.scalingFactor = MAX(MIN_SCALING_FACTOR, self.scalingFactor - SCALING_FACTOR_STEP);
+  } else if (self.framerate > MIN_FRAMERATE) {
+    self.framerate = MAX(MIN_FRAMERATE, self.framerate * 3 / 4);
+  }
+}
+
+- (void)stepUpWithMaxFramerate:(NSUInteger)maxFramerate
+                    maxQuality:(NSUInteger)maxQuality
+              maxScalingFactor:(CGFloat)maxScalingFactor
+{
+  // Restore the parameters in the reverse order
+  if (self.framerate < maxFramerate) {
+    self.framerate = MIN(maxFramerate, self.framerate + FRAMERATE_STEP_UP);
+  } else if (self.scalingFactor < maxScalingFactor) {
+    self.scalingFactor = MIN(maxScalingFactor, self.scalingFactor + SCALING_FACTOR_STEP);
+  } else if (self.quality < maxQuality) {
+    self.quality = MIN(maxQuality, self.quality + QUALITY_STEP);
+  }
+}
+
+- (void)resetMeasurements
+{
+  self.framesCount = 0;
+  self.framesSize = 0;
+  self.processingDuration = 0;
+  self.deliveredSize = 0;
+  self.deliveryDuration = 0;
+  self.maxDeliveryDuration = 0;
+  self.droppedFramesCount = 0;
+}
+
+@end
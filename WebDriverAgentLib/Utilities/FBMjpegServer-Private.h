@@ -0,0 +1,172 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <CoreGraphics/CoreGraphics.h>
+#import <Foundation/Foundation.h>
+
+@class FBMjpegAdaptiveController, GCDAsyncSocket;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Calculates a cheap fingerprint of the captured JPEG image. Only the entropy-coded part after
+ the Start Of Scan marker is hashed, so metadata differences do not make equal frames look changed.
+ The whole scan is processed, since a change in a small screen area only affects a few bytes of it.
+
+ @param data JPEG image data
+ @param scalingFactor The scaling factor the frame is going to be sent with
+ @return 64-bit FNV-1a hash value
+ */
+uint64_t FBJpegFrameFingerprint(NSData *data, CGFloat scalingFactor);
+
+
+/**
+ The state of a single stream client. Each client has at most one frame being written
+ to its socket. Frames produced while the client is busy are not queued: only the most
+ recent one is kept and written as soon as the current write is done, so slow clients
+ get lower framerate instead of an unbounded write queue.
+ */
+@interface FBMjpegClient : NSObject
+
+@property (nonatomic, readonly) GCDAsyncSocket *socket;
+/*! The count of frames completely written to the client */
+@property (atomic, readonly) NSUInteger deliveredFramesCount;
+/*! The count of frames skipped, because the client was not ready to receive them */
+@property (atomic, readonly) NSUInteger droppedFramesCount;
+
+- (instancetype)initWithSocket:(GCDAsyncSocket *)socket;
+
+/**
+ Writes the frame to the client or keeps it as pending if the client is busy
+
+ @param chunks The list of frame chunks to be written in the given order
+ @return NO if a previously pending frame has been dropped in favour of the given one
+ */
+- (BOOL)enqueueFrameWithChunks:(NSArray<NSData *> *)chunks;
+
+/**
+ Must be called once the last chunk of the recent frame has been written
+
+ @param size Is set to the total size of the written frame in bytes
+ @param duration Is set to the time passed since the frame write has been started in float seconds
+ */
+- (void)frameDidFinishWritingWithSize:(nullable NSUInteger *)size duration:(nullable NSTimeInterval *)duration;
+
+@end
+
+
+/**
+ Stream parameters requested by a client in the query of its HTTP request line,
+ for example `GET /?framerate=5&scalingFactor=10 HTTP/1.1`. Parameters, which are not
+ present in the request, follow the corresponding FBConfiguration values.
+ */
+@interface FBMjpegStreamProfile : NSObject
+
+/*! The requested framerate in range 1..60 */
+@property (nonatomic, readonly, nullable) NSNumber *framerate;
+/*! The requested JPEG quality in range 1..100 */
+@property (nonatomic, readonly, nullable) NSNumber *quality;
+/*! The requested scaling factor in percents in range 1..100 */
+@property (nonatomic, readonly, nullable) NSNumber *scalingFactor;
+
+/*! The framerate to stream with */
+@property (nonatomic, readonly) NSUInteger maxFramerate;
+/*! The JPEG quality to stream with */
+@property (nonatomic, readonly) NSUInteger maxQuality;
+/*! The scaling factor in percents to stream with */
+@property (nonatomic, readonly) CGFloat maxScalingFactor;
+
+/**
+ Parses the profile from the beginning of the client request. Unknown or invalid
+ query parameters are ignored.
+
+ @param data The data received from the client
+ @return The parsed profile instance
+ */
++ (instancetype)profileWithRequestData:(NSData *)data;
+
+@end
+
+
+/**
+ Produces frames for all clients, which requested the same stream profile.
+ Each pipeline has its own image processor, so scaling frames for one profile does not
+ delay frames of other profiles, while the captured screenshot itself is shared.
+ */
+@interface FBMjpegStreamPipeline : NSObject
+
+@property (nonatomic, readonly) FBMjpegStreamProfile *profile;
+/*! Clients of the pipeline. Access must be synchronized on the array */
+@property (nonatomic, readonly) NSMutableArray<FBMjpegClient *> *clients;
+/*! The controller instance if the adaptive streaming is enabled */
+@property (atomic, nullable, readonly) FBMjpegAdaptiveController *adaptiveController;
+/*! The actual framerate. Updated by updateParametersWithTimeStarted: */
+@property (nonatomic, readonly) NSUInteger framerate;
+/*! The actual JPEG quality. Updated by updateParametersWithTimeStarted: */
+@property (nonatomic, readonly) NSUInteger quality;
+/*! The actual scaling factor in percents. Updated by updateParametersWithTimeStarted: */
+@property (nonatomic, readonly) CGFloat scalingFactor;
+/*! Setting this to zero makes the next captured frame to be sent even if the screen has not changed */
+@property (atomic) uint64_t lastFrameFingerprint;
+/*! Chunks of the recently sent frame. They are repeated if the screen has not changed for too long */
+@property (atomic, nullable, readonly) NSArray<NSData *> *lastFrameChunks;
+
+- (instancetype)initWithProfile:(FBMjpegStreamProfile *)profile;
+
+/**
+ Recalculates stream parameters of the pipeline. Creates, adjusts or drops
+ the adaptive controller depending on the current settings.
+
+ @param timeStarted The timestamp of the current capture tick
+ */
+- (void)updateParametersWithTimeStarted:(uint64_t)timeStarted;
+
+/**
+ Checks whether the pipeline needs a new frame at the current capture tick.
+ The capture might run at a higher framerate than the pipeline does.
+
+ @param timeStarted The timestamp of the current capture tick
+ @param tickInterval The capture interval in nanoseconds
+ @return YES if the pipeline needs a new frame. The frame time is remembered in such case
+ */
+- (BOOL)isFrameDueWithTimeStarted:(uint64_t)timeStarted tickInterval:(uint64_t)tickInterval;
+
+/**
+ Scales, encodes and sends the captured screenshot to clients of the pipeline
+
+ @param screenshotData The captured JPEG image
+ @param compressionQuality The compression quality the screenshot has been captured with.
+ The screenshot is re-encoded if the pipeline quality is lower than this one
+ @param timeStarted The timestamp of the current capture tick
+ @param timeCaptured The timestamp when the screenshot has been captured
+ */
+- (void)submitScreenshot:(NSData *)screenshotData
+      compressionQuality:(CGFloat)compressionQuality
+             timeStarted:(uint64_t)timeStarted
+            timeCaptured:(uint64_t)timeCaptured;
+
+/**
+ Checks whether the captured frame is the same as the recently sent one. Unchanged frames are skipped
+ until mjpegMaxIdleInterval passes, and then the recently sent frame is repeated without re-encoding it.
+
+ @param screenshotData The captured JPEG image
+ @param timeStarted The timestamp of the current frame
+ @return YES if the captured frame must not be encoded and sent
+ */
+- (BOOL)shouldSkipFrameWithData:(NSData *)screenshotData timeStarted:(uint64_t)timeStarted;
+
+/**
+ Sends the already encoded frame to all clients of the pipeline
+
+ @param screenshotData The JPEG image to send
+ */
+- (void)sendScreenshot:(NSData *)screenshotData;
+
+@end
+
+NS_ASSUME_NONNULL_END
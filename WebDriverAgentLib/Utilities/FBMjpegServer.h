@@ -15,10 +15,22 @@ NS_ASSUME_NONNULL_BEGIN
 /**
  The default constructor for the screenshot bradcaster service.
  This service sends low resolution screenshots 10 times per seconds
- to all connected clients.
+ to all connected clients. Clients may request their own framerate, quality
+ and scaling factor via query parameters of the request, for example
+ `GET /?framerate=5&quality=30&scalingFactor=10 HTTP/1.1`. Clients requesting
+ the same parameters share the same encoded frames.
  */
 - (instancetype)init;
 
+/**
+ Image processing statistics of the running broadcaster service, one item per stream profile.
+ Each item contains the profile description, FBImageProcessor statistics of its frames
+ and the list of its clients with their addresses and counts of delivered and dropped frames
+
+ @return The list of statistics or an empty list if the service is not running
+ */
++ (NSArray<NSDictionary<NSString *, id> *> *)imageProcessingStatistics;
+
 @end
 
 NS_ASSUME_NONNULL_END
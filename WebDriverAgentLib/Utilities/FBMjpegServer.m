@@ -7,6 +7,7 @@
  */
 
 #import "FBMjpegServer.h"
+#import "FBMjpegServer-Private.h"
 
 #import <mach/mach_time.h>
 @import UniformTypeIdentifiers;
@@ -14,6 +15,7 @@
 #import "GCDAsyncSocket.h"
 #import "FBConfiguration.h"
 #import "FBLogger.h"
+#import "FBMjpegAdaptiveController.h"
 #import "FBScreenshot.h"
 #import "FBImageProcessor.h"
 #import "FBImageUtils.h"
@@ -21,16 +23,354 @@
 
 static const NSUInteger MAX_FPS = 60;
 static const NSTimeInterval FRAME_TIMEOUT = 1.;
+// How often the adaptive controller recalculates stream parameters
+static const uint64_t ADAPTATION_INTERVAL_NS = NSEC_PER_SEC;
 
 static NSString *const SERVER_NAME = @"WDA MJPEG Server";
 static const char *QUEUE_NAME = "JPEG Screenshots Provider Queue";
+// The maximum length of the HTTP request line sent by a stream client
+static const NSUInteger MAX_REQUEST_LINE_LENGTH = 8192;
+// The tag of the last chunk of each frame written to a client
+static const long FRAME_END_TAG = 1;
+static const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+static __weak FBMjpegServer *FBRunningMjpegServer;
+
+uint64_t FBJpegFrameFingerprint(NSData *data, CGFloat scalingFactor)
+{
+  const uint8_t *bytes = data.bytes;
+  NSUInteger length = data.length;
+  NSUInteger offset = 0;
+  for (NSUInteger i = 0; i + 1 < length; i++) {
+    if (0xFF == bytes[i] && 0xDA == bytes[i + 1]) {
+      offset = i;
+      break;
+    }
+  }
+  uint64_t hash = FNV_OFFSET_BASIS;
+  for (; offset + sizeof(uint64_t) <= length; offset += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, bytes + offset, sizeof(uint64_t));
+    hash = (hash ^ word) * FNV_PRIME;
+  }
+  for (; offset < length; offset++) {
+    hash = (hash ^ bytes[offset]) * FNV_PRIME;
+  }
+  return (hash ^ (uint64_t)(scalingFactor * 1000)) * FNV_PRIME;
+}
+
+
+@interface FBMjpegClient ()
+@property (atomic, readwrite) NSUInteger deliveredFramesCount;
+@property (atomic, readwrite) NSUInteger droppedFramesCount;
+@property (nonatomic, nullable) NSArray<NSData *> *pendingFrameChunks;
+@property (nonatomic) BOOL isWritingFrame;
+@property (nonatomic) NSUInteger writingFrameSize;
+@property (nonatomic) uint64_t writingFrameStartedAt;
+@end
+
+@implementation FBMjpegClient
+
+- (instancetype)initWithSocket:(GCDAsyncSocket *)socket
+{
+  if ((self = [super init])) {
+    _socket = socket;
+  }
+  return self;
+}
+
+- (BOOL)enqueueFrameWithChunks:(NSArray<NSData *> *)chunks
+{
+  @synchronized (self) {
+    if (self.isWritingFrame) {
+      BOOL isDropping = nil != self.pendingFrameChunks;
+      if (isDropping) {
+        self.droppedFramesCount++;
+      }
+      self.pendingFrameChunks = chunks;
+      return !isDropping;
+    }
+    self.isWritingFrame = YES;
+  }
+  [self writeFrameWithChunks:chunks];
+  return YES;
+}
+
+- (void)frameDidFinishWritingWithSize:(NSUInteger *)size duration:(NSTimeInterval *)duration
+{
+  NSArray<NSData *> *nextFrameChunks;
+  @synchronized (self) {
+    self.deliveredFramesCount++;
+    if (NULL != size) {
+      *size = self.writingFrameSize;
+    }
+    if (NULL != duration) {
+      *duration = (clock_gettime_nsec_np(CLOCK_MONOTONIC_RAW) - self.writingFrameStartedAt) / (double)NSEC_PER_SEC;
+    }
+    nextFrameChunks = self.pendingFrameChunks;
+    self.pendingFrameChunks = nil;
+    self.isWritingFrame = nil != nextFrameChunks;
+  }
+  if (nil != nextFrameChunks) {
+    [self writeFrameWithChunks:nextFrameChunks];
+  }
+}
+
+- (void)writeFrameWithChunks:(NSArray<NSData *> *)chunks
+{
+  NSUInteger frameSize = 0;
+  for (NSData *chunk in chunks) {
+    frameSize += chunk.length;
+  }
+  @synchronized (self) {
+    self.writingFrameSize = frameSize;
+    self.writingFrameStartedAt = clock_gettime_nsec_np(CLOCK_MONOTONIC_RAW);
+  }
+  // GCDAsyncSocket retains written buffers without copying them and sends them in the order
+  // they have been queued, so the same immutable image buffer is shared between all clients
+  [chunks enumerateObjectsUsingBlock:^(NSData *chunk, NSUInteger idx, BOOL *stop) {
+    [self.socket writeData:chunk withTimeout:-1 tag:idx == chunks.count - 1 ? FRAME_END_TAG : 0];
+  }];
+}
+
+@end
+
+
+
+@implementation FBMjpegStreamProfile
+
++ (instancetype)profileWithRequestData:(NSData *)data
+{
+  FBMjpegStreamProfile *profile = [[self alloc] init];
+  NSString *request = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+  NSString *requestLine = [[request componentsSeparatedByString:@"\r\n"] firstObject];
+  NSArray<NSString *> *requestLineItems = [requestLine componentsSeparatedByString:@" "];
+  if (requestLineItems.count < 2) {
+    return profile;
+  }
+  NSURLComponents *components = [NSURLComponents componentsWithString:requestLineItems[1]];
+  for (NSURLQueryItem *item in components.queryItems) {
+    double value = item.value.doubleValue;
+    if (value <= 0) {
+      continue;
+    }
+    if ([item.name isEqualToString:@"framerate"]) {
+      profile->_framerate = @(MAX(1, MIN(MAX_FPS, (NSUInteger)value)));
+    } else if ([item.name isEqualToString:@"quality"]) {
+      profile->_quality = @(MAX(1, MIN(100, (NSUInteger)value)));
+    } else if ([item.name isEqualToString:@"scalingFactor"]) {
+      profile->_scalingFactor = @(MIN(100.0, value));
+    }
+  }
+  return profile;
+}
+
+- (NSUInteger)maxFramerate
+{
+  NSUInteger framerate = nil == self.framerate
+    ? FBConfiguration.mjpegServerFramerate
+    : self.framerate.unsignedIntegerValue;
+  return (0 == framerate || framerate > MAX_FPS) ? MAX_FPS : framerate;
+}
+
+- (NSUInteger)maxQuality
+{
+  return nil == self.quality
+    ? FBConfiguration.mjpegServerScreenshotQuality
+    : self.quality.unsignedIntegerValue;
+}
+
+- (CGFloat)maxScalingFactor
+{
+  return nil == self.scalingFactor
+    ? FBConfiguration.mjpegScalingFactor
+    : self.scalingFactor.doubleValue;
+}
+
+- (BOOL)isEqual:(id)object
+{
+  if (![object isKindOfClass:FBMjpegStreamProfile.class]) {
+    return NO;
+  }
+  FBMjpegStreamProfile *other = (FBMjpegStreamProfile *)object;
+  return (self.framerate == other.framerate || [self.framerate isEqual:other.framerate])
+    && (self.quality == other.quality || [self.quality isEqual:other.quality])
+    && (self.scalingFactor == other.scalingFactor || [self.scalingFactor isEqual:other.scalingFactor]);
+}
+
+- (NSUInteger)hash
+{
+  return self.framerate.hash ^ (self.quality.hash << 1) ^ (self.scalingFactor.hash << 2);
+}
+
+- (NSString *)description
+{
+  return [NSString stringWithFormat:@"framerate: %@, quality: %@, scaling factor: %@",
+          self.framerate ?: @"default", self.quality ?: @"default", self.scalingFactor ?: @"default"];
+}
+
+@end
+
+
+@interface FBMjpegStreamPipeline ()
+@property (atomic, nullable, readwrite) FBMjpegAdaptiveController *adaptiveController;
+@property (nonatomic, readwrite) NSUInteger framerate;
+@property (nonatomic, readwrite) NSUInteger quality;
+@property (nonatomic, readwrite) CGFloat scalingFactor;
+@property (nonatomic, readonly) FBImageProcessor *imageProcessor;
+@property (nonatomic, readonly) NSData *frameTrailer;
+@property (nonatomic) uint64_t adaptedAt;
+@property (nonatomic) uint64_t lastFrameAt;
+@property (atomic, nullable, readwrite) NSArray<NSData *> *lastFrameChunks;
+@property (nonatomic) uint64_t lastFrameSentAt;
+@end
+
+@implementation FBMjpegStreamPipeline
+
+- (instancetype)initWithProfile:(FBMjpegStreamProfile *)profile
+{
+  if ((self = [super init])) {
+    _profile = profile;
+    _clients = [NSMutableArray array];
+    _imageProcessor = [[FBImageProcessor alloc] init];
+    _frameTrailer = (id)[@"\r\n\r\n" dataUsingEncoding:NSUTF8StringEncoding];
+  }
+  return self;
+}
+
+- (void)updateParametersWithTimeStarted:(uint64_t)timeStarted
+{
+  NSUInteger maxFramerate = self.profile.maxFramerate;
+  NSUInteger maxQuality = MIN(100, self.profile.maxQuality);
+  CGFloat maxScalingFactor = MIN(100, self.profile.maxScalingFactor);
+  if (!FBConfiguration.mjpegAdaptiveStreaming) {
+    self.adaptiveController = nil;
+    self.framerate = maxFramerate;
+    self.quality = maxQuality;
+    self.scalingFactor = maxScalingFactor;
+    return;
+  }
+
+  FBMjpegAdaptiveController *controller = self.adaptiveController;
+  if (nil == controller) {
+    controller = [[FBMjpegAdaptiveController alloc] initWithFramerate:maxFramerate
+                                                              quality:maxQuality
+                                                        scalingFactor:maxScalingFactor];
+    self.adaptiveController = controller;
+    self.adaptedAt = timeStarted;
+  } else if (timeStarted - self.adaptedAt >= ADAPTATION_INTERVAL_NS) {
+    [controller adjustWithMaxFramerate:maxFramerate
+                            maxQuality:maxQuality
+                      maxScalingFactor:maxScalingFactor
+                        bandwidthLimit:FBConfiguration.mjpegMaxBandwidth];
+    self.adaptedAt = timeStarted;
+  }
+  self.framerate = controller.framerate;
+  self.quality = controller.quality;
+  self.scalingFactor = controller.scalingFactor;
+}
+
+- (BOOL)isFrameDueWithTimeStarted:(uint64_t)timeStarted tickInterval:(uint64_t)tickInterval
+{
+  uint64_t frameInterval = (uint64_t)(1.0 / MAX(self.framerate, 1) * NSEC_PER_SEC);
+  // Half of the tick is tolerated, so the pipeline does not skip a whole tick because of a timer jitter
+  if (0 != self.lastFrameAt && timeStarted - self.lastFrameAt + tickInterval / 2 < frameInterval) {
+    return NO;
+  }
+  self.lastFrameAt = timeStarted;
+  return YES;
+}
+
+- (void)submitScreenshot:(NSData *)screenshotData
+      compressionQuality:(CGFloat)captureQuality
+             timeStarted:(uint64_t)timeStarted
+            timeCaptured:(uint64_t)timeCaptured
+{
+  if ([self shouldSkipFrameWithData:screenshotData timeStarted:timeStarted]) {
+    return;
+  }
+
+  FBMjpegAdaptiveController *adaptiveController = self.adaptiveController;
+  CGFloat compressionQuality = MAX(FBMinCompressionQuality,
+                                   MIN(FBMaxCompressionQuality, self.quality / 100.0));
+  // We do not want the recompression quality to be too high because then we get images larger in size
+  // than original ones. Although, we also don't want to lose too much of the quality on recompression.
+  // A capture of a higher quality than the pipeline needs is encoded right to the pipeline quality
+  CGFloat recompressionQuality = nil == adaptiveController && captureQuality <= compressionQuality
+    ? MAX(0.9, compressionQuality)
+    : compressionQuality;
+  [self.imageProcessor submitImageData:screenshotData
+                         scalingFactor:self.scalingFactor / 100.0
+                    compressionQuality:recompressionQuality
+              sourceCompressionQuality:captureQuality
+                     completionHandler:^(NSData * _Nonnull scaled) {
+    if (nil != adaptiveController) {
+      // The encoding duration also includes the time the image has been waiting in the processor queue
+      uint64_t timeEncoded = clock_gettime_nsec_np(CLOCK_MONOTONIC_RAW);
+      [adaptiveController recordFrameWithCaptureDuration:(timeCaptured - timeStarted) / (double)NSEC_PER_SEC
+                                          encodeDuration:(timeEncoded - timeCaptured) / (double)NSEC_PER_SEC
+                                                    size:scaled.length];
+    }
+    [self sendScreenshot:scaled];
+  }];
+}
+
+- (BOOL)shouldSkipFrameWithData:(NSData *)screenshotData timeStarted:(uint64_t)timeStarted
+{
+  NSTimeInterval maxIdleInterval = FBConfiguration.mjpegMaxIdleInterval;
+  if (maxIdleInterval <= 0) {
+    return NO;
+  }
+
+  uint64_t fingerprint = FBJpegFrameFingerprint(screenshotData, self.scalingFactor);
+  if (fingerprint != self.lastFrameFingerprint) {
+    self.lastFrameFingerprint = fingerprint;
+    self.lastFrameSentAt = timeStarted;
+    return NO;
+  }
+  if (timeStarted - self.lastFrameSentAt < (uint64_t)(maxIdleInterval * NSEC_PER_SEC)) {
+    return YES;
+  }
+  NSArray<NSData *> *lastFrameChunks = self.lastFrameChunks;
+  if (nil == lastFrameChunks) {
+    return NO;
+  }
+  self.lastFrameSentAt = timeStarted;
+  [self broadcastFrameWithChunks:lastFrameChunks];
+  return YES;
+}
+
+- (void)sendScreenshot:(NSData *)screenshotData {
+  NSString *chunkHeader = [NSString stringWithFormat:@"--BoundaryString\r\nContent-type: image/jpeg\r\nContent-Length: %@\r\n\r\n", @(screenshotData.length)];
+  NSArray<NSData *> *chunks = @[
+    (id)[chunkHeader dataUsingEncoding:NSUTF8StringEncoding],
+    screenshotData,
+    self.frameTrailer,
+  ];
+  self.lastFrameChunks = chunks;
+  [self broadcastFrameWithChunks:chunks];
+}
+
+- (void)broadcastFrameWithChunks:(NSArray<NSData *> *)chunks
+{
+  FBMjpegAdaptiveController *adaptiveController = self.adaptiveController;
+  @synchronized (self.clients) {
+    for (FBMjpegClient *client in self.clients) {
+      if (![client enqueueFrameWithChunks:chunks]) {
+        [adaptiveController recordDroppedFrame];
+      }
+    }
+  }
+}
+
+@end
 
 
 @interface FBMjpegServer()
 
 @property (nonatomic, readonly) dispatch_queue_t backgroundQueue;
-@property (nonatomic, readonly) NSMutableArray<GCDAsyncSocket *> *listeningClients;
-@property (nonatomic, readonly) FBImageProcessor *imageProcessor;
+@property (nonatomic, readonly) NSMutableArray<FBMjpegStreamPipeline *> *pipelines;
 @property (nonatomic, readonly) long long mainScreenID;
 
 @end
@@ -41,18 +381,47 @@ static const char *QUEUE_NAME = "JPEG Screenshots Provider Queue";
 - (instancetype)init
 {
   if ((self = [super init])) {
-    _listeningClients = [NSMutableArray array];
+    _pipelines = [NSMutableArray array];
     dispatch_queue_attr_t queueAttributes = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_UTILITY, 0);
     _backgroundQueue = dispatch_queue_create(QUEUE_NAME, queueAttributes);
     dispatch_async(_backgroundQueue, ^{
       [self streamScreenshot];
     });
-    _imageProcessor = [[FBImageProcessor alloc] init];
     _mainScreenID = [XCUIScreen.mainScreen displayID];
+    FBRunningMjpegServer = self;
   }
   return self;
 }
 
++ (NSArray<NSDictionary<NSString *, id> *> *)imageProcessingStatistics
+{
+  FBMjpegServer *server = FBRunningMjpegServer;
+  if (nil == server) {
+    return @[];
+  }
+  NSMutableArray<NSDictionary<NSString *, id> *> *result = [NSMutableArray array];
+  @synchronized (server.pipelines) {
+    for (FBMjpegStreamPipeline *pipeline in server.pipelines) {
+      NSMutableDictionary<NSString *, id> *item = [pipeline.imageProcessor.statistics mutableCopy];
+      item[@"profile"] = pipeline.profile.description;
+      NSMutableArray<NSDictionary<NSString *, id> *> *clients = [NSMutableArray array];
+      @synchronized (pipeline.clients) {
+        for (FBMjpegClient *client in pipeline.clients) {
+          NSString *host = client.socket.connectedHost;
+          [clients addObject:@{
+            @"address": nil == host ? NSNull.null : [NSString stringWithFormat:@"%@:%d", host, client.socket.connectedPort],
+            @"deliveredFrames": @(client.deliveredFramesCount),
+            @"droppedFrames": @(client.droppedFramesCount),
+          }];
+        }
+      }
+      item[@"clients"] = clients.copy;
+      [result addObject:item.copy];
+    }
+  }
+  return result.copy;
+}
+
 - (void)scheduleNextScreenshotWithInterval:(uint64_t)timerInterval timeStarted:(uint64_t)timeStarted
 {
   uint64_t timeElapsed = clock_gettime_nsec_np(CLOCK_MONOTONIC_RAW) - timeStarted;
@@ -71,23 +440,50 @@ static const char *QUEUE_NAME = "JPEG Screenshots Provider Queue";
 
 - (void)streamScreenshot
 {
-  NSUInteger framerate = FBConfiguration.mjpegServerFramerate;
-  uint64_t timerInterval = (uint64_t)(1.0 / ((0 == framerate || framerate > MAX_FPS) ? MAX_FPS : framerate) * NSEC_PER_SEC);
   uint64_t timeStarted = clock_gettime_nsec_np(CLOCK_MONOTONIC_RAW);
-  @synchronized (self.listeningClients) {
-    if (0 == self.listeningClients.count) {
-      [self scheduleNextScreenshotWithInterval:timerInterval timeStarted:timeStarted];
-      return;
+  NSArray<FBMjpegStreamPipeline *> *pipelines;
+  @synchronized (self.pipelines) {
+    pipelines = self.pipelines.copy;
+  }
+  NSUInteger framerate = 0;
+  for (FBMjpegStreamPipeline *pipeline in pipelines) {
+    [pipeline updateParametersWithTimeStarted:timeStarted];
+    framerate = MAX(framerate, pipeline.framerate);
+  }
+  if (0 == framerate) {
+    framerate = FBConfiguration.mjpegServerFramerate;
+  }
+  // The screen is captured at the highest framerate requested by any pipeline
+  uint64_t timerInterval = (uint64_t)(1.0 / ((0 == framerate || framerate > MAX_FPS) ? MAX_FPS : framerate) * NSEC_PER_SEC);
+
+  NSMutableArray<FBMjpegStreamPipeline *> *duePipelines = [NSMutableArray array];
+  NSUInteger quality = 0;
+  for (FBMjpegStreamPipeline *pipeline in pipelines) {
+    if ([pipeline isFrameDueWithTimeStarted:timeStarted tickInterval:timerInterval]) {
+      [duePipelines addObject:pipeline];
+      quality = MAX(quality, pipeline.quality);
     }
   }
+  if (0 == duePipelines.count) {
+    [self scheduleNextScreenshotWithInterval:timerInterval timeStarted:timeStarted];
+    return;
+  }
 
   NSError *error;
-  CGFloat compressionQuality = MAX(FBMinCompressionQuality,
-                                   MIN(FBMaxCompressionQuality, FBConfiguration.mjpegServerScreenshotQuality / 100.0));
+  // Duplicate frames are detected by comparing encoded captures, so their quality must not depend
+  // on the set of due pipelines or on the adapted pipeline parameters. Each pipeline then re-encodes
+  // the capture to its own quality
+  CGFloat compressionQuality = FBConfiguration.mjpegMaxIdleInterval > 0
+    ? FBMaxCompressionQuality
+    : MAX(FBMinCompressionQuality, MIN(FBMaxCompressionQuality, quality / 100.0));
+  // A capture made for a screenshot request in the meantime could be reused, although it must not be
+  // older than a half of the tick, so the stream never repeats its own frames
+  NSTimeInterval maxCaptureAge = MIN(FBConfiguration.screenshotCacheMaxAge, timerInterval / 2.0 / NSEC_PER_SEC);
   NSData *screenshotData = [FBScreenshot takeInOriginalResolutionWithScreenID:self.mainScreenID
                                                            compressionQuality:compressionQuality
                                                                           uti:UTTypeJPEG
                                                                       timeout:FRAME_TIMEOUT
+                                                                       maxAge:maxCaptureAge
                                                                         error:&error];
   if (nil == screenshotData) {
     [FBLogger logFmt:@"%@", error.description];
@@ -95,57 +491,114 @@ static const char *QUEUE_NAME = "JPEG Screenshots Provider Queue";
     return;
   }
 
-  CGFloat scalingFactor = FBConfiguration.mjpegScalingFactor / 100.0;
-  [self.imageProcessor submitImageData:screenshotData
-                         scalingFactor:scalingFactor
-                     completionHandler:^(NSData * _Nonnull scaled) {
-    [self sendScreenshot:scaled];
-  }];
+  uint64_t timeCaptured = clock_gettime_nsec_np(CLOCK_MONOTONIC_RAW);
+  for (FBMjpegStreamPipeline *pipeline in duePipelines) {
+    [pipeline submitScreenshot:screenshotData
+            compressionQuality:compressionQuality
+                   timeStarted:timeStarted
+                  timeCaptured:timeCaptured];
+  }
 
   [self scheduleNextScreenshotWithInterval:timerInterval timeStarted:timeStarted];
 }
 
-- (void)sendScreenshot:(NSData *)screenshotData {
-  NSString *chunkHeader = [NSString stringWithFormat:@"--BoundaryString\r\nContent-type: image/jpeg\r\nContent-Length: %@\r\n\r\n", @(screenshotData.length)];
-  NSMutableData *chunk = [[chunkHeader dataUsingEncoding:NSUTF8StringEncoding] mutableCopy];
-  [chunk appendData:screenshotData];
-  [chunk appendData:(id)[@"\r\n\r\n" dataUsingEncoding:NSUTF8StringEncoding]];
-  @synchronized (self.listeningClients) {
-    for (GCDAsyncSocket *client in self.listeningClients) {
-      [client writeData:chunk withTimeout:-1 tag:0];
+- (nullable FBMjpegClient *)listeningClientWithSocket:(GCDAsyncSocket *)socket
+                                             pipeline:(FBMjpegStreamPipeline *_Nullable *_Nullable)pipeline
+{
+  @synchronized (self.pipelines) {
+    for (FBMjpegStreamPipeline *candidate in self.pipelines) {
+      @synchronized (candidate.clients) {
+        for (FBMjpegClient *client in candidate.clients) {
+          if (client.socket == socket) {
+            if (NULL != pipeline) {
+              *pipeline = candidate;
+            }
+            return client;
+          }
+        }
+      }
     }
   }
+  return nil;
 }
 
 - (void)didClientConnect:(GCDAsyncSocket *)newClient
 {
   [FBLogger logFmt:@"Got screenshots broadcast client connection at %@:%d", newClient.connectedHost, newClient.connectedPort];
-  // Start broadcast only after there is any data from the client
-  [newClient readDataWithTimeout:-1 tag:0];
+  // Start broadcast only after the client has sent its request line
+  [newClient readDataToData:[GCDAsyncSocket CRLFData]
+                withTimeout:-1
+                  maxLength:MAX_REQUEST_LINE_LENGTH
+                        tag:0];
 }
 
-- (void)didClientSendData:(GCDAsyncSocket *)client
+- (void)didClientSendData:(GCDAsyncSocket *)client data:(NSData *)data
 {
-  @synchronized (self.listeningClients) {
-    if ([self.listeningClients containsObject:client]) {
-      return;
-    }
+  if (nil != [self listeningClientWithSocket:client pipeline:nil]) {
+    return;
   }
 
-  [FBLogger logFmt:@"Starting screenshots broadcast for the client at %@:%d", client.connectedHost, client.connectedPort];
+  FBMjpegStreamProfile *profile = [FBMjpegStreamProfile profileWithRequestData:data];
+  [FBLogger logFmt:@"Starting screenshots broadcast for the client at %@:%d (%@)", client.connectedHost, client.connectedPort, profile];
   NSString *streamHeader = [NSString stringWithFormat:@"HTTP/1.0 200 OK\r\nServer: %@\r\nConnection: close\r\nMax-Age: 0\r\nExpires: 0\r\nCache-Control: no-cache, private\r\nPragma: no-cache\r\nContent-Type: multipart/x-mixed-replace; boundary=--BoundaryString\r\n\r\n", SERVER_NAME];
   [client writeData:(id)[streamHeader dataUsingEncoding:NSUTF8StringEncoding] withTimeout:-1 tag:0];
-  @synchronized (self.listeningClients) {
-    [self.listeningClients addObject:client];
+  @synchronized (self.pipelines) {
+    FBMjpegStreamPipeline *pipeline = nil;
+    for (FBMjpegStreamPipeline *candidate in self.pipelines) {
+      if ([candidate.profile isEqual:profile]) {
+        pipeline = candidate;
+        break;
+      }
+    }
+    if (nil == pipeline) {
+      pipeline = [[FBMjpegStreamPipeline alloc] initWithProfile:profile];
+      [self.pipelines addObject:pipeline];
+    }
+    @synchronized (pipeline.clients) {
+      [pipeline.clients addObject:[[FBMjpegClient alloc] initWithSocket:client]];
+    }
+    // Make sure the new client gets the current screen even if it is not changing
+    pipeline.lastFrameFingerprint = 0;
   }
 }
 
+- (void)didClientReceiveData:(GCDAsyncSocket *)client withTag:(long)tag
+{
+  if (FRAME_END_TAG != tag) {
+    return;
+  }
+  FBMjpegStreamPipeline *pipeline = nil;
+  FBMjpegClient *listeningClient = [self listeningClientWithSocket:client pipeline:&pipeline];
+  if (nil == listeningClient) {
+    return;
+  }
+  NSUInteger frameSize = 0;
+  NSTimeInterval writeDuration = 0;
+  [listeningClient frameDidFinishWritingWithSize:&frameSize duration:&writeDuration];
+  // Write durations of all pipeline clients are collected, so the stream adapts to the slowest one
+  [pipeline.adaptiveController recordDeliveryWithSize:frameSize duration:writeDuration];
+}
+
 - (void)didClientDisconnect:(GCDAsyncSocket *)client
 {
-  @synchronized (self.listeningClients) {
-    [self.listeningClients removeObject:client];
+  FBMjpegStreamPipeline *pipeline = nil;
+  FBMjpegClient *listeningClient = [self listeningClientWithSocket:client pipeline:&pipeline];
+  if (nil == listeningClient) {
+    [FBLogger log:@"Disconnected a client from screenshots broadcast"];
+    return;
+  }
+  @synchronized (self.pipelines) {
+    @synchronized (pipeline.clients) {
+      [pipeline.clients removeObject:listeningClient];
+      if (0 == pipeline.clients.count) {
+        [self.pipelines removeObject:pipeline];
+        [FBLogger verboseLogFmt:@"Stopped the stream pipeline (%@). Image processing statistics: %@",
+         pipeline.profile, pipeline.imageProcessor.statistics];
+      }
+    }
   }
-  [FBLogger log:@"Disconnected a client from screenshots broadcast"];
+  [FBLogger logFmt:@"Disconnected a client from screenshots broadcast. Frames delivered: %lu, dropped: %lu",
+   (unsigned long)listeningClient.deliveredFramesCount, (unsigned long)listeningClient.droppedFramesCount];
 }
 
 @end
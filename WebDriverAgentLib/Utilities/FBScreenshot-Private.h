@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBScreenshot.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ A recent capture of the whole screen, which could be reused by consecutive screenshot requests
+ */
+@interface FBScreenCapture : NSObject
+
+@property (nonatomic, readonly) NSData *data;
+@property (nonatomic, readonly) UTType *uti;
+@property (nonatomic, readonly) CGFloat compressionQuality;
+@property (nonatomic, readonly) long long screenID;
+/*! Monotonic timestamp of the capture in nanoseconds */
+@property (nonatomic, readonly) uint64_t capturedAt;
+
+/**
+ Creates a capture taken right now
+ */
+- (instancetype)initWithData:(NSData *)data
+                         uti:(UTType *)uti
+          compressionQuality:(CGFloat)compressionQuality
+                    screenID:(long long)screenID;
+
+/**
+ Creates a capture taken at the given CLOCK_UPTIME_RAW timestamp in nanoseconds
+ */
+- (instancetype)initWithData:(NSData *)data
+                         uti:(UTType *)uti
+          compressionQuality:(CGFloat)compressionQuality
+                    screenID:(long long)screenID
+                  capturedAt:(uint64_t)capturedAt;
+
+/**
+ @return YES if the capture is lossless, so it could be converted to any other format without losing the quality.
+ Only PNG captures are lossless
+ */
+- (BOOL)isLossless;
+
+@end
+
+@interface FBScreenshot ()
+
+/**
+ Keeps the capture for reuse. It replaces the previous capture of the same screen and format
+
+ @param capture The capture to keep
+ */
++ (void)storeCapture:(FBScreenCapture *)capture;
+
+/**
+ Drops all kept captures. Should be called if the screen might have been changed
+ */
++ (void)invalidateCachedCaptures;
+
+/**
+ Looks for a recent capture, which quality is not worse than the requested one.
+ Lossless captures are converted to the requested format if needed.
+
+ @return Image data encoded according to the given UTI or nil if there is no suitable capture
+ */
++ (nullable NSData *)cachedDataWithScreenID:(long long)screenID
+                         compressionQuality:(CGFloat)compressionQuality
+                                        uti:(UTType *)uti
+                                     maxAge:(NSTimeInterval)maxAge;
+
+@end
+
+NS_ASSUME_NONNULL_END
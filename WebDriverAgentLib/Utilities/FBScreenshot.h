@@ -39,6 +39,38 @@ NS_ASSUME_NONNULL_BEGIN
                                                   timeout:(NSTimeInterval)timeout
                                                     error:(NSError **)error;
 
+/**
+ Retrieves non-scaled screenshot of the whole screen or reuses a recent capture of it.
+ Captures are only kept if FBConfiguration.screenshotCacheMaxAge is greater than zero
+
+ @param screenID The screen identifier to take the screenshot from
+ @param compressionQuality Normalized screenshot quality value in range 0..1, where 1 is the best quality
+ @param uti UTType... constant, which defines the type of the returned screenshot image
+ @param timeout how much time to allow for the screenshot to be taken
+ @param maxAge The maximum age in float seconds of a recent capture, which could be returned
+ instead of taking a new screenshot. Zero means a new screenshot is always taken
+ @param error If there is an error, upon return contains an NSError object that describes the problem.
+ @return Device screenshot as PNG-, HEIC- or JPG-encoded data or nil in case of failure
+ */
++ (nullable NSData *)takeInOriginalResolutionWithScreenID:(long long)screenID
+                                       compressionQuality:(CGFloat)compressionQuality
+                                                      uti:(UTType *)uti
+                                                  timeout:(NSTimeInterval)timeout
+                                                   maxAge:(NSTimeInterval)maxAge
+                                                    error:(NSError **)error;
+
+/**
+ Crops the given screen area from a recent lossless capture of the whole screen
+
+ @param rect The area to crop in screen points. The screen is expected to be in portrait orientation
+ @param screenID The screen identifier the capture has been taken from
+ @param maxAge The maximum age of the capture in float seconds
+ @return PNG-encoded data or nil if there is no suitable capture
+ */
++ (nullable NSData *)cachedPngWithRect:(CGRect)rect
+                              screenID:(long long)screenID
+                                maxAge:(NSTimeInterval)maxAge;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -7,12 +7,14 @@
  */
 
 #import "FBScreenshot.h"
+#import "FBScreenshot-Private.h"
 
 @import UniformTypeIdentifiers;
 
 #import "FBConfiguration.h"
 #import "FBErrorBuilder.h"
 #import "FBImageProcessor.h"
+#import "FBImageUtils.h"
 #import "FBLogger.h"
 #import "FBMacros.h"
 #import "FBXCodeCompatibility.h"
@@ -30,6 +32,44 @@ NSString *formatTimeInterval(NSTimeInterval interval) {
   return [NSString stringWithFormat:@"%lu ms", milliseconds];
 }
 
+@implementation FBScreenCapture
+
+- (instancetype)initWithData:(NSData *)data
+                         uti:(UTType *)uti
+          compressionQuality:(CGFloat)compressionQuality
+                    screenID:(long long)screenID
+{
+  return [self initWithData:data
+                        uti:uti
+         compressionQuality:compressionQuality
+                   screenID:screenID
+                 capturedAt:clock_gettime_nsec_np(CLOCK_UPTIME_RAW)];
+}
+
+- (instancetype)initWithData:(NSData *)data
+                         uti:(UTType *)uti
+          compressionQuality:(CGFloat)compressionQuality
+                    screenID:(long long)screenID
+                  capturedAt:(uint64_t)capturedAt
+{
+  if ((self = [super init])) {
+    _data = data;
+    _uti = uti;
+    _compressionQuality = compressionQuality;
+    _screenID = screenID;
+    _capturedAt = capturedAt;
+  }
+  return self;
+}
+
+- (BOOL)isLossless
+{
+  // JPEG and HEIC encoders are lossy even at the maximum quality
+  return [self.uti conformsToType:UTTypePNG];
+}
+
+@end
+
 @implementation FBScreenshot
 
 + (CGFloat)compressionQualityWithQuality:(NSUInteger)quality
@@ -78,6 +118,7 @@ NSString *formatTimeInterval(NSTimeInterval interval) {
                                                          compressionQuality:compressionQuality
                                                                         uti:uti
                                                                     timeout:SCREENSHOT_TIMEOUT
+                                                                     maxAge:FBConfiguration.screenshotCacheMaxAge
                                                                       error:error];
   if (nil == screenshotData) {
     return nil;
@@ -95,6 +136,29 @@ NSString *formatTimeInterval(NSTimeInterval interval) {
                                          timeout:(NSTimeInterval)timeout
                                            error:(NSError **)error
 {
+  return [self.class takeInOriginalResolutionWithScreenID:screenID
+                                       compressionQuality:compressionQuality
+                                                      uti:uti
+                                                  timeout:timeout
+                                                   maxAge:0
+                                                    error:error];
+}
+
++ (NSData *)takeInOriginalResolutionWithScreenID:(long long)screenID
+                              compressionQuality:(CGFloat)compressionQuality
+                                             uti:(UTType *)uti
+                                         timeout:(NSTimeInterval)timeout
+                                          maxAge:(NSTimeInterval)maxAge
+                                           error:(NSError **)error
+{
+  NSData *cachedData = [self.class cachedDataWithScreenID:screenID
+                                       compressionQuality:compressionQuality
+                                                      uti:uti
+                                                   maxAge:maxAge];
+  if (nil != cachedData) {
+    return cachedData;
+  }
+
   id<XCTestManager_ManagerInterface> proxy = [FBXCTestDaemonsProxy testRunnerProxy];
   __block NSData *screenshotData = nil;
   __block NSError *innerError = nil;
@@ -130,9 +194,140 @@ NSString *formatTimeInterval(NSTimeInterval interval) {
   if (nil != error && nil != innerError) {
     *error = innerError;
   }
+  if (nil != screenshotData && FBConfiguration.screenshotCacheMaxAge > 0) {
+    [self.class storeCapture:[[FBScreenCapture alloc] initWithData:screenshotData
+                                                               uti:uti
+                                                compressionQuality:compressionQuality
+                                                          screenID:screenID]];
+  }
   return screenshotData;
 }
 
++ (nullable NSData *)cachedPngWithRect:(CGRect)rect
+                              screenID:(long long)screenID
+                                maxAge:(NSTimeInterval)maxAge
+{
+  FBScreenCapture *capture = nil;
+  for (FBScreenCapture *candidate in [self.class recentCapturesWithScreenID:screenID maxAge:maxAge]) {
+    if (candidate.isLossless) {
+      capture = candidate;
+      break;
+    }
+  }
+  if (nil == capture) {
+    return nil;
+  }
+
+  @autoreleasepool {
+    CGImageRef image = [UIImage imageWithData:capture.data].CGImage;
+    if (NULL == image) {
+      return nil;
+    }
+    CGFloat scale = [XCUIScreen.mainScreen scale];
+    CGRect imageRect = CGRectMake(0, 0, CGImageGetWidth(image), CGImageGetHeight(image));
+    CGRect cropRect = CGRectIntersection(CGRectIntegral(CGRectMake(rect.origin.x * scale, rect.origin.y * scale,
+                                                                   rect.size.width * scale, rect.size.height * scale)),
+                                         imageRect);
+    if (CGRectIsEmpty(cropRect)) {
+      return nil;
+    }
+    CGImageRef croppedImage = CGImageCreateWithImageInRect(image, cropRect);
+    if (NULL == croppedImage) {
+      return nil;
+    }
+    NSData *result = UIImagePNGRepresentation([UIImage imageWithCGImage:croppedImage]);
+    CGImageRelease(croppedImage);
+    return result;
+  }
+}
+
+#pragma mark - Captures cache
+
++ (NSMutableDictionary<NSString *, FBScreenCapture *> *)recentCaptures
+{
+  static NSMutableDictionary<NSString *, FBScreenCapture *> *captures;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    captures = [NSMutableDictionary dictionary];
+  });
+  return captures;
+}
+
++ (void)storeCapture:(FBScreenCapture *)capture
+{
+  // Only the most recent capture of each format is kept, so a lossy stream
+  // does not evict lossless captures made for screenshot requests
+  NSString *key = [NSString stringWithFormat:@"%lld:%@", capture.screenID, capture.uti.identifier];
+  NSMutableDictionary<NSString *, FBScreenCapture *> *captures = self.class.recentCaptures;
+  @synchronized (captures) {
+    captures[key] = capture;
+  }
+}
+
++ (void)invalidateCachedCaptures
+{
+  NSMutableDictionary<NSString *, FBScreenCapture *> *captures = self.class.recentCaptures;
+  @synchronized (captures) {
+    [captures removeAllObjects];
+  }
+}
+
+/**
+ @return Captures of the given screen not older than maxAge, the most recent ones first
+ */
++ (NSArray<FBScreenCapture *> *)recentCapturesWithScreenID:(long long)screenID
+                                                    maxAge:(NSTimeInterval)maxAge
+{
+  if (maxAge <= 0) {
+    return @[];
+  }
+
+  uint64_t now = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  uint64_t maxAgeNs = (uint64_t)(maxAge * NSEC_PER_SEC);
+  NSMutableArray<FBScreenCapture *> *result = [NSMutableArray array];
+  NSMutableDictionary<NSString *, FBScreenCapture *> *captures = self.class.recentCaptures;
+  @synchronized (captures) {
+    for (NSString *key in captures.allKeys) {
+      FBScreenCapture *capture = captures[key];
+      if (now - capture.capturedAt > (uint64_t)(MAX(FBConfiguration.screenshotCacheMaxAge, maxAge) * NSEC_PER_SEC)) {
+        // Do not keep the memory occupied by captures nobody could use anymore
+        [captures removeObjectForKey:key];
+      } else if (capture.screenID == screenID && now - capture.capturedAt <= maxAgeNs) {
+        [result addObject:capture];
+      }
+    }
+  }
+  [result sortUsingComparator:^NSComparisonResult(FBScreenCapture *a, FBScreenCapture *b) {
+    return a.capturedAt > b.capturedAt ? NSOrderedAscending : (a.capturedAt < b.capturedAt ? NSOrderedDescending : NSOrderedSame);
+  }];
+  return result.copy;
+}
+
++ (nullable NSData *)cachedDataWithScreenID:(long long)screenID
+                         compressionQuality:(CGFloat)compressionQuality
+                                        uti:(UTType *)uti
+                                     maxAge:(NSTimeInterval)maxAge
+{
+  NSArray<FBScreenCapture *> *captures = [self.class recentCapturesWithScreenID:screenID maxAge:maxAge];
+  for (FBScreenCapture *capture in captures) {
+    if ([capture.uti isEqual:uti] && (capture.isLossless || capture.compressionQuality >= compressionQuality)) {
+      return capture.data;
+    }
+  }
+  for (FBScreenCapture *capture in captures) {
+    if (!capture.isLossless) {
+      continue;
+    }
+    if ([uti conformsToType:UTTypePNG]) {
+      return FBToPngData(capture.data);
+    }
+    if ([uti conformsToType:UTTypeJPEG]) {
+      return FBToJpegData(capture.data, compressionQuality);
+    }
+  }
+  return nil;
+}
+
 + (nullable id)imageEncodingWithUniformTypeIdentifier:(UTType *)uti
                                    compressionQuality:(CGFloat)compressionQuality
                                                 error:(NSError **)error
@@ -18,6 +18,9 @@ extern NSString* const FB_SETTING_MJPEG_SERVER_SCREENSHOT_QUALITY;
 extern NSString* const FB_SETTING_MJPEG_SERVER_FRAMERATE;
 extern NSString* const FB_SETTING_MJPEG_FIX_ORIENTATION;
 extern NSString* const FB_SETTING_MJPEG_SCALING_FACTOR;
+extern NSString* const FB_SETTING_MJPEG_ADAPTIVE_STREAMING;
+extern NSString* const FB_SETTING_MJPEG_MAX_BANDWIDTH;
+extern NSString* const FB_SETTING_MJPEG_MAX_IDLE_INTERVAL;
 extern NSString* const FB_SETTING_SCREENSHOT_QUALITY;
 extern NSString* const FB_SETTING_KEYBOARD_AUTOCORRECTION;
 extern NSString* const FB_SETTING_KEYBOARD_PREDICTION;
@@ -38,6 +41,11 @@ extern NSString* const FB_SETTING_MAX_TYPING_FREQUENCY;
 extern NSString* const FB_SETTING_RESPECT_SYSTEM_ALERTS;
 extern NSString* const FB_SETTING_USE_CLEAR_TEXT_SHORTCUT;
 extern NSString* const FB_SETTING_LIMIT_XPATH_CONTEXT_SCOPE;
+extern NSString* const FB_SETTING_XPATH_DOCUMENT_CACHE_MAX_AGE;
+extern NSString* const FB_SETTING_COMPACT_JSON_RESPONSES;
+extern NSString* const FB_SETTING_ELEMENT_CACHE_MEMORY_LIMIT;
+extern NSString* const FB_SETTING_ELEMENT_CACHE_TIME_TO_LIVE;
+extern NSString* const FB_SETTING_SCREENSHOT_CACHE_MAX_AGE;
 extern NSString* const FB_SETTING_AUTO_CLICK_ALERT_SELECTOR;
 extern NSString *const FB_SETTING_INCLUDE_HITTABLE_IN_PAGE_SOURCE;
 extern NSString *const FB_SETTING_INCLUDE_NATIVE_FRAME_IN_PAGE_SOURCE;
@@ -14,6 +14,9 @@ NSString* const FB_SETTING_MJPEG_SERVER_SCREENSHOT_QUALITY = @"mjpegServerScreen
 NSString* const FB_SETTING_MJPEG_SERVER_FRAMERATE = @"mjpegServerFramerate";
 NSString* const FB_SETTING_MJPEG_SCALING_FACTOR = @"mjpegScalingFactor";
 NSString* const FB_SETTING_MJPEG_FIX_ORIENTATION = @"mjpegFixOrientation";
+NSString* const FB_SETTING_MJPEG_ADAPTIVE_STREAMING = @"mjpegAdaptiveStreaming";
+NSString* const FB_SETTING_MJPEG_MAX_BANDWIDTH = @"mjpegMaxBandwidth";
+NSString* const FB_SETTING_MJPEG_MAX_IDLE_INTERVAL = @"mjpegMaxIdleInterval";
 NSString* const FB_SETTING_SCREENSHOT_QUALITY = @"screenshotQuality";
 NSString* const FB_SETTING_KEYBOARD_AUTOCORRECTION = @"keyboardAutocorrection";
 NSString* const FB_SETTING_KEYBOARD_PREDICTION = @"keyboardPrediction";
@@ -34,6 +37,11 @@ NSString* const FB_SETTING_MAX_TYPING_FREQUENCY = @"maxTypingFrequency";
 NSString* const FB_SETTING_RESPECT_SYSTEM_ALERTS = @"respectSystemAlerts";
 NSString* const FB_SETTING_USE_CLEAR_TEXT_SHORTCUT = @"useClearTextShortcut";
 NSString* const FB_SETTING_LIMIT_XPATH_CONTEXT_SCOPE = @"limitXPathContextScope";
+NSString* const FB_SETTING_XPATH_DOCUMENT_CACHE_MAX_AGE = @"xpathDocumentCacheMaxAge";
+NSString* const FB_SETTING_COMPACT_JSON_RESPONSES = @"compactJsonResponses";
+NSString* const FB_SETTING_ELEMENT_CACHE_MEMORY_LIMIT = @"elementCacheMemoryLimit";
+NSString* const FB_SETTING_ELEMENT_CACHE_TIME_TO_LIVE = @"elementCacheTimeToLive";
+NSString* const FB_SETTING_SCREENSHOT_CACHE_MAX_AGE = @"screenshotCacheMaxAge";
 NSString* const FB_SETTING_AUTO_CLICK_ALERT_SELECTOR = @"autoClickAlertSelector";
 NSString* const FB_SETTING_INCLUDE_HITTABLE_IN_PAGE_SOURCE = @"includeHittableInPageSource";
 NSString* const FB_SETTING_INCLUDE_NATIVE_FRAME_IN_PAGE_SOURCE = @"includeNativeFrameInPageSource";
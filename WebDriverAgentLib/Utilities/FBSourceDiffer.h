@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/*! The key of the node unique identifier in flattened trees */
+extern NSString *const FBSourceDifferUidKey;
+
+/**
+ Keeps several recent page source trees and calculates structural differences between them,
+ so clients only need to fetch the full tree once and then receive changed nodes only.
+ Each kept tree is identified by an opaque token, which is returned to the client.
+ */
+@interface FBSourceDiffer : NSObject
+
+/**
+ @return singleton instance
+ */
++ (instancetype)sharedDiffer;
+
+/**
+ Creates a differ instance
+
+ @param capacity The maximum count of trees to keep. Older trees are forgotten first
+ */
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+
+/**
+ Stores the given tree and calculates its difference from the tree identified by the base token.
+ The whole tree is reported as inserted if the base tree is not known anymore
+ or it was made with different excluded attributes.
+
+ @param nodes The flattened tree. Each node is a dictionary of its attributes,
+ which must contain the unique node identifier under FBSourceDifferUidKey
+ @param baseToken The token of a previously stored tree or nil
+ @param excludedAttributes The attributes, which have been excluded from the tree
+ @return The dictionary with the following items:
+ - token: the token of the stored tree to be used as the base for the next diff
+ - base: the token of the base tree or null if the whole tree is returned
+ - inserted: the array of nodes, which are not present in the base tree, in their original order
+ - removed: the array of identifiers of base tree nodes, which are not present anymore
+ - changed: the array of dictionaries with the identifier and the new values of attributes that have changed.
+ Attributes, which are not present anymore, are set to null
+ */
+- (NSDictionary<NSString *, id> *)diffWithNodes:(NSArray<NSDictionary<NSString *, id> *> *)nodes
+                                      baseToken:(nullable NSString *)baseToken
+                             excludedAttributes:(nullable NSSet<NSString *> *)excludedAttributes;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBSourceDiffer.h"
+
+#import "LRUCache.h"
+
+NSString *const FBSourceDifferUidKey = @"uid";
+
+// Big trees might contain thousands of nodes, so only a few of them are kept
+static const NSUInteger SOURCE_DIFFER_CAPACITY = 4;
+
+@interface FBSourceDifferTree : NSObject
+@property (nonatomic, readonly) NSArray<NSDictionary<NSString *, id> *> *nodes;
+@property (nonatomic, readonly) NSDictionary<NSString *, NSDictionary<NSString *, id> *> *nodesByUid;
+@property (nonatomic, readonly) NSSet<NSString *> *excludedAttributes;
+@end
+
+@implementation FBSourceDifferTree
+
+- (instancetype)initWithNodes:(NSArray<NSDictionary<NSString *, id> *> *)nodes
+           excludedAttributes:(NSSet<NSString *> *)excludedAttributes
+{
+  if ((self = [super init])) {
+    _nodes = nodes;
+    NSMutableDictionary *nodesByUid = [NSMutableDictionary dictionaryWithCapacity:nodes.count];
+    for (NSDictionary<NSString *, id> *node in nodes) {
+      nodesByUid[node[FBSourceDifferUidKey]] = node;
+    }
+    _nodesByUid = nodesByUid.copy;
+    _excludedAttributes = excludedAttributes;
+  }
+  return self;
+}
+
+@end
+
+@interface FBSourceDiffer ()
+@property (nonatomic, readonly) LRUCache *trees;
+@end
+
+@implementation FBSourceDiffer
+
++ (instancetype)sharedDiffer
+{
+  static FBSourceDiffer *instance;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    instance = [[self alloc] initWithCapacity:SOURCE_DIFFER_CAPACITY];
+  });
+  return instance;
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity
+{
+  if ((self = [super init])) {
+    _trees = [[LRUCache alloc] initWithCapacity:capacity];
+  }
+  return self;
+}
+
+- (NSDictionary<NSString *, id> *)diffWithNodes:(NSArray<NSDictionary<NSString *, id> *> *)nodes
+                                      baseToken:(nullable NSString *)baseToken
+                             excludedAttributes:(nullable NSSet<NSString *> *)excludedAttributes
+{
+  FBSourceDifferTree *tree = [[FBSourceDifferTree alloc] initWithNodes:nodes
+                                                    excludedAttributes:excludedAttributes ?: [NSSet set]];
+  FBSourceDifferTree *baseTree = nil == baseToken ? nil : [self.trees objectForKey:(NSString *)baseToken];
+  if (nil != baseTree && ![baseTree.excludedAttributes isEqualToSet:tree.excludedAttributes]) {
+    // Attributes of such trees cannot be compared
+    baseTree = nil;
+  }
+  NSString *token = NSUUID.UUID.UUIDString;
+  [self.trees setObject:tree forKey:token];
+
+  NSMutableArray<NSDictionary<NSString *, id> *> *inserted = [NSMutableArray array];
+  NSMutableArray<NSDictionary<NSString *, id> *> *changed = [NSMutableArray array];
+  for (NSDictionary<NSString *, id> *node in nodes) {
+    NSString *uid = node[FBSourceDifferUidKey];
+    NSDictionary<NSString *, id> *baseNode = baseTree.nodesByUid[uid];
+    if (nil == baseNode) {
+      [inserted addObject:node];
+      continue;
+    }
+    if ([baseNode isEqualToDictionary:node]) {
+      continue;
+    }
+    NSMutableDictionary<NSString *, id> *changes = [NSMutableDictionary dictionary];
+    for (NSString *name in node) {
+      id value = node[name];
+      if (![baseNode[name] isEqual:value]) {
+        changes[name] = value;
+      }
+    }
+    for (NSString *name in baseNode) {
+      if (nil == node[name]) {
+        changes[name] = NSNull.null;
+      }
+    }
+    changes[FBSourceDifferUidKey] = uid;
+    [changed addObject:changes.copy];
+  }
+  NSMutableArray<NSString *> *removed = [NSMutableArray array];
+  for (NSDictionary<NSString *, id> *baseNode in baseTree.nodes) {
+    NSString *uid = baseNode[FBSourceDifferUidKey];
+    if (nil == tree.nodesByUid[uid]) {
+      [removed addObject:uid];
+    }
+  }
+  return @{
+    @"token": token,
+    @"base": nil == baseTree ? NSNull.null : (id)baseToken,
+    @"inserted": inserted.copy,
+    @"removed": removed.copy,
+    @"changed": changed.copy,
+  };
+}
+
+@end
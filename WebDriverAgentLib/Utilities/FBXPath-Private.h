@@ -10,6 +10,8 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class FBXPathCompiledQuery;
+
 @interface FBXPath ()
 
 /**
@@ -17,7 +19,6 @@ NS_ASSUME_NONNULL_BEGIN
  
  @param root the root element to execute XPath query for
  @param writer the correspondig libxml2 writer object
- @param elementStore an empty dictionary to store indexes mapping or nil if no mappings should be stored
  @param query Optional XPath query value. By analyzing this query we may optimize the lookup speed.
  @param excludedAttributes The list of XML attribute names to be excluded from the generated XML representation.
  Setting nil to this argument means that none of the known attributes must be excluded.
@@ -26,30 +27,62 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (int)xmlRepresentationWithRootElement:(id<FBXCElementSnapshot>)root
                                  writer:(xmlTextWriterPtr)writer
-                           elementStore:(nullable NSMutableDictionary *)elementStore
                                   query:(nullable NSString*)query
                     excludingAttributes:(nullable NSArray<NSString *> *)excludedAttributes;
 
+/**
+ Builds xmllib2-compatible nodes tree of an XCElementSnapshot instance directly, without the
+ intermediate serialization. Each element node keeps an unretained reference to its snapshot in the `_private` field.
+
+ @param root the root element to execute XPath query for
+ @param doc the document to set the resulting tree root to. Tag and attribute names are interned
+ if the document has a dictionary assigned
+ @param snapshotsStore an empty array, which retains all snapshots referenced by the tree nodes.
+ It must be kept alive as long as the document is used
+ @param nodesIndex Optional empty dictionary, which is going to be filled with element uid -> node
+ mapping (nodes are wrapped into NSValue pointers). It allows to resolve XPath context nodes without
+ traversing the whole tree
+ @param compiledQuery Optional compiled XPath query. Only attributes referenced by this query are included
+ @param excludedAttributes The list of XML attribute names to be excluded from the generated XML representation.
+ If `compiledQuery` argument is assigned then `excludedAttributes` argument is effectively ignored.
+ @return zero if the method has completed successfully
+ */
++ (int)xmlTreeWithRootElement:(id<FBXCElementSnapshot>)root
+                     document:(xmlDocPtr)doc
+               snapshotsStore:(NSMutableArray<id<FBXCElementSnapshot>> *)snapshotsStore
+                   nodesIndex:(nullable NSMutableDictionary<NSString *, NSValue *> *)nodesIndex
+                compiledQuery:(nullable FBXPathCompiledQuery *)compiledQuery
+          excludingAttributes:(nullable NSArray<NSString *> *)excludedAttributes;
+
 /**
  Gets the list of matched snapshots from xmllib2-compatible xmlNodeSetPtr structure
  
- @param nodeSet set of nodes returned after successful XPath evaluation
- @param elementStore dictionary containing index->snapshot mapping
+ @param nodeSet set of nodes returned after successful XPath evaluation of a tree
+ built by `xmlTreeWithRootElement`
  @return array of filtered elements or nil in case of failure. Can be empty array as well
  */
-+ (NSArray *)collectMatchingSnapshots:(xmlNodeSetPtr)nodeSet elementStore:(NSMutableDictionary *)elementStore;
++ (NSArray *)collectMatchingSnapshots:(xmlNodeSetPtr)nodeSet;
 
 /**
- Gets the list of matched XPath nodes from xmllib2-compatible XML document
- 
+ Retrieves the compiled representation of the given XPath query from the queries cache
+ or compiles it and puts the result into the cache if the query has not been seen before
+
  @param xpathQuery actual query. Should be valid XPath 1.0-compatible expression
- @param document libxml2-compatible document pointer
+ @return compiled query or nil if the query cannot be compiled
+ */
++ (nullable FBXPathCompiledQuery *)compiledQueryWithQuery:(NSString *)xpathQuery;
+
+/**
+ Gets the list of matched XPath nodes from xmllib2-compatible XML document using a precompiled query
+
+ @param compiledQuery the compiled query instance
+ @param doc libxml2-compatible document pointer
  @param contextNode Optonal context node instance
  @return pointer to a libxml2-compatible structure with set of matched nodes or NULL in case of failure
  */
-+ (xmlXPathObjectPtr)evaluate:(NSString *)xpathQuery
-                     document:(xmlDocPtr)doc
-                  contextNode:(nullable xmlNodePtr)contextNode;
++ (xmlXPathObjectPtr)evaluateCompiledQuery:(FBXPathCompiledQuery *)compiledQuery
+                                  document:(xmlDocPtr)doc
+                               contextNode:(nullable xmlNodePtr)contextNode;
 
 @end
 
@@ -54,6 +54,17 @@ NS_ASSUME_NONNULL_BEGIN
 + (nullable NSString *)xmlStringWithRootElement:(id<FBElement>)root
                                         options:(nullable FBXMLGenerationOptions *)options;
 
+/**
+ Gets XML representation of XCElementSnapshot with all its descendants as UTF-8 encoded bytes.
+ The returned data owns the buffer produced by libxml2, so no additional copies of the document are made.
+
+ @param root the root element
+ @param options Optional values that affect the resulting XML creation process
+ @return valid XML document bytes or nil in case of failure
+ */
++ (nullable NSData *)xmlDataWithRootElement:(id<FBElement>)root
+                                    options:(nullable FBXMLGenerationOptions *)options;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -14,6 +14,8 @@
 #import "FBLogger.h"
 #import "FBMacros.h"
 #import "FBXMLGenerationOptions.h"
+#import "FBXPathDocumentCache.h"
+#import "FBXPathQueryCache.h"
 #import "FBXCElementSnapshotWrapper+Helpers.h"
 #import "NSString+FBXMLSafeString.h"
 #import "XCUIApplication.h"
@@ -36,6 +38,7 @@
 
 + (int)recordWithWriter:(xmlTextWriterPtr)writer forElement:(id<FBElement>)element;
 + (int)recordWithWriter:(xmlTextWriterPtr)writer forValue:(nullable NSString *)value;
++ (int)recordWithNode:(xmlNodePtr)node forValue:(nullable NSString *)value;
 
 + (NSArray<Class> *)supportedAttributes;
 
@@ -97,12 +100,6 @@
 
 @end
 
-@interface FBInternalIndexAttribute : FBElementAttribute
-
-@property (nonatomic, nonnull, readonly) NSString* indexValue;
-
-@end
-
 @interface FBApplicationBundleIdAttribute : FBElementAttribute
 
 @end
@@ -141,9 +138,6 @@
 
 const static char *_UTF8Encoding = "UTF-8";
 
-static NSString *const kXMLIndexPathKey = @"private_indexPath";
-static NSString *const topNodeIndexPath = @"top";
-
 @implementation FBXPath
 
 + (id)throwException:(NSString *)name forQuery:(NSString *)xpathQuery
@@ -155,6 +149,13 @@ static NSString *const topNodeIndexPath = @"top";
 
 + (nullable NSString *)xmlStringWithRootElement:(id<FBElement>)root
                                         options:(nullable FBXMLGenerationOptions *)options
+{
+  NSData *xmlData = [self xmlDataWithRootElement:root options:options];
+  return nil == xmlData ? nil : [[NSString alloc] initWithData:xmlData encoding:NSUTF8StringEncoding];
+}
+
++ (nullable NSData *)xmlDataWithRootElement:(id<FBElement>)root
+                                    options:(nullable FBXMLGenerationOptions *)options
 {
   xmlDocPtr doc;
   xmlTextWriterPtr writer = xmlNewTextWriterDoc(&doc, 0);
@@ -178,7 +179,6 @@ static NSString *const topNodeIndexPath = @"top";
       rc = [self xmlRepresentationWithRootElement:[self snapshotWithRoot:root
                                                         useNative:FBConfiguration.includeHittableInPageSource]
                                            writer:writer
-                                     elementStore:nil
                                             query:nil
                               excludingAttributes:options.excludedAttributes];
     }
@@ -207,129 +207,200 @@ static NSString *const topNodeIndexPath = @"top";
   xmlDocDumpFormatMemory(doc, &xmlbuff, &buffersize, 1);
   xmlFreeTextWriter(writer);
   xmlFreeDoc(doc);
-  NSString *result = [NSString stringWithCString:(const char *)xmlbuff encoding:NSUTF8StringEncoding];
-  xmlFree(xmlbuff);
-  return result;
+  if (NULL == xmlbuff) {
+    [FBLogger log:@"Failed to invoke libxml2>xmlDocDumpFormatMemory"];
+    return nil;
+  }
+  return [[NSData alloc] initWithBytesNoCopy:xmlbuff
+                                      length:(NSUInteger)buffersize
+                                 deallocator:^(void *bytes, NSUInteger length) {
+    xmlFree(bytes);
+  }];
 }
 
 + (NSArray<id<FBXCElementSnapshot>> *)matchesWithRootElement:(id<FBElement>)root
                                                     forQuery:(NSString *)xpathQuery
 {
-  xmlDocPtr doc;
-
-  xmlTextWriterPtr writer = xmlNewTextWriterDoc(&doc, 0);
-  if (NULL == writer) {
-    [FBLogger logFmt:@"Failed to invoke libxml2>xmlNewTextWriterDoc for XPath query \"%@\"", xpathQuery];
-    return [self throwException:FBXPathQueryEvaluationException forQuery:xpathQuery];
+  FBXPathCompiledQuery *compiledQuery = [self compiledQueryWithQuery:xpathQuery];
+  if (nil == compiledQuery) {
+    return [self throwException:FBInvalidXPathException forQuery:xpathQuery];
   }
-  NSMutableDictionary *elementStore = [NSMutableDictionary dictionary];
-  int rc = xmlTextWriterStartDocument(writer, NULL, _UTF8Encoding, NULL);
-  id<FBXCElementSnapshot> lookupScopeSnapshot = nil;
-  id<FBXCElementSnapshot> contextRootSnapshot = nil;
-  BOOL useNativeSnapshot = nil == xpathQuery
-    ? NO
-    : [[self.class elementAttributesWithXPathQuery:xpathQuery] containsObject:FBHittableAttribute.class];
-  if (rc < 0) {
-    [FBLogger logFmt:@"Failed to invoke libxml2>xmlTextWriterStartDocument. Error code: %d", rc];
-  } else {
-    [self waitUntilStableWithElement:root];
-    if (FBConfiguration.limitXpathContextScope) {
-      lookupScopeSnapshot = [self snapshotWithRoot:root useNative:useNativeSnapshot];
-    } else {
-      if ([root isKindOfClass:XCUIElement.class]) {
-        lookupScopeSnapshot = [self snapshotWithRoot:[(XCUIElement *)root application]
-                                           useNative:useNativeSnapshot];
-        contextRootSnapshot = [root isKindOfClass:XCUIApplication.class]
-          ? nil
-          : ([(XCUIElement *)root lastSnapshot] ?: [self snapshotWithRoot:(XCUIElement *)root
-                                                                useNative:useNativeSnapshot]);
-      } else {
-        lookupScopeSnapshot = (id<FBXCElementSnapshot>)root;
-        contextRootSnapshot = nil == lookupScopeSnapshot.parent ? nil : (id<FBXCElementSnapshot>)root;
-        while (nil != lookupScopeSnapshot.parent) {
-          lookupScopeSnapshot = lookupScopeSnapshot.parent;
-        }
-      }
+  BOOL useNativeSnapshot = compiledQuery.useNativeSnapshot;
+  NSString *documentKey = [self documentCacheKeyWithRootElement:root
+                                                  compiledQuery:compiledQuery];
+  FBXPathDocument *document = nil == documentKey
+    ? nil
+    : [FBXPathDocumentCache.sharedCache documentForKey:documentKey];
+  BOOL isDocumentCached = nil != document;
+  if (!isDocumentCached) {
+    document = [self documentWithRootElement:root
+                               compiledQuery:compiledQuery
+                                   useNative:useNativeSnapshot];
+    if (nil == document) {
+      return [self throwException:FBXPathQueryEvaluationException forQuery:xpathQuery];
     }
-
-    rc = [self xmlRepresentationWithRootElement:lookupScopeSnapshot
-                                         writer:writer
-                                   elementStore:elementStore
-                                          query:xpathQuery
-                            excludingAttributes:nil];
-    if (rc >= 0) {
-      rc = xmlTextWriterEndDocument(writer);
-      if (rc < 0) {
-        [FBLogger logFmt:@"Failed to invoke libxml2>xmlTextWriterEndDocument. Error code: %d", rc];
-      }
+    if (nil != documentKey) {
+      [FBXPathDocumentCache.sharedCache setDocument:document forKey:documentKey];
     }
   }
-  if (rc < 0) {
-    xmlFreeTextWriter(writer);
-    xmlFreeDoc(doc);
-    return [self throwException:FBXPathQueryEvaluationException forQuery:xpathQuery];
-  }
 
-  xmlXPathObjectPtr contextNodeQueryResult = [self matchNodeInDocument:doc
-                                                          elementStore:elementStore.copy
-                                                           forSnapshot:contextRootSnapshot];
-  xmlNodePtr contextNode = NULL;
-  if (NULL != contextNodeQueryResult) {
-    xmlNodeSetPtr nodeSet = contextNodeQueryResult->nodesetval;
-    if (!xmlXPathNodeSetIsEmpty(nodeSet)) {
-      contextNode = nodeSet->nodeTab[0];
-    }
-  }
-  xmlXPathObjectPtr queryResult = [self evaluate:xpathQuery
-                                        document:doc
-                                     contextNode:contextNode];
-  if (NULL != contextNodeQueryResult) {
-    xmlXPathFreeObject(contextNodeQueryResult);
-  }
+  id<FBXCElementSnapshot> contextRootSnapshot = FBConfiguration.limitXpathContextScope
+    ? nil
+    : [self contextRootSnapshotWithRootElement:root useNative:useNativeSnapshot];
+  xmlNodePtr contextNode = [self matchNodeInDocument:document
+                                          forSnapshot:contextRootSnapshot];
+  xmlXPathObjectPtr queryResult = [self evaluateCompiledQuery:compiledQuery
+                                                     document:document.doc
+                                                  contextNode:contextNode];
   if (NULL == queryResult) {
-    xmlFreeTextWriter(writer);
-    xmlFreeDoc(doc);
     return [self throwException:FBInvalidXPathException forQuery:xpathQuery];
   }
 
-  NSArray *matchingSnapshots = [self collectMatchingSnapshots:queryResult->nodesetval
-                                                 elementStore:elementStore];
+  NSArray *matchingSnapshots = [self collectMatchingSnapshots:queryResult->nodesetval];
   xmlXPathFreeObject(queryResult);
-  xmlFreeTextWriter(writer);
-  xmlFreeDoc(doc);
   if (nil == matchingSnapshots) {
     return [self throwException:FBXPathQueryEvaluationException forQuery:xpathQuery];
   }
+  if (isDocumentCached && 0 == [matchingSnapshots count]) {
+    // The screen might have been changed without any action from our side,
+    // for example if the client waits for an element to appear. Only trust empty results
+    // if they are retrieved from a fresh document.
+    [FBXPathDocumentCache.sharedCache removeDocumentForKey:(NSString *)documentKey];
+    return [self matchesWithRootElement:root forQuery:xpathQuery];
+  }
   return matchingSnapshots;
 }
 
++ (nullable FBXPathDocument *)documentWithRootElement:(id<FBElement>)root
+                                        compiledQuery:(FBXPathCompiledQuery *)compiledQuery
+                                            useNative:(BOOL)useNativeSnapshot
+{
+  xmlDocPtr doc = xmlNewDoc((const xmlChar *)"1.0");
+  if (NULL == doc) {
+    [FBLogger log:@"Failed to invoke libxml2>xmlNewDoc"];
+    return nil;
+  }
+  // Tag and attribute names are repeated thousands of times in big trees,
+  // so make sure they are only allocated once per document
+  doc->dict = xmlDictCreate();
+  if (NULL == doc->dict) {
+    [FBLogger log:@"Failed to invoke libxml2>xmlDictCreate"];
+    xmlFreeDoc(doc);
+    return nil;
+  }
+
+  [self waitUntilStableWithElement:root];
+  id<FBXCElementSnapshot> lookupScopeSnapshot = [self lookupScopeSnapshotWithRootElement:root
+                                                                               useNative:useNativeSnapshot];
+  NSMutableArray<id<FBXCElementSnapshot>> *snapshotsStore = [NSMutableArray array];
+  // Context nodes are only resolved if the lookup scope is not limited to the root element itself
+  NSMutableDictionary<NSString *, NSValue *> *nodesIndex = FBConfiguration.limitXpathContextScope
+    ? nil
+    : [NSMutableDictionary dictionary];
+  int rc = [self xmlTreeWithRootElement:lookupScopeSnapshot
+                               document:doc
+                         snapshotsStore:snapshotsStore
+                             nodesIndex:nodesIndex
+                          compiledQuery:compiledQuery
+                    excludingAttributes:nil];
+  if (rc < 0) {
+    xmlFreeDoc(doc);
+    return nil;
+  }
+  return [[FBXPathDocument alloc] initWithDocument:doc
+                                         snapshots:snapshotsStore.copy
+                                        nodesByUid:nodesIndex.copy ?: @{}];
+}
+
++ (id<FBXCElementSnapshot>)lookupScopeSnapshotWithRootElement:(id<FBElement>)root
+                                                    useNative:(BOOL)useNativeSnapshot
+{
+  if (FBConfiguration.limitXpathContextScope) {
+    return [self snapshotWithRoot:root useNative:useNativeSnapshot];
+  }
+  if ([root isKindOfClass:XCUIElement.class]) {
+    return [self snapshotWithRoot:[(XCUIElement *)root application] useNative:useNativeSnapshot];
+  }
+  id<FBXCElementSnapshot> lookupScopeSnapshot = (id<FBXCElementSnapshot>)root;
+  while (nil != lookupScopeSnapshot.parent) {
+    lookupScopeSnapshot = lookupScopeSnapshot.parent;
+  }
+  return lookupScopeSnapshot;
+}
+
++ (nullable id<FBXCElementSnapshot>)contextRootSnapshotWithRootElement:(id<FBElement>)root
+                                                             useNative:(BOOL)useNativeSnapshot
+{
+  if ([root isKindOfClass:XCUIElement.class]) {
+    return [root isKindOfClass:XCUIApplication.class]
+      ? nil
+      : ([(XCUIElement *)root lastSnapshot] ?: [self snapshotWithRoot:(XCUIElement *)root
+                                                            useNative:useNativeSnapshot]);
+  }
+  return nil == [(id<FBXCElementSnapshot>)root parent] ? nil : (id<FBXCElementSnapshot>)root;
+}
+
++ (nullable NSString *)documentCacheKeyWithRootElement:(id<FBElement>)root
+                                         compiledQuery:(FBXPathCompiledQuery *)compiledQuery
+{
+  if (FBConfiguration.xpathDocumentCacheMaxAge <= 0) {
+    return nil;
+  }
+
+  // The document is only reusable if it has been built for the same lookup scope
+  // and contains the same set of attributes
+  BOOL limitXpathContextScope = FBConfiguration.limitXpathContextScope;
+  id<FBXCAccessibilityElement> scopeElement = nil;
+  if ([root isKindOfClass:XCUIApplication.class]) {
+    scopeElement = [(XCUIApplication *)root accessibilityElement];
+  } else if ([root isKindOfClass:XCUIElement.class]) {
+    scopeElement = limitXpathContextScope
+      ? [[(XCUIElement *)root lastSnapshot] accessibilityElement]
+      : [[(XCUIElement *)root application] accessibilityElement];
+  } else {
+    id<FBXCElementSnapshot> scopeSnapshot = (id<FBXCElementSnapshot>)root;
+    while (!limitXpathContextScope && nil != scopeSnapshot.parent) {
+      scopeSnapshot = scopeSnapshot.parent;
+    }
+    scopeElement = scopeSnapshot.accessibilityElement;
+  }
+  NSString *scopeUid = nil == scopeElement ? nil : [FBElementUtils uidWithAccessibilityElement:scopeElement];
+  if (nil == scopeUid) {
+    return nil;
+  }
+
+  NSMutableArray<NSString *> *attributeNames = [NSMutableArray array];
+  for (Class attributeCls in compiledQuery.attributes) {
+    [attributeNames addObject:[attributeCls name]];
+  }
+  [attributeNames sortUsingSelector:@selector(compare:)];
+  // The generation is captured before the document is built, so a document,
+  // which has been built while an invalidation happened, is never going to be looked up again
+  return [NSString stringWithFormat:@"%lu|%@|%@|%d|%d",
+          (unsigned long)FBXPathDocumentCache.sharedCache.generation, scopeUid,
+          [attributeNames componentsJoinedByString:@","], compiledQuery.useNativeSnapshot, limitXpathContextScope];
+}
+
 + (NSArray *)collectMatchingSnapshots:(xmlNodeSetPtr)nodeSet
-                         elementStore:(NSMutableDictionary *)elementStore
 {
   if (xmlXPathNodeSetIsEmpty(nodeSet)) {
     return @[];
   }
   NSMutableArray *matchingSnapshots = [NSMutableArray array];
-  const xmlChar *indexPathKeyName = (xmlChar *)[kXMLIndexPathKey UTF8String];
   for (NSInteger i = 0; i < nodeSet->nodeNr; i++) {
     xmlNodePtr currentNode = nodeSet->nodeTab[i];
-    xmlChar *attrValue = xmlGetProp(currentNode, indexPathKeyName);
-    if (NULL == attrValue) {
-      [FBLogger log:@"Failed to invoke libxml2>xmlGetProp"];
+    if (XML_ELEMENT_NODE != currentNode->type || NULL == currentNode->_private) {
+      [FBLogger logFmt:@"The matched XML node '%s' has no snapshot assigned", (const char *)currentNode->name];
       return nil;
     }
-    id<FBXCElementSnapshot> element = [elementStore objectForKey:(id)[NSString stringWithCString:(const char *)attrValue encoding:NSUTF8StringEncoding]];
-    if (element) {
-      [matchingSnapshots addObject:element];
-    }
-    xmlFree(attrValue);
+    // Nodes built by xmlTreeWithRootElement keep their snapshots
+    [matchingSnapshots addObject:(__bridge id<FBXCElementSnapshot>)currentNode->_private];
   }
   return matchingSnapshots.copy;
 }
 
-+ (nullable xmlXPathObjectPtr)matchNodeInDocument:(xmlDocPtr)doc
-                                     elementStore:(NSDictionary<NSString *, id<FBXCElementSnapshot>> *)elementStore
-                                      forSnapshot:(nullable id<FBXCElementSnapshot>)snapshot
++ (nullable xmlNodePtr)matchNodeInDocument:(FBXPathDocument *)document
+                               forSnapshot:(nullable id<FBXCElementSnapshot>)snapshot
 {
   if (nil == snapshot) {
     return NULL;
@@ -339,22 +410,7 @@ static NSString *const topNodeIndexPath = @"top";
   if (nil == contextRootUid) {
     return NULL;
   }
-
-  for (NSString *key in elementStore) {
-    id<FBXCElementSnapshot> value = [elementStore objectForKey:key];
-    NSString *snapshotUid = [FBElementUtils uidWithAccessibilityElement:[value accessibilityElement]];
-    if (nil == snapshotUid || ![snapshotUid isEqualToString:contextRootUid]) {
-      continue;
-    }
-    NSString *indexQuery = [NSString stringWithFormat:@"//*[@%@=\"%@\"]", kXMLIndexPathKey, key];
-    xmlXPathObjectPtr queryResult = [self evaluate:indexQuery
-                                          document:doc
-                                       contextNode:NULL];
-    if (NULL != queryResult) {
-      return queryResult;
-    }
-  }
-  return NULL;
+  return (xmlNodePtr)[[document.nodesByUid objectForKey:contextRootUid] pointerValue];
 }
 
 + (NSSet<Class> *)elementAttributesWithXPathQuery:(NSString *)query
@@ -372,16 +428,33 @@ static NSString *const topNodeIndexPath = @"top";
   return result.copy;
 }
 
-+ (int)xmlRepresentationWithRootElement:(id<FBXCElementSnapshot>)root
-                                 writer:(xmlTextWriterPtr)writer
-                           elementStore:(nullable NSMutableDictionary *)elementStore
-                                  query:(nullable NSString*)query
-                    excludingAttributes:(nullable NSArray<NSString *> *)excludedAttributes
++ (nullable FBXPathCompiledQuery *)compiledQueryWithQuery:(NSString *)xpathQuery
+{
+  FBXPathCompiledQuery *compiledQuery = [FBXPathQueryCache.sharedCache compiledQueryForQuery:xpathQuery];
+  if (nil != compiledQuery) {
+    return compiledQuery;
+  }
+
+  xmlXPathCompExprPtr expression = xmlXPathCompile((const xmlChar *)[xpathQuery UTF8String]);
+  if (NULL == expression) {
+    [FBLogger logFmt:@"Failed to invoke libxml2>xmlXPathCompile for XPath query \"%@\"", xpathQuery];
+    return nil;
+  }
+  NSSet<Class> *attributes = [self.class elementAttributesWithXPathQuery:xpathQuery];
+  compiledQuery = [[FBXPathCompiledQuery alloc] initWithExpression:expression
+                                                        attributes:attributes
+                                                 useNativeSnapshot:[attributes containsObject:FBHittableAttribute.class]];
+  [FBXPathQueryCache.sharedCache setCompiledQuery:compiledQuery forQuery:xpathQuery];
+  return compiledQuery;
+}
+
++ (NSSet<Class> *)includedAttributesWithQueryAttributes:(nullable NSSet<Class> *)queryAttributes
+                                    excludingAttributes:(nullable NSArray<NSString *> *)excludedAttributes
 {
   // Trying to be smart here and only including attributes, that were asked in the query, to the resulting document.
   // This may speed up the lookup significantly in some cases
   NSMutableSet<Class> *includedAttributes;
-  if (nil == query) {
+  if (nil == queryAttributes) {
     includedAttributes = [NSMutableSet setWithArray:FBElementAttribute.supportedAttributes];
     if (!FBConfiguration.includeHittableInPageSource) {
       // The hittable attribute is expensive to calculate for each snapshot item
@@ -408,14 +481,21 @@ static NSString *const topNodeIndexPath = @"top";
       }
     }
   } else {
-    includedAttributes = [self.class elementAttributesWithXPathQuery:query].mutableCopy;
+    includedAttributes = queryAttributes.mutableCopy;
   }
   [FBLogger logFmt:@"The following attributes were requested to be included into the XML: %@", includedAttributes];
+  return includedAttributes.copy;
+}
 
++ (int)xmlRepresentationWithRootElement:(id<FBXCElementSnapshot>)root
+                                 writer:(xmlTextWriterPtr)writer
+                                  query:(nullable NSString*)query
+                    excludingAttributes:(nullable NSArray<NSString *> *)excludedAttributes
+{
+  NSSet<Class> *queryAttributes = nil == query ? nil : [self elementAttributesWithXPathQuery:(NSString *)query];
   int rc = [self writeXmlWithRootElement:root
-                               indexPath:(elementStore != nil ? topNodeIndexPath : nil)
-                            elementStore:elementStore
-                      includedAttributes:includedAttributes.copy
+                      includedAttributes:[self includedAttributesWithQueryAttributes:queryAttributes
+                                                                 excludingAttributes:excludedAttributes]
                                   writer:writer];
   if (rc < 0) {
     [FBLogger log:@"Failed to generate XML presentation of a screen element"];
@@ -424,24 +504,47 @@ static NSString *const topNodeIndexPath = @"top";
   return 0;
 }
 
-+ (xmlXPathObjectPtr)evaluate:(NSString *)xpathQuery
++ (int)xmlTreeWithRootElement:(id<FBXCElementSnapshot>)root
                      document:(xmlDocPtr)doc
-                  contextNode:(nullable xmlNodePtr)contextNode
+               snapshotsStore:(NSMutableArray<id<FBXCElementSnapshot>> *)snapshotsStore
+                   nodesIndex:(nullable NSMutableDictionary<NSString *, NSValue *> *)nodesIndex
+                compiledQuery:(nullable FBXPathCompiledQuery *)compiledQuery
+          excludingAttributes:(nullable NSArray<NSString *> *)excludedAttributes
+{
+  xmlNodePtr rootNode = [self buildNodeWithSnapshot:root
+                                           document:doc
+                                     snapshotsStore:snapshotsStore
+                                         nodesIndex:nodesIndex
+                                 includedAttributes:[self includedAttributesWithQueryAttributes:compiledQuery.attributes
+                                                                            excludingAttributes:excludedAttributes]];
+  if (NULL == rootNode) {
+    [FBLogger log:@"Failed to generate XML presentation of a screen element"];
+    return -1;
+  }
+  xmlNodePtr previousRoot = xmlDocSetRootElement(doc, rootNode);
+  if (NULL != previousRoot) {
+    xmlFreeNode(previousRoot);
+  }
+  return 0;
+}
+
++ (xmlXPathObjectPtr)evaluateCompiledQuery:(FBXPathCompiledQuery *)compiledQuery
+                                   document:(xmlDocPtr)doc
+                                contextNode:(nullable xmlNodePtr)contextNode
 {
   xmlXPathContextPtr xpathCtx = xmlXPathNewContext(doc);
   if (NULL == xpathCtx) {
-    [FBLogger logFmt:@"Failed to invoke libxml2>xmlXPathNewContext for XPath query \"%@\"", xpathQuery];
+    [FBLogger log:@"Failed to invoke libxml2>xmlXPathNewContext"];
     return NULL;
   }
   xpathCtx->node = NULL == contextNode ? doc->children : contextNode;
 
-  xmlXPathObjectPtr xpathObj = xmlXPathEvalExpression((const xmlChar *)[xpathQuery UTF8String], xpathCtx);
+  xmlXPathObjectPtr xpathObj = xmlXPathCompiledEval(compiledQuery.expression, xpathCtx);
+  xmlXPathFreeContext(xpathCtx);
   if (NULL == xpathObj) {
-    xmlXPathFreeContext(xpathCtx);
-    [FBLogger logFmt:@"Failed to invoke libxml2>xmlXPathEvalExpression for XPath query \"%@\"", xpathQuery];
+    [FBLogger log:@"Failed to invoke libxml2>xmlXPathCompiledEval"];
     return NULL;
   }
-  xmlXPathFreeContext(xpathCtx);
   return xpathObj;
 }
 
@@ -450,11 +553,11 @@ static NSString *const topNodeIndexPath = @"top";
   return [str fb_xmlSafeStringWithReplacement:@""];
 }
 
-+ (int)recordElementAttributes:(xmlTextWriterPtr)writer
-                    forElement:(id<FBXCElementSnapshot>)element
-                     indexPath:(nullable NSString *)indexPath
-            includedAttributes:(nullable NSSet<Class> *)includedAttributes
++ (int)enumerateAttributesOfElement:(id<FBXCElementSnapshot>)element
+                 includedAttributes:(nullable NSSet<Class> *)includedAttributes
+                         usingBlock:(int (^)(Class attributeCls, NSString *value))block
 {
+  FBXCElementSnapshotWrapper *wrappedElement = [FBXCElementSnapshotWrapper ensureWrapped:element];
   for (Class attributeCls in FBElementAttribute.supportedAttributes) {
     // include all supported attributes by default unless enumerated explicitly
     if (includedAttributes && ![includedAttributes containsObject:attributeCls]) {
@@ -470,23 +573,17 @@ static NSString *const topNodeIndexPath = @"top";
         !FBDoesElementSupportMinMaxValue(element.elementType)) {
       continue;
     }
-    int rc = [attributeCls recordWithWriter:writer
-                                 forElement:[FBXCElementSnapshotWrapper ensureWrapped:element]];
+    int rc = block(attributeCls, [attributeCls valueForElement:wrappedElement]);
     if (rc < 0) {
       return rc;
     }
   }
 
-  if (nil != indexPath) {
-    // index path is the special case
-    return [FBInternalIndexAttribute recordWithWriter:writer forValue:indexPath];
-  }
   if (element.elementType == XCUIElementTypeApplication) {
     // only record process identifier and bundle identifier for the application element
     int pid = [element.accessibilityElement processIdentifier];
     if (pid > 0) {
-      int rc = [FBApplicationPidAttribute recordWithWriter:writer
-                                                  forValue:[NSString stringWithFormat:@"%d", pid]];
+      int rc = block(FBApplicationPidAttribute.class, [NSString stringWithFormat:@"%d", pid]);
       if (rc < 0) {
         return rc;
       }
@@ -494,8 +591,7 @@ static NSString *const topNodeIndexPath = @"top";
                               monitoredApplicationWithProcessIdentifier:pid];
       NSString *bundleID = [app bundleID];
       if (nil != bundleID) {
-        rc = [FBApplicationBundleIdAttribute recordWithWriter:writer
-                                                     forValue:bundleID];
+        rc = block(FBApplicationBundleIdAttribute.class, bundleID);
         if (rc < 0) {
           return rc;
         }
@@ -505,19 +601,75 @@ static NSString *const topNodeIndexPath = @"top";
   return 0;
 }
 
-+ (int)writeXmlWithRootElement:(id<FBXCElementSnapshot>)root
-                     indexPath:(nullable NSString *)indexPath
-                  elementStore:(nullable NSMutableDictionary *)elementStore
++ (int)recordElementAttributes:(xmlTextWriterPtr)writer
+                    forElement:(id<FBXCElementSnapshot>)element
             includedAttributes:(nullable NSSet<Class> *)includedAttributes
-                        writer:(xmlTextWriterPtr)writer
 {
-  NSAssert((indexPath == nil && elementStore == nil) || (indexPath != nil && elementStore != nil), @"Either both or none of indexPath and elementStore arguments should be equal to nil", nil);
+  return [self enumerateAttributesOfElement:element
+                         includedAttributes:includedAttributes
+                                 usingBlock:^int(Class attributeCls, NSString *value) {
+    return [attributeCls recordWithWriter:writer forValue:value];
+  }];
+}
 
-  NSArray<id<FBXCElementSnapshot>> *children = root.children;
++ (nullable xmlNodePtr)buildNodeWithSnapshot:(id<FBXCElementSnapshot>)snapshot
+                                    document:(xmlDocPtr)doc
+                              snapshotsStore:(NSMutableArray<id<FBXCElementSnapshot>> *)snapshotsStore
+                                  nodesIndex:(nullable NSMutableDictionary<NSString *, NSValue *> *)nodesIndex
+                          includedAttributes:(nullable NSSet<Class> *)includedAttributes
+{
+  FBXCElementSnapshotWrapper *wrappedSnapshot = [FBXCElementSnapshotWrapper ensureWrapped:snapshot];
+  // Tag names are interned in the document dictionary
+  xmlNodePtr node = xmlNewDocNode(doc, NULL, (xmlChar *)[wrappedSnapshot.wdType UTF8String], NULL);
+  if (NULL == node) {
+    [FBLogger logFmt:@"Failed to invoke libxml2>xmlNewDocNode for the tag value '%@'", wrappedSnapshot.wdType];
+    return NULL;
+  }
+  // The node does not retain its snapshot, so the store must outlive the document
+  [snapshotsStore addObject:snapshot];
+  node->_private = (__bridge void *)snapshot;
+  id<FBXCAccessibilityElement> accessibilityElement = snapshot.accessibilityElement;
+  if (nil != nodesIndex && nil != accessibilityElement) {
+    NSString *uid = [FBElementUtils uidWithAccessibilityElement:accessibilityElement];
+    // Keep the first node in document order if the same element is present more than once
+    if (nil != uid && nil == [nodesIndex objectForKey:uid]) {
+      [nodesIndex setObject:[NSValue valueWithPointer:node] forKey:uid];
+    }
+  }
+
+  int rc = [self enumerateAttributesOfElement:wrappedSnapshot
+                           includedAttributes:includedAttributes
+                                   usingBlock:^int(Class attributeCls, NSString *value) {
+    return [attributeCls recordWithNode:node forValue:value];
+  }];
+  if (rc < 0) {
+    xmlFreeNode(node);
+    return NULL;
+  }
 
-  if (elementStore != nil && indexPath != nil && [indexPath isEqualToString:topNodeIndexPath]) {
-    [elementStore setObject:root forKey:topNodeIndexPath];
+  NSArray<id<FBXCElementSnapshot>> *children = snapshot.children;
+  for (NSUInteger i = 0; i < [children count]; i++) {
+    @autoreleasepool {
+      xmlNodePtr childNode = [self buildNodeWithSnapshot:[children objectAtIndex:i]
+                                                document:doc
+                                          snapshotsStore:snapshotsStore
+                                              nodesIndex:nodesIndex
+                                      includedAttributes:includedAttributes];
+      if (NULL == childNode) {
+        xmlFreeNode(node);
+        return NULL;
+      }
+      xmlAddChild(node, childNode);
+    }
   }
+  return node;
+}
+
++ (int)writeXmlWithRootElement:(id<FBXCElementSnapshot>)root
+            includedAttributes:(nullable NSSet<Class> *)includedAttributes
+                        writer:(xmlTextWriterPtr)writer
+{
+  NSArray<id<FBXCElementSnapshot>> *children = root.children;
 
   FBXCElementSnapshotWrapper *wrappedSnapshot = [FBXCElementSnapshotWrapper ensureWrapped:root];
   int rc = xmlTextWriterStartElement(writer, (xmlChar *)[wrappedSnapshot.wdType UTF8String]);
@@ -528,7 +680,6 @@ static NSString *const topNodeIndexPath = @"top";
 
   rc = [self recordElementAttributes:writer
                           forElement:root
-                           indexPath:indexPath
                   includedAttributes:includedAttributes];
   if (rc < 0) {
     return rc;
@@ -537,13 +688,7 @@ static NSString *const topNodeIndexPath = @"top";
   for (NSUInteger i = 0; i < [children count]; i++) {
     @autoreleasepool {
       id<FBXCElementSnapshot> childSnapshot = [children objectAtIndex:i];
-      NSString *newIndexPath = (indexPath != nil) ? [indexPath stringByAppendingFormat:@",%lu", (unsigned long)i] : nil;
-      if (elementStore != nil && newIndexPath != nil) {
-        [elementStore setObject:childSnapshot forKey:(id)newIndexPath];
-      }
       rc = [self writeXmlWithRootElement:[FBXCElementSnapshotWrapper ensureWrapped:childSnapshot]
-                               indexPath:newIndexPath
-                            elementStore:elementStore
                       includedAttributes:includedAttributes
                                   writer:writer];
       if (rc < 0) {
@@ -633,6 +778,24 @@ static NSString *const FBAbstractMethodInvocationException = @"AbstractMethodInv
   return rc;
 }
 
++ (int)recordWithNode:(xmlNodePtr)node forValue:(nullable NSString *)value
+{
+  if (nil == value) {
+    // Skip the attribute if the value equals to nil
+    return 0;
+  }
+  // Attribute names are interned in the document dictionary
+  // and values are stored as is, without entities parsing
+  xmlAttrPtr attr = xmlNewProp(node,
+                               (xmlChar *)[[self name] UTF8String],
+                               (xmlChar *)[[FBXPath safeXmlStringWithString:value] UTF8String]);
+  if (NULL == attr) {
+    [FBLogger logFmt:@"Failed to invoke libxml2>xmlNewProp(%@='%@')", [self name], value];
+    return -1;
+  }
+  return 0;
+}
+
 + (NSArray<Class> *)supportedAttributes
 {
   // The list of attributes to be written for each XML node
@@ -858,15 +1021,6 @@ static NSString *const FBAbstractMethodInvocationException = @"AbstractMethodInv
 
 @end
 
-@implementation FBInternalIndexAttribute
-
-+ (NSString *)name
-{
-  return kXMLIndexPathKey;
-}
-
-@end
-
 @implementation FBApplicationBundleIdAttribute : FBElementAttribute
 
 + (NSString *)name
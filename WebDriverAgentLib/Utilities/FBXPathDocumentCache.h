@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <WebDriverAgentLib/FBXPath.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Immutable holder of a libxml2 document built from a snapshots tree.
+ The document is freed as soon as the holder is deallocated.
+ */
+@interface FBXPathDocument : NSObject
+
+/*! The actual libxml2 document */
+@property (nonatomic, readonly) xmlDocPtr doc;
+/*! Snapshots referenced by the `_private` field of document nodes */
+@property (nonatomic, readonly) NSArray<id<FBXCElementSnapshot>> *snapshots;
+/*! Mapping of element uids to document nodes wrapped into NSValue pointers */
+@property (nonatomic, readonly) NSDictionary<NSString *, NSValue *> *nodesByUid;
+/*! The timestamp when the document has been built */
+@property (nonatomic, readonly) NSDate *createdAt;
+
+/**
+ Wraps the given document. The ownership of the document is transferred to the created instance.
+
+ @param doc libxml2 document pointer
+ @param snapshots snapshots referenced by the document nodes. They are retained while the document exists
+ @param nodesByUid element uid -> document node mapping
+ */
+- (instancetype)initWithDocument:(xmlDocPtr)doc
+                       snapshots:(NSArray<id<FBXCElementSnapshot>> *)snapshots
+                      nodesByUid:(NSDictionary<NSString *, NSValue *> *)nodesByUid;
+
+@end
+
+/**
+ Keeps XML documents that were built for recent XPath lookups, so consecutive
+ lookups on the same unchanged screen do not need to snapshot and serialize it again.
+ The cache is only active if FBConfiguration.xpathDocumentCacheMaxAge is greater than zero.
+ */
+@interface FBXPathDocumentCache : NSObject
+
+/*! The count of invalidations happened so far. Bumped on every action, which might change the screen.
+ Document keys must include it, so documents built before an invalidation cannot be reused after it */
+@property (atomic, readonly) NSUInteger generation;
+
+/**
+ @return singleton instance
+ */
++ (instancetype)sharedCache;
+
+/**
+ Retrieves a document built for the given key if it has not expired yet
+
+ @param key Unique document key
+ @return Either the cached document or nil
+ */
+- (nullable FBXPathDocument *)documentForKey:(NSString *)key;
+
+/**
+ Stores the given document in the cache
+
+ @param document The document to store
+ @param key Unique document key
+ */
+- (void)setDocument:(FBXPathDocument *)document forKey:(NSString *)key;
+
+/**
+ Removes the document for the given key from the cache
+
+ @param key Unique document key
+ */
+- (void)removeDocumentForKey:(NSString *)key;
+
+/**
+ Drops all cached documents and bumps the generation number
+ */
+- (void)invalidate;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBXPathDocumentCache.h"
+
+#import "FBConfiguration.h"
+#import "LRUCache.h"
+
+// Different XPath queries might require different sets of attributes
+// to be present in the document, so keep a couple of variants at once
+static const NSUInteger XPATH_DOCUMENT_CACHE_SIZE = 4;
+
+@implementation FBXPathDocument
+
+- (instancetype)initWithDocument:(xmlDocPtr)doc
+                       snapshots:(NSArray<id<FBXCElementSnapshot>> *)snapshots
+                      nodesByUid:(NSDictionary<NSString *, NSValue *> *)nodesByUid
+{
+  if ((self = [super init])) {
+    _doc = doc;
+    _snapshots = snapshots;
+    _nodesByUid = nodesByUid;
+    _createdAt = [NSDate date];
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  if (NULL != _doc) {
+    xmlFreeDoc(_doc);
+    _doc = NULL;
+  }
+}
+
+@end
+
+@interface FBXPathDocumentCache ()
+@property (nonatomic) LRUCache *documents;
+@property (atomic, readwrite) NSUInteger generation;
+@end
+
+@implementation FBXPathDocumentCache
+
++ (instancetype)sharedCache
+{
+  static FBXPathDocumentCache *instance;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    instance = [[self alloc] init];
+  });
+  return instance;
+}
+
+- (instancetype)init
+{
+  if ((self = [super init])) {
+    _documents = [[LRUCache alloc] initWithCapacity:XPATH_DOCUMENT_CACHE_SIZE];
+    _generation = 0;
+  }
+  return self;
+}
+
+- (FBXPathDocument *)documentForKey:(NSString *)key
+{
+  NSTimeInterval maxAge = FBConfiguration.xpathDocumentCacheMaxAge;
+  if (maxAge <= 0) {
+    return nil;
+  }
+
+  @synchronized (self) {
+    FBXPathDocument *document = [self.documents objectForKey:key];
+    if (nil == document) {
+      return nil;
+    }
+    if (-[document.createdAt timeIntervalSinceNow] > maxAge) {
+      [self.documents removeObjectForKey:key];
+      return nil;
+    }
+    return document;
+  }
+}
+
+- (void)setDocument:(FBXPathDocument *)document forKey:(NSString *)key
+{
+  if (FBConfiguration.xpathDocumentCacheMaxAge <= 0) {
+    return;
+  }
+
+  @synchronized (self) {
+    [self.documents setObject:document forKey:key];
+  }
+}
+
+- (void)removeDocumentForKey:(NSString *)key
+{
+  @synchronized (self) {
+    [self.documents removeObjectForKey:key];
+  }
+}
+
+- (void)invalidate
+{
+  @synchronized (self) {
+    self.documents = [[LRUCache alloc] initWithCapacity:XPATH_DOCUMENT_CACHE_SIZE];
+    self.generation++;
+  }
+}
+
+@end
@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <WebDriverAgentLib/FBXPath.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Immutable holder of a compiled XPath expression and the details derived from its source query.
+ The expression is freed as soon as the holder is deallocated.
+ */
+@interface FBXPathCompiledQuery : NSObject
+
+/*! The compiled libxml2 expression */
+@property (nonatomic, readonly) xmlXPathCompExprPtr expression;
+/*! Element attribute classes, which are referenced by the query */
+@property (nonatomic, readonly) NSSet<Class> *attributes;
+/*! Whether the query requires native snapshots to be evaluated */
+@property (nonatomic, readonly) BOOL useNativeSnapshot;
+
+/**
+ Wraps the given expression. The ownership of the expression is transferred to the created instance.
+
+ @param expression libxml2 compiled expression pointer
+ @param attributes element attribute classes referenced by the query
+ @param useNativeSnapshot whether the query requires native snapshots
+ */
+- (instancetype)initWithExpression:(xmlXPathCompExprPtr)expression
+                        attributes:(NSSet<Class> *)attributes
+                 useNativeSnapshot:(BOOL)useNativeSnapshot;
+
+@end
+
+/**
+ Keeps compiled XPath expressions for recently used queries, so locators reused
+ many times do not need to be analyzed and compiled again.
+ */
+@interface FBXPathQueryCache : NSObject
+
+/*! The count of successful cache lookups */
+@property (atomic, readonly) NSUInteger hits;
+/*! The count of cache lookups, which did not find anything */
+@property (atomic, readonly) NSUInteger misses;
+
+/**
+ @return singleton instance
+ */
++ (instancetype)sharedCache;
+
+/**
+ Retrieves a compiled query for the given XPath query string
+
+ @param query XPath query string
+ @return Either the cached compiled query or nil
+ */
+- (nullable FBXPathCompiledQuery *)compiledQueryForQuery:(NSString *)query;
+
+/**
+ Stores the given compiled query in the cache
+
+ @param compiledQuery The compiled query to store
+ @param query XPath query string
+ */
+- (void)setCompiledQuery:(FBXPathCompiledQuery *)compiledQuery forQuery:(NSString *)query;
+
+/**
+ @return Dictionary containing the cache statistics
+ */
+- (NSDictionary<NSString *, id> *)statistics;
+
+@end
+
+NS_ASSUME_NONNULL_END
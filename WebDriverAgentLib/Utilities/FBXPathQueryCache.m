@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import "FBXPathQueryCache.h"
+
+#import "LRUCache.h"
+
+static const NSUInteger XPATH_QUERY_CACHE_SIZE = 256;
+
+@implementation FBXPathCompiledQuery
+
+- (instancetype)initWithExpression:(xmlXPathCompExprPtr)expression
+                        attributes:(NSSet<Class> *)attributes
+                 useNativeSnapshot:(BOOL)useNativeSnapshot
+{
+  if ((self = [super init])) {
+    _expression = expression;
+    _attributes = attributes;
+    _useNativeSnapshot = useNativeSnapshot;
+  }
+  return self;
+}
+
+- (void)dealloc
+{
+  if (NULL != _expression) {
+    xmlXPathFreeCompExpr(_expression);
+    _expression = NULL;
+  }
+}
+
+@end
+
+@interface FBXPathQueryCache ()
+@property (nonatomic, readonly) LRUCache *queries;
+@property (atomic, readwrite) NSUInteger hits;
+@property (atomic, readwrite) NSUInteger misses;
+@end
+
+@implementation FBXPathQueryCache
+
++ (instancetype)sharedCache
+{
+  static FBXPathQueryCache *instance;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    instance = [[self alloc] init];
+  });
+  return instance;
+}
+
+- (instancetype)init
+{
+  if ((self = [super init])) {
+    _queries = [[LRUCache alloc] initWithCapacity:XPATH_QUERY_CACHE_SIZE];
+    _hits = 0;
+    _misses = 0;
+  }
+  return self;
+}
+
+- (FBXPathCompiledQuery *)compiledQueryForQuery:(NSString *)query
+{
+  @synchronized (self) {
+    FBXPathCompiledQuery *compiledQuery = [self.queries objectForKey:query];
+    if (nil == compiledQuery) {
+      self.misses++;
+    } else {
+      self.hits++;
+    }
+    return compiledQuery;
+  }
+}
+
+- (void)setCompiledQuery:(FBXPathCompiledQuery *)compiledQuery forQuery:(NSString *)query
+{
+  @synchronized (self) {
+    [self.queries setObject:compiledQuery forKey:query];
+  }
+}
+
+- (NSDictionary<NSString *, id> *)statistics
+{
+  @synchronized (self) {
+    return @{
+      @"capacity": @(self.queries.capacity),
+      @"count": @(self.queries.allObjects.count),
+      @"hits": @(self.hits),
+      @"misses": @(self.misses),
+    };
+  }
+}
+
+@end
@@ -18,10 +18,23 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ Thread-safe cache, which keeps at most `capacity` objects and drops
+ the least recently used ones first. All entries are preallocated in a single
+ contiguous array and linked with each other by their indexes.
+ */
 @interface LRUCache : NSObject
 
 /*! Maximum cache capacity. Could only be set in the constructor */
 @property (nonatomic, readonly) NSUInteger capacity;
+/*! The maximum total cost of objects the cache could hold. Zero (the default value) means no limit */
+@property (atomic) NSUInteger totalCostLimit;
+/*! The actual count of objects in the cache */
+@property (nonatomic, readonly) NSUInteger count;
+/*! The actual total cost of objects in the cache */
+@property (nonatomic, readonly) NSUInteger totalCost;
+/*! The count of objects evicted so far because of capacity or total cost limits */
+@property (nonatomic, readonly) NSUInteger evictionsCount;
 
 /**
  Constructs a new LRU cache instance with the given capacity
@@ -38,6 +51,17 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)setObject:(id)object forKey:(id<NSCopying>)key;
 
+/**
+ Puts a new object with the given cost into the cache. The least recently used objects
+ are evicted until the total cost fits into `totalCostLimit`. The most recent object
+ is always kept though, even if its own cost exceeds the limit.
+
+ @param object Object to put
+ @param key Object's key
+ @param cost Object's cost, for example its estimated size in bytes
+ */
+- (void)setObject:(id)object forKey:(id<NSCopying>)key cost:(NSUInteger)cost;
+
 /**
  Retrieves an object from the cache. Every time this method is called the matched
  object is bumped in the cache (if exists)
@@ -47,6 +71,14 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable id)objectForKey:(id<NSCopying>)key;
 
+/**
+ Checks whether an object with the given key is present in the cache. No bump is performed
+
+ @param key Object's key
+ @returns YES if the object exists
+ */
+- (BOOL)containsObjectForKey:(id<NSCopying>)key;
+
 /**
  Retrieves all values from the cache ORDERED by recent bump. No bump is performed
 
@@ -61,6 +93,14 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)removeObjectForKey:(id<NSCopying>)key;
 
+/**
+ Removes all objects, which have not been put or retrieved within the given time interval.
+
+ @param interval The time interval in float seconds
+ @returns The count of removed objects
+ */
+- (NSUInteger)removeObjectsNotAccessedWithin:(NSTimeInterval)interval;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -15,132 +15,332 @@
  */
 
 #import "LRUCache.h"
-#import "LRUCacheNode.h"
 
-@interface LRUCache ()
-@property (nonatomic) NSMutableDictionary *store;
-@property (nonatomic, nullable) LRUCacheNode *headNode;
-@property (nonatomic, nullable) LRUCacheNode *tailNode;
-@end
+#import <os/lock.h>
+#import <time.h>
+
+static const NSInteger LRUCacheNoIndex = -1;
+
+typedef struct {
+  // Both key and value are retained while the entry is in use
+  void *key;
+  void *value;
+  // The key hash is only calculated once on insertion
+  NSUInteger hash;
+  NSUInteger cost;
+  // Monotonic timestamp of the recent bump in nanoseconds
+  uint64_t accessedAt;
+  // Neighbours in the usage list (or the next free entry for unused ones)
+  NSInteger prev;
+  NSInteger next;
+  // The next entry in the same hash bucket
+  NSInteger chain;
+} LRUCacheEntry;
+
+// Keys and values of evicted entries are only released after the lock is dropped, because
+// their deallocation might take a while. Mass evictions are processed in batches of this size
+#define LRU_CACHE_RELEASED_REFS_COUNT 16
+
+typedef struct {
+  void *refs[LRU_CACHE_RELEASED_REFS_COUNT];
+  NSUInteger count;
+} LRUCacheReleasedRefs;
+
+static BOOL LRUCacheCanEvictEntry(const LRUCacheReleasedRefs *releasedRefs)
+{
+  return releasedRefs->count + 2 <= LRU_CACHE_RELEASED_REFS_COUNT;
+}
+
+static void LRUCacheReleaseRefs(LRUCacheReleasedRefs *releasedRefs)
+{
+  for (NSUInteger i = 0; i < releasedRefs->count; i++) {
+    CFRelease(releasedRefs->refs[i]);
+  }
+  releasedRefs->count = 0;
+}
 
 @implementation LRUCache
+{
+  LRUCacheEntry *_entries;
+  NSInteger *_buckets;
+  NSUInteger _bucketsMask;
+  NSInteger _headIndex;
+  NSInteger _tailIndex;
+  NSInteger _freeIndex;
+  NSUInteger _count;
+  NSUInteger _totalCost;
+  NSUInteger _evictionsCount;
+  os_unfair_lock _lock;
+}
 
 - (instancetype)initWithCapacity:(NSUInteger)capacity
 {
   if ((self = [super init])) {
-    _store = [NSMutableDictionary dictionary];
     _capacity = capacity;
+    NSUInteger entriesCount = MAX(capacity, 1);
+    _entries = calloc(entriesCount, sizeof(LRUCacheEntry));
+    for (NSUInteger i = 0; i < entriesCount; i++) {
+      _entries[i].next = i + 1 < entriesCount ? (NSInteger)(i + 1) : LRUCacheNoIndex;
+    }
+    // Keep the load factor below 0.5 to make collision chains short
+    NSUInteger bucketsCount = 2;
+    while (bucketsCount < entriesCount * 2) {
+      bucketsCount <<= 1;
+    }
+    _buckets = malloc(bucketsCount * sizeof(NSInteger));
+    for (NSUInteger i = 0; i < bucketsCount; i++) {
+      _buckets[i] = LRUCacheNoIndex;
+    }
+    _bucketsMask = bucketsCount - 1;
+    _headIndex = LRUCacheNoIndex;
+    _tailIndex = LRUCacheNoIndex;
+    _freeIndex = 0;
+    _lock = OS_UNFAIR_LOCK_INIT;
   }
   return self;
 }
 
+- (void)dealloc
+{
+  for (NSInteger index = _headIndex; index != LRUCacheNoIndex; index = _entries[index].next) {
+    CFRelease(_entries[index].key);
+    CFRelease(_entries[index].value);
+  }
+  free(_entries);
+  free(_buckets);
+}
+
 - (void)setObject:(id)object forKey:(id<NSCopying>)key
 {
-  NSAssert(nil != object && nil != key, @"LRUCache cannot store nil objects");
+  [self setObject:object forKey:key cost:0];
+}
 
-  LRUCacheNode *previousNode = self.store[key];
-  if (nil != previousNode) {
-    [self removeNode:previousNode];
+- (void)setObject:(id)object forKey:(id<NSCopying>)key cost:(NSUInteger)cost
+{
+  NSAssert(nil != object && nil != key, @"LRUCache cannot store nil objects");
+  if (0 == self.capacity) {
+    return;
   }
 
-  LRUCacheNode *newNode = [LRUCacheNode nodeWithValue:object key:key];
-  self.store[key] = newNode;
-  [self addNodeToHead:newNode];
-  if (nil == previousNode) {
-    [self alignSize];
+  NSUInteger hash = [(id)key hash];
+  NSUInteger totalCostLimit = self.totalCostLimit;
+  LRUCacheReleasedRefs releasedRefs = {.count = 0};
+  os_unfair_lock_lock(&_lock);
+  NSInteger index = [self indexOfKey:key hash:hash];
+  if (LRUCacheNoIndex != index) {
+    releasedRefs.refs[releasedRefs.count++] = _entries[index].value;
+    _entries[index].value = (void *)CFBridgingRetain(object);
+    _totalCost = _totalCost - _entries[index].cost + cost;
+    _entries[index].cost = cost;
+    [self moveEntryToHead:index];
+  } else {
+    if (LRUCacheNoIndex == _freeIndex) {
+      // The cache is full, so the least recently used entry gets reused
+      [self evictEntry:_tailIndex releasedRefs:&releasedRefs];
+      _evictionsCount++;
+    }
+    index = _freeIndex;
+    _freeIndex = _entries[index].next;
+    _entries[index].key = (void *)CFBridgingRetain([(id)key copyWithZone:nil]);
+    _entries[index].value = (void *)CFBridgingRetain(object);
+    _entries[index].hash = hash;
+    _entries[index].cost = cost;
+    NSUInteger bucket = hash & _bucketsMask;
+    _entries[index].chain = _buckets[bucket];
+    _buckets[bucket] = index;
+    [self addEntryToHead:index];
+    _count++;
+    _totalCost += cost;
+  }
+  while (totalCostLimit > 0 && _totalCost > totalCostLimit && _tailIndex != _headIndex) {
+    if (!LRUCacheCanEvictEntry(&releasedRefs)) {
+      [self flushReleasedRefs:&releasedRefs];
+      continue;
+    }
+    [self evictEntry:_tailIndex releasedRefs:&releasedRefs];
+    _evictionsCount++;
   }
+  os_unfair_lock_unlock(&_lock);
+  LRUCacheReleaseRefs(&releasedRefs);
 }
 
 - (id)objectForKey:(id<NSCopying>)key
 {
-  LRUCacheNode *node = self.store[key];
-  return [self moveNodeToHead:node].value;
+  NSUInteger hash = [(id)key hash];
+  id result = nil;
+  os_unfair_lock_lock(&_lock);
+  NSInteger index = [self indexOfKey:key hash:hash];
+  if (LRUCacheNoIndex != index) {
+    [self moveEntryToHead:index];
+    result = (__bridge id)_entries[index].value;
+  }
+  os_unfair_lock_unlock(&_lock);
+  return result;
+}
+
+- (BOOL)containsObjectForKey:(id<NSCopying>)key
+{
+  NSUInteger hash = [(id)key hash];
+  os_unfair_lock_lock(&_lock);
+  BOOL result = LRUCacheNoIndex != [self indexOfKey:key hash:hash];
+  os_unfair_lock_unlock(&_lock);
+  return result;
 }
 
 - (NSArray *)allObjects
 {
-  NSMutableArray *result = [[NSMutableArray alloc] initWithCapacity:self.store.count];
-  LRUCacheNode *node = self.headNode;
-  while (node != nil) {
-    [result addObject:node.value];
-    node = node.next;
+  os_unfair_lock_lock(&_lock);
+  NSMutableArray *result = [[NSMutableArray alloc] initWithCapacity:_count];
+  for (NSInteger index = _headIndex; index != LRUCacheNoIndex; index = _entries[index].next) {
+    [result addObject:(__bridge id)_entries[index].value];
   }
+  os_unfair_lock_unlock(&_lock);
   return result.copy;
 }
 
-- (nullable LRUCacheNode *)moveNodeToHead:(nullable LRUCacheNode *)node
+- (void)removeObjectForKey:(id<NSCopying>)key
 {
-  if (nil == node || node == self.headNode) {
-    return node;
+  NSUInteger hash = [(id)key hash];
+  LRUCacheReleasedRefs releasedRefs = {.count = 0};
+  os_unfair_lock_lock(&_lock);
+  NSInteger index = [self indexOfKey:key hash:hash];
+  if (LRUCacheNoIndex != index) {
+    [self evictEntry:index releasedRefs:&releasedRefs];
   }
+  os_unfair_lock_unlock(&_lock);
+  LRUCacheReleaseRefs(&releasedRefs);
+}
 
-  LRUCacheNode *previousNode = node.prev;
-  if (nil != previousNode) {
-    previousNode.next = node.next;
-  }
-  LRUCacheNode *nextNode = node.next;
-  if (nil != nextNode) {
-    nextNode.prev = node.prev;
-  }
-  if (node == self.tailNode) {
-    self.tailNode = previousNode;
+- (NSUInteger)removeObjectsNotAccessedWithin:(NSTimeInterval)interval
+{
+  uint64_t now = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  uint64_t intervalNs = (uint64_t)(MAX(interval, 0) * NSEC_PER_SEC);
+  uint64_t threshold = now > intervalNs ? now - intervalNs : 0;
+  NSUInteger removedCount = 0;
+  LRUCacheReleasedRefs releasedRefs = {.count = 0};
+  os_unfair_lock_lock(&_lock);
+  // The usage list is ordered by access time, so the stale entries are always at the tail
+  while (LRUCacheNoIndex != _tailIndex && _entries[_tailIndex].accessedAt < threshold) {
+    if (!LRUCacheCanEvictEntry(&releasedRefs)) {
+      [self flushReleasedRefs:&releasedRefs];
+      continue;
+    }
+    [self evictEntry:_tailIndex releasedRefs:&releasedRefs];
+    removedCount++;
   }
-  return [self addNodeToHead:node];
+  os_unfair_lock_unlock(&_lock);
+  LRUCacheReleaseRefs(&releasedRefs);
+  return removedCount;
 }
 
-- (void)removeNode:(nullable LRUCacheNode *)node
+- (NSUInteger)count
 {
-  if (nil == node) {
-    return;
-  }
+  os_unfair_lock_lock(&_lock);
+  NSUInteger result = _count;
+  os_unfair_lock_unlock(&_lock);
+  return result;
+}
 
-  if (nil != node.next) {
-    node.next.prev = node.prev;
-  }
-  if (node == self.headNode) {
-    self.headNode = node.next;
-  }
-  if (nil != node.prev) {
-    node.prev.next = node.next;
-  }
-  if (node == self.tailNode) {
-    self.tailNode = node.prev;
+- (NSUInteger)totalCost
+{
+  os_unfair_lock_lock(&_lock);
+  NSUInteger result = _totalCost;
+  os_unfair_lock_unlock(&_lock);
+  return result;
+}
+
+- (NSUInteger)evictionsCount
+{
+  os_unfair_lock_lock(&_lock);
+  NSUInteger result = _evictionsCount;
+  os_unfair_lock_unlock(&_lock);
+  return result;
+}
+
+#pragma mark - Entries management. The lock must be held by the caller
+
+- (NSInteger)indexOfKey:(id<NSCopying>)key hash:(NSUInteger)hash
+{
+  for (NSInteger index = _buckets[hash & _bucketsMask]; index != LRUCacheNoIndex; index = _entries[index].chain) {
+    if (_entries[index].hash == hash && [(__bridge id)_entries[index].key isEqual:key]) {
+      return index;
+    }
   }
-  [self.store removeObjectForKey:(id)node.key];
+  return LRUCacheNoIndex;
 }
 
-- (nullable LRUCacheNode *)addNodeToHead:(nullable LRUCacheNode *)node
+- (void)addEntryToHead:(NSInteger)index
 {
-  if (nil == node || node == self.headNode) {
-    return node;
+  _entries[index].accessedAt = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+  _entries[index].prev = LRUCacheNoIndex;
+  _entries[index].next = _headIndex;
+  if (LRUCacheNoIndex != _headIndex) {
+    _entries[_headIndex].prev = index;
   }
+  _headIndex = index;
+  if (LRUCacheNoIndex == _tailIndex) {
+    _tailIndex = index;
+  }
+}
 
-  LRUCacheNode *previousHead = self.headNode;
-  if (nil != previousHead) {
-    previousHead.prev = node;
+- (void)unlinkEntry:(NSInteger)index
+{
+  NSInteger prevIndex = _entries[index].prev;
+  NSInteger nextIndex = _entries[index].next;
+  if (LRUCacheNoIndex == prevIndex) {
+    _headIndex = nextIndex;
+  } else {
+    _entries[prevIndex].next = nextIndex;
   }
-  node.next = previousHead;
-  node.prev = nil;
-  self.headNode = node;
-  if (nil == self.tailNode) {
-    self.tailNode = previousHead ?: node;
+  if (LRUCacheNoIndex == nextIndex) {
+    _tailIndex = prevIndex;
+  } else {
+    _entries[nextIndex].prev = prevIndex;
   }
-  return node;
 }
 
-- (void)alignSize
+- (void)moveEntryToHead:(NSInteger)index
 {
-  if (self.store.count > self.capacity && nil != self.tailNode) {
-    [self removeNode:self.tailNode];
+  if (index == _headIndex) {
+    _entries[index].accessedAt = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    return;
   }
+  [self unlinkEntry:index];
+  [self addEntryToHead:index];
 }
 
-- (void)removeObjectForKey:(id<NSCopying>)key
+/**
+ Releases the collected keys and values without holding the lock, so the caller could continue evictions
+ */
+- (void)flushReleasedRefs:(LRUCacheReleasedRefs *)releasedRefs
+{
+  os_unfair_lock_unlock(&_lock);
+  LRUCacheReleaseRefs(releasedRefs);
+  os_unfair_lock_lock(&_lock);
+}
+
+/**
+ Detaches the entry from both the usage list and its hash bucket and returns it to the free list.
+ The ownership of the entry's key and value is transferred to the given refs, which must have room for both
+ */
+- (void)evictEntry:(NSInteger)index releasedRefs:(LRUCacheReleasedRefs *)releasedRefs
 {
-  LRUCacheNode *node = self.store[key];
-  if (node != nil) {
-    [self removeNode:node];
+  [self unlinkEntry:index];
+  NSInteger *link = &_buckets[_entries[index].hash & _bucketsMask];
+  while (*link != index) {
+    link = &_entries[*link].chain;
   }
+  *link = _entries[index].chain;
+  NSAssert(LRUCacheCanEvictEntry(releasedRefs), @"No room left for the released entry");
+  releasedRefs->refs[releasedRefs->count++] = _entries[index].key;
+  releasedRefs->refs[releasedRefs->count++] = _entries[index].value;
+  _entries[index].key = NULL;
+  _entries[index].value = NULL;
+  _count--;
+  _totalCost -= _entries[index].cost;
+  _entries[index].cost = 0;
+  _entries[index].next = _freeIndex;
+  _freeIndex = index;
 }
 
 @end
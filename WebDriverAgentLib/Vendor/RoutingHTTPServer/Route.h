@@ -14,5 +14,8 @@
 
 @property (nonatomic, assign) SEL selector;
 @property (nonatomic) NSArray *keys;
+// Path pattern split by slashes. Only set for patterns consisting of literal
+// and whole-segment :parameter items, which can be matched without the regex
+@property (nonatomic) NSArray<NSString *> *segments;
 
 @end
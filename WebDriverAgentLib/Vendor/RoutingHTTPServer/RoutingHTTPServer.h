@@ -15,6 +15,8 @@ FOUNDATION_EXPORT const unsigned char RoutingHTTPServerVersionString[];
 
 #import "GCDAsyncSocket.h"
 
+@class Route;
+
 typedef void (^RequestHandler)(RouteRequest *request, RouteResponse *response);
 
 @interface RoutingHTTPServer : HTTPServer
@@ -46,10 +48,15 @@ typedef void (^RequestHandler)(RouteRequest *request, RouteResponse *response);
 - (void)put:(NSString *)path withBlock:(RequestHandler)block;
 - (void)delete:(NSString *)path withBlock:(RequestHandler)block;
 
-- (void)handleMethod:(NSString *)method withPath:(NSString *)path block:(RequestHandler)block;
-- (void)handleMethod:(NSString *)method withPath:(NSString *)path target:(id)target selector:(SEL)selector;
+- (Route *)handleMethod:(NSString *)method withPath:(NSString *)path block:(RequestHandler)block;
+- (Route *)handleMethod:(NSString *)method withPath:(NSString *)path target:(id)target selector:(SEL)selector;
 
 - (BOOL)supportsMethod:(NSString *)method;
 - (RouteResponse *)routeMethod:(NSString *)method withPath:(NSString *)path parameters:(NSDictionary *)params request:(HTTPMessage *)request connection:(HTTPConnection *)connection;
 
+// Returns the route, which would handle the given request, without invoking it
+// or nil if there is no such route. Path parameters of the matched route are
+// merged into the given parameters.
+- (Route *)routeForMethod:(NSString *)method withPath:(NSString *)path parameters:(NSDictionary **)params;
+
 @end
@@ -5,8 +5,76 @@
 #pragma clang diagnostic ignored "-Wdirect-ivar-access"
 #pragma clang diagnostic ignored "-Widiomatic-parentheses"
 
+// A node of the path segments trie. Literal segments are stored lowercased,
+// since route patterns are matched case-insensitively
+@interface RouteTrieNode : NSObject
+
+@property (nonatomic, readonly) NSMutableDictionary<NSString *, RouteTrieNode *> *children;
+@property (nonatomic) RouteTrieNode *paramChild;
+// The lowest index of a route ending at this node in the list of method routes
+@property (nonatomic) NSUInteger routeIndex;
+
+@end
+
+@implementation RouteTrieNode
+
+- (id)init {
+  if (self = [super init]) {
+    _children = [[NSMutableDictionary alloc] init];
+    _routeIndex = NSNotFound;
+  }
+  return self;
+}
+
+- (void)insertSegments:(NSArray<NSString *> *)segments routeIndex:(NSUInteger)index {
+  RouteTrieNode *node = self;
+  for (NSString *segment in segments) {
+    RouteTrieNode *next;
+    if ([segment hasPrefix:@":"]) {
+      if (node.paramChild == nil) {
+        node.paramChild = [[RouteTrieNode alloc] init];
+      }
+      next = node.paramChild;
+    } else {
+      NSString *key = [segment lowercaseString];
+      next = [node.children objectForKey:key];
+      if (next == nil) {
+        next = [[RouteTrieNode alloc] init];
+        [node.children setObject:next forKey:key];
+      }
+    }
+    node = next;
+  }
+  if (node.routeIndex == NSNotFound) {
+    node.routeIndex = index;
+  }
+}
+
+- (NSUInteger)routeIndexForSegments:(NSArray<NSString *> *)segments fromPosition:(NSUInteger)position {
+  if (position == [segments count]) {
+    return self.routeIndex;
+  }
+  // Both branches must be checked, since the earliest registered route wins
+  NSString *segment = [segments objectAtIndex:position];
+  NSUInteger result = NSNotFound;
+  RouteTrieNode *literalChild = [self.children objectForKey:[segment lowercaseString]];
+  if (literalChild != nil) {
+    result = [literalChild routeIndexForSegments:segments fromPosition:position + 1];
+  }
+  if (self.paramChild != nil && [segment length] > 0) {
+    result = MIN(result, [self.paramChild routeIndexForSegments:segments fromPosition:position + 1]);
+  }
+  return result;
+}
+
+@end
+
 @implementation RoutingHTTPServer {
   NSMutableDictionary *routes;
+  // Method -> RouteTrieNode
+  NSMutableDictionary *routeTries;
+  // Method -> indexes of routes that can only be matched by their regex
+  NSMutableDictionary *regexRouteIndexes;
   NSMutableDictionary *defaultHeaders;
   NSMutableDictionary *mimeTypes;
   dispatch_queue_t routeQueue;
@@ -18,6 +86,8 @@
   if (self = [super init]) {
     connectionClass = [RoutingConnection self];
     routes = [[NSMutableDictionary alloc] init];
+    routeTries = [[NSMutableDictionary alloc] init];
+    regexRouteIndexes = [[NSMutableDictionary alloc] init];
     defaultHeaders = [[NSMutableDictionary alloc] init];
     [self setupMIMETypes];
   }
@@ -102,24 +172,26 @@
   [self handleMethod:@"DELETE" withPath:path block:block];
 }
 
-- (void)handleMethod:(NSString *)method
-            withPath:(NSString *)path
-               block:(RequestHandler)block {
+- (Route *)handleMethod:(NSString *)method
+               withPath:(NSString *)path
+                  block:(RequestHandler)block {
   Route *route = [self routeWithPath:path];
   route.handler = block;
   
   [self addRoute:route forMethod:method];
+  return route;
 }
 
-- (void)handleMethod:(NSString *)method
-            withPath:(NSString *)path
-              target:(id)target
-            selector:(SEL)selector {
+- (Route *)handleMethod:(NSString *)method
+               withPath:(NSString *)path
+                 target:(id)target
+               selector:(SEL)selector {
   Route *route = [self routeWithPath:path];
   route.target = target;
   route.selector = selector;
   
   [self addRoute:route forMethod:method];
+  return route;
 }
 
 - (void)addRoute:(Route *)route forMethod:(NSString *)method {
@@ -131,6 +203,22 @@
   }
   
   [methodRoutes addObject:route];
+  NSUInteger routeIndex = [methodRoutes count] - 1;
+  if (route.segments) {
+    RouteTrieNode *trie = [routeTries objectForKey:method];
+    if (trie == nil) {
+      trie = [[RouteTrieNode alloc] init];
+      [routeTries setObject:trie forKey:method];
+    }
+    [trie insertSegments:route.segments routeIndex:routeIndex];
+  } else {
+    NSMutableArray *indexes = [regexRouteIndexes objectForKey:method];
+    if (indexes == nil) {
+      indexes = [NSMutableArray array];
+      [regexRouteIndexes setObject:indexes forKey:method];
+    }
+    [indexes addObject:@(routeIndex)];
+  }
   
   // Define a HEAD route for all GET routes
   if ([method isEqualToString:@"GET"]) {
@@ -138,9 +226,35 @@
   }
 }
 
+// Returns the path pattern segments if the pattern can be matched by the trie
+- (NSArray<NSString *> *)trieSegmentsWithPath:(NSString *)path {
+  static NSRegularExpression *paramRegex;
+  static NSCharacterSet *specialChars;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    paramRegex = [NSRegularExpression regularExpressionWithPattern:@"^:\\w+$" options:0 error:nil];
+    specialChars = [NSCharacterSet characterSetWithCharactersInString:@"*:?[]{}^$|\\"];
+  });
+  
+  if ([path length] > 2 && [path characterAtIndex:0] == '{') {
+    return nil;
+  }
+  NSArray<NSString *> *segments = [path componentsSeparatedByString:@"/"];
+  for (NSString *segment in segments) {
+    if ([segment rangeOfCharacterFromSet:specialChars].location == NSNotFound) {
+      continue;
+    }
+    if (![paramRegex firstMatchInString:segment options:0 range:NSMakeRange(0, segment.length)]) {
+      return nil;
+    }
+  }
+  return segments;
+}
+
 - (Route *)routeWithPath:(NSString *)path {
   Route *route = [[Route alloc] init];
   NSMutableArray *keys = [NSMutableArray array];
+  route.segments = [self trieSegmentsWithPath:path];
   
   if ([path length] > 2 && [path characterAtIndex:0] == '{') {
     // This is a custom regular expression, just remove the {}
@@ -214,70 +328,119 @@
                     parameters:(NSDictionary *)params
                        request:(HTTPMessage *)httpMessage
                     connection:(HTTPConnection *)connection {
+  Route *route = [self routeForMethod:method withPath:path parameters:&params];
+  if (route == nil)
+    return nil;
+  
+  return [self respondWithRoute:route parameters:params request:httpMessage connection:connection];
+}
+
+- (Route *)routeForMethod:(NSString *)method
+                 withPath:(NSString *)path
+               parameters:(NSDictionary **)paramsPtr {
+  NSDictionary *params = *paramsPtr;
   NSMutableArray *methodRoutes = [routes objectForKey:method];
   if (methodRoutes == nil)
     return nil;
   
-  for (Route *route in methodRoutes) {
+  NSArray<NSString *> *pathSegments = [path componentsSeparatedByString:@"/"];
+  RouteTrieNode *trie = [routeTries objectForKey:method];
+  NSUInteger trieRouteIndex = trie == nil ? NSNotFound : [trie routeIndexForSegments:pathSegments fromPosition:0];
+  
+  // Routes which cannot be represented by the trie are only checked if they have been registered
+  // before the route matched by the trie
+  for (NSNumber *regexRouteIndex in [regexRouteIndexes objectForKey:method]) {
+    NSUInteger routeIndex = [regexRouteIndex unsignedIntegerValue];
+    if (routeIndex > trieRouteIndex)
+      break;
+    
+    Route *route = [methodRoutes objectAtIndex:routeIndex];
     NSTextCheckingResult *result = [route.regex firstMatchInString:path options:0 range:NSMakeRange(0, path.length)];
     if (!result)
       continue;
     
-    // The first range is all of the text matched by the regex.
-    NSUInteger captureCount = [result numberOfRanges];
-    
-    if (route.keys) {
-      // Add the route's parameters to the parameter dictionary, accounting for
-      // the first range containing the matched text.
-      if (captureCount == [route.keys count] + 1) {
-        NSMutableDictionary *newParams = [params mutableCopy];
-        NSUInteger index = 1;
-        BOOL firstWildcard = YES;
-        for (NSString *key in route.keys) {
-          NSString *capture = [path substringWithRange:[result rangeAtIndex:index]];
-          if ([key isEqualToString:@"wildcards"]) {
-            NSMutableArray *wildcards = [newParams objectForKey:key];
-            if (firstWildcard) {
-              // Create a new array and replace any existing object with the same key
-              wildcards = [NSMutableArray array];
-              [newParams setObject:wildcards forKey:key];
-              firstWildcard = NO;
-            }
-            [wildcards addObject:capture];
-          } else {
-            [newParams setObject:capture forKey:key];
-          }
-          index++;
-        }
-        params = newParams;
+    *paramsPtr = [self parametersWithRoute:route match:result path:path parameters:params];
+    return route;
+  }
+  
+  if (trieRouteIndex == NSNotFound)
+    return nil;
+  
+  Route *route = [methodRoutes objectAtIndex:trieRouteIndex];
+  if (route.keys) {
+    NSMutableDictionary *newParams = [params mutableCopy];
+    [route.segments enumerateObjectsUsingBlock:^(NSString *segment, NSUInteger idx, BOOL *stop) {
+      if ([segment hasPrefix:@":"]) {
+        [newParams setObject:[pathSegments objectAtIndex:idx] forKey:[segment substringFromIndex:1]];
       }
-    } else if (captureCount > 1) {
-      // For custom regular expressions place the anonymous captures in the captures parameter
+    }];
+    *paramsPtr = newParams;
+  }
+  return route;
+}
+
+- (NSDictionary *)parametersWithRoute:(Route *)route
+                                match:(NSTextCheckingResult *)result
+                                 path:(NSString *)path
+                           parameters:(NSDictionary *)params {
+  // The first range is all of the text matched by the regex.
+  NSUInteger captureCount = [result numberOfRanges];
+  
+  if (route.keys) {
+    // Add the route's parameters to the parameter dictionary, accounting for
+    // the first range containing the matched text.
+    if (captureCount == [route.keys count] + 1) {
       NSMutableDictionary *newParams = [params mutableCopy];
-      NSMutableArray *captures = [NSMutableArray array];
-      for (NSUInteger i = 1; i < captureCount; i++) {
-        [captures addObject:[path substringWithRange:[result rangeAtIndex:i]]];
+      NSUInteger index = 1;
+      BOOL firstWildcard = YES;
+      for (NSString *key in route.keys) {
+        NSString *capture = [path substringWithRange:[result rangeAtIndex:index]];
+        if ([key isEqualToString:@"wildcards"]) {
+          NSMutableArray *wildcards = [newParams objectForKey:key];
+          if (firstWildcard) {
+            // Create a new array and replace any existing object with the same key
+            wildcards = [NSMutableArray array];
+            [newParams setObject:wildcards forKey:key];
+            firstWildcard = NO;
+          }
+          [wildcards addObject:capture];
+        } else {
+          [newParams setObject:capture forKey:key];
+        }
+        index++;
       }
-      [newParams setObject:captures forKey:@"captures"];
       params = newParams;
     }
-    
-    RouteRequest *request = [[RouteRequest alloc] initWithHTTPMessage:httpMessage parameters:params];
-    RouteResponse *response = [[RouteResponse alloc] initWithConnection:connection];
-    if (!routeQueue) {
-      [self handleRoute:route withRequest:request response:response];
-    } else {
-      // Process the route on the specified queue
-      dispatch_sync(routeQueue, ^{
-        @autoreleasepool {
-          [self handleRoute:route withRequest:request response:response];
-        }
-      });
+  } else if (captureCount > 1) {
+    // For custom regular expressions place the anonymous captures in the captures parameter
+    NSMutableDictionary *newParams = [params mutableCopy];
+    NSMutableArray *captures = [NSMutableArray array];
+    for (NSUInteger i = 1; i < captureCount; i++) {
+      [captures addObject:[path substringWithRange:[result rangeAtIndex:i]]];
     }
-    return response;
+    [newParams setObject:captures forKey:@"captures"];
+    params = newParams;
   }
-  
-  return nil;
+  return params;
+}
+
+- (RouteResponse *)respondWithRoute:(Route *)route
+                         parameters:(NSDictionary *)params
+                            request:(HTTPMessage *)httpMessage
+                         connection:(HTTPConnection *)connection {
+  RouteRequest *request = [[RouteRequest alloc] initWithHTTPMessage:httpMessage parameters:params];
+  RouteResponse *response = [[RouteResponse alloc] initWithConnection:connection];
+  if (!routeQueue) {
+    [self handleRoute:route withRequest:request response:response];
+  } else {
+    // Process the route on the specified queue
+    dispatch_sync(routeQueue, ^{
+      @autoreleasepool {
+        [self handleRoute:route withRequest:request response:response];
+      }
+    });
+  }
+  return response;
 }
 
 - (void)setupMIMETypes {
@@ -31,6 +31,7 @@ FOUNDATION_EXPORT const unsigned char WebDriverAgentLib_VersionString[];
 #import <WebDriverAgentLib/FBLogger.h>
 #import <WebDriverAgentLib/FBMacros.h>
 #import <WebDriverAgentLib/FBResponseJSONPayload.h>
+#import <WebDriverAgentLib/FBResponseStreamPayload.h>
 #import <WebDriverAgentLib/FBResponsePayload.h>
 #import <WebDriverAgentLib/FBRoute.h>
 #import <WebDriverAgentLib/FBRouteRequest.h>
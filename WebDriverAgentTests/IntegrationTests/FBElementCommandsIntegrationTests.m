@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBElementCache.h"
+#import "FBElementCommands.h"
+#import "FBExceptions.h"
+#import "FBIntegrationTestCase.h"
+#import "FBResponsePayload.h"
+#import "FBRoute.h"
+#import "FBRouteRequest.h"
+#import "FBSession.h"
+#import "XCUIElement+FBUID.h"
+
+@interface FBElementCommandsIntegrationTests : FBIntegrationTestCase
+@property (nonatomic) FBSession *session;
+@end
+
+@implementation FBElementCommandsIntegrationTests
+
+- (void)setUp
+{
+  [super setUp];
+  [self launchApplication];
+  [self goToAttributesPage];
+  XCUIApplication *app = [[XCUIApplication alloc] initWithBundleIdentifier:self.testedApplication.bundleID];
+  self.session = [FBSession initWithApplication:app];
+}
+
+- (void)tearDown
+{
+  [self.session kill];
+  [super tearDown];
+}
+
+- (id<FBResponsePayload>)attributesPayloadWithElements:(NSArray<NSString *> *)uuids
+                                            attributes:(NSArray<NSString *> *)attributeNames
+{
+  FBRoute *attributesRoute = nil;
+  for (FBRoute *route in [FBElementCommands routes]) {
+    if ([route.path isEqualToString:@"/wda/elements/attributes"]) {
+      attributesRoute = route;
+      break;
+    }
+  }
+  XCTAssertNotNil(attributesRoute);
+  FBRouteRequest *request = [FBRouteRequest routeRequestWithURL:(NSURL *)[NSURL URLWithString:@"/wda/elements/attributes"]
+                                                     parameters:@{@"sessionID": self.session.identifier}
+                                                      arguments:@{@"elements": uuids, @"attributes": attributeNames}];
+  return [attributesRoute payloadForRequest:request];
+}
+
+- (void)testBulkAttributesOfCachedElements
+{
+  NSString *uuid = [self.session.elementCache storeElement:self.testedApplication.buttons[@"Button"]];
+  XCTAssertNotNil(uuid);
+  id<FBResponsePayload> payload = [self attributesPayloadWithElements:@[(NSString *)uuid]
+                                                           attributes:@[@"name", @"type"]];
+  XCTAssertEqual(200, payload.httpStatusCode);
+  XCTAssertEqualObjects((@[@[@"Button", @"XCUIElementTypeButton"]]), payload.value);
+}
+
+- (void)testBulkAttributesOfUncachedElementsAreStale
+{
+  NSString *uuid = [self.session.elementCache storeElement:self.testedApplication.buttons[@"Button"]];
+  // The element is present in the hierarchy, but it has never been cached
+  NSString *uncachedUuid = self.testedApplication.buttons[@"not_accessible"].fb_uid;
+  XCTAssertNotNil(uuid);
+  XCTAssertNotNil(uncachedUuid);
+  XCTAssertThrowsSpecificNamed([self attributesPayloadWithElements:@[(NSString *)uuid, (NSString *)uncachedUuid]
+                                                        attributes:@[@"name"]],
+                               NSException,
+                               FBStaleElementException);
+}
+
+@end
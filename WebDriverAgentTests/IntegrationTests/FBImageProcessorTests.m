@@ -8,10 +8,17 @@
 
 #import <XCTest/XCTest.h>
 
+@import UniformTypeIdentifiers;
+
 #import "FBImageProcessor.h"
 #import "FBIntegrationTestCase.h"
 
 
+@interface FBImageProcessor (Tests)
+@property (nonatomic, readonly) dispatch_queue_t scalingQueue;
+@property (nonatomic, readonly) dispatch_queue_t encodingQueue;
+@end
+
 @interface FBImageProcessorTests : FBIntegrationTestCase
 
 @property (nonatomic) NSData *originalImage;
@@ -70,6 +77,122 @@
 
 }
 
+- (NSData *)processedImageWithCompressionQuality:(CGFloat)compressionQuality
+                        sourceCompressionQuality:(CGFloat)sourceCompressionQuality
+{
+  FBImageProcessor *processor = [[FBImageProcessor alloc] init];
+  id expProcessed = [self expectationWithDescription:@"Receive processed image"];
+  __block NSData *result;
+  [processor submitImageData:self.originalImage
+               scalingFactor:1.0
+          compressionQuality:compressionQuality
+    sourceCompressionQuality:sourceCompressionQuality
+           completionHandler:^(NSData *processed) {
+    result = processed;
+    [expProcessed fulfill];
+  }];
+  [self waitForExpectations:@[expProcessed] timeout:2.0];
+  return result;
+}
+
+- (void)testUnscaledImageIsReencodedToLowerQuality
+{
+  NSData *reencoded = [self processedImageWithCompressionQuality:0.2 sourceCompressionQuality:1.0];
+  XCTAssertLessThan(reencoded.length, self.originalImage.length);
+  CGSize reencodedSize = [FBImageProcessorTests scaledSizeFromImage:[UIImage imageWithData:reencoded]];
+  XCTAssertEqualWithAccuracy(reencodedSize.width, self.originalSize.width, 1.0);
+
+  // The source image already has the requested quality
+  XCTAssertEqualObjects(self.originalImage, [self processedImageWithCompressionQuality:1.0 sourceCompressionQuality:1.0]);
+  XCTAssertEqualObjects(self.originalImage, [self processedImageWithCompressionQuality:0.9 sourceCompressionQuality:0.5]);
+}
+
+- (void)testFramesAreDeliveredInSubmissionOrder
+{
+  FBImageProcessor *scaler = [[FBImageProcessor alloc] init];
+  NSArray<NSNumber *> *scalingFactors = @[@0.1, @0.2, @0.3, @0.4, @0.5];
+  NSMutableArray<NSNumber *> *deliveredIndexes = [NSMutableArray array];
+  id expLastScaled = [self expectationWithDescription:@"Receive the most recent image"];
+  for (NSNumber *scalingFactor in scalingFactors) {
+    [scaler submitImageData:self.originalImage
+              scalingFactor:scalingFactor.doubleValue
+          completionHandler:^(NSData *scaled) {
+      CGFloat width = [FBImageProcessorTests scaledSizeFromImage:[UIImage imageWithData:scaled]].width;
+      NSUInteger index = (NSUInteger)round(width / self.originalSize.width * 10) - 1;
+      [deliveredIndexes addObject:@(index)];
+      if (index == scalingFactors.count - 1) {
+        [expLastScaled fulfill];
+      }
+    }];
+    // Let each frame pass the scaling stage, so it could only be dropped by the encoding stage
+    dispatch_sync(scaler.scalingQueue, ^{});
+  }
+  [self waitForExpectations:@[expLastScaled] timeout:2.0];
+
+  dispatch_sync(scaler.encodingQueue, ^{});
+  for (NSUInteger i = 1; i < deliveredIndexes.count; i++) {
+    XCTAssertLessThan(deliveredIndexes[i - 1].unsignedIntegerValue, deliveredIndexes[i].unsignedIntegerValue);
+  }
+  NSDictionary<NSString *, NSNumber *> *statistics = scaler.statistics;
+  XCTAssertEqual(statistics[@"processedFrames"].unsignedIntegerValue, deliveredIndexes.count);
+  XCTAssertEqual(statistics[@"processedFrames"].unsignedIntegerValue + statistics[@"droppedFrames"].unsignedIntegerValue,
+                 scalingFactors.count);
+}
+
+- (void)testFramesBecomingStaleBeforeEncodingAreDropped
+{
+  FBImageProcessor *scaler = [[FBImageProcessor alloc] init];
+  dispatch_semaphore_t encodingBlocker = dispatch_semaphore_create(0);
+  dispatch_async(scaler.encodingQueue, ^{
+    dispatch_semaphore_wait(encodingBlocker, DISPATCH_TIME_FOREVER);
+  });
+  NSMutableArray<NSData *> *deliveredImages = [NSMutableArray array];
+  for (NSNumber *scalingFactor in @[@0.5, @0.25]) {
+    [scaler submitImageData:self.originalImage
+              scalingFactor:scalingFactor.doubleValue
+          completionHandler:^(NSData *scaled) {
+      [deliveredImages addObject:scaled];
+    }];
+    // Both frames are scaled while the encoding stage is busy
+    dispatch_sync(scaler.scalingQueue, ^{});
+  }
+  dispatch_semaphore_signal(encodingBlocker);
+  dispatch_sync(scaler.encodingQueue, ^{});
+
+  XCTAssertEqual(deliveredImages.count, 1);
+  CGSize expectedSize = [FBImageProcessorTests sizeFromSize:self.originalSize scalingFactor:0.25];
+  CGSize deliveredSize = [FBImageProcessorTests scaledSizeFromImage:[UIImage imageWithData:deliveredImages.firstObject]];
+  XCTAssertEqualWithAccuracy(deliveredSize.width, expectedSize.width, 1.0);
+  NSDictionary<NSString *, NSNumber *> *statistics = scaler.statistics;
+  XCTAssertEqual(statistics[@"processedFrames"].unsignedIntegerValue, 1);
+  XCTAssertEqual(statistics[@"droppedFrames"].unsignedIntegerValue, 1);
+}
+
+- (void)testCroppingWithScaling
+{
+  FBImageProcessor *processor = [[FBImageProcessor alloc] init];
+  NSError *error;
+  NSData *cropped = [processor croppedImageWithData:self.originalImage
+                                               rect:CGRectMake(10, 20, 100, 60)
+                                                uti:UTTypePNG
+                                      scalingFactor:0.5
+                                 compressionQuality:1.0
+                                              error:&error];
+  XCTAssertNotNil(cropped);
+  XCTAssertNil(error);
+  CGSize croppedSize = [FBImageProcessorTests scaledSizeFromImage:[UIImage imageWithData:cropped]];
+  XCTAssertEqualWithAccuracy(croppedSize.width, 50, 1.0);
+  XCTAssertEqualWithAccuracy(croppedSize.height, 30, 1.0);
+
+  XCTAssertNil([processor croppedImageWithData:self.originalImage
+                                          rect:CGRectMake(-200, -200, 100, 100)
+                                           uti:UTTypePNG
+                                 scalingFactor:1.0
+                            compressionQuality:1.0
+                                         error:&error]);
+  XCTAssertNotNil(error);
+}
+
 + (CGSize)scaledSizeFromImage:(UIImage *)image {
   return CGSizeMake(image.size.width * image.scale, image.size.height * image.scale);
 }
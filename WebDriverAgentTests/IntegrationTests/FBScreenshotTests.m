@@ -0,0 +1,183 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <XCTest/XCTest.h>
+
+@import UniformTypeIdentifiers;
+
+#import "FBIntegrationTestCase.h"
+#import "FBScreen.h"
+#import "FBScreenshot-Private.h"
+
+static const NSTimeInterval FBTestCaptureMaxAge = 5.;
+
+@interface FBScreenshotTests : FBIntegrationTestCase
+@end
+
+@implementation FBScreenshotTests
+
++ (UIGraphicsImageRenderer *)rendererWithSize:(CGSize)size
+{
+  UIGraphicsImageRendererFormat *format = [[UIGraphicsImageRendererFormat alloc] init];
+  format.scale = 1.0;
+  return [[UIGraphicsImageRenderer alloc] initWithSize:size format:format];
+}
+
++ (void)fillWithContext:(UIGraphicsImageRendererContext *)context size:(CGSize)size
+{
+  [UIColor.blueColor setFill];
+  [context fillRect:CGRectMake(0, 0, size.width, size.height)];
+}
+
++ (NSData *)pngDataWithSize:(CGSize)size
+{
+  return [[self rendererWithSize:size] PNGDataWithActions:^(UIGraphicsImageRendererContext *context) {
+    [self fillWithContext:context size:size];
+  }];
+}
+
++ (NSData *)jpegDataWithSize:(CGSize)size compressionQuality:(CGFloat)compressionQuality
+{
+  return [[self rendererWithSize:size] JPEGDataWithCompressionQuality:compressionQuality
+                                                              actions:^(UIGraphicsImageRendererContext *context) {
+    [self fillWithContext:context size:size];
+  }];
+}
+
+// Each test uses its own screen identifier, so captures stored by other tests are never reused
+- (void)storeCaptureWithData:(NSData *)data
+                         uti:(UTType *)uti
+          compressionQuality:(CGFloat)compressionQuality
+                    screenID:(long long)screenID
+{
+  [FBScreenshot storeCapture:[[FBScreenCapture alloc] initWithData:data
+                                                               uti:uti
+                                                compressionQuality:compressionQuality
+                                                          screenID:screenID]];
+}
+
+- (void)testLosslessCaptureSatisfiesPngAndJpegRequests
+{
+  long long screenID = 1001;
+  NSData *pngData = [self.class pngDataWithSize:CGSizeMake(100, 60)];
+  [self storeCaptureWithData:pngData uti:UTTypePNG compressionQuality:1.0 screenID:screenID];
+
+  XCTAssertEqualObjects(pngData, [FBScreenshot cachedDataWithScreenID:screenID
+                                                   compressionQuality:1.0
+                                                                  uti:UTTypePNG
+                                                               maxAge:FBTestCaptureMaxAge]);
+  NSData *jpegData = [FBScreenshot cachedDataWithScreenID:screenID
+                                       compressionQuality:0.5
+                                                      uti:UTTypeJPEG
+                                                   maxAge:FBTestCaptureMaxAge];
+  XCTAssertNotNil(jpegData);
+  const uint8_t jpegSignature[] = {0xFF, 0xD8};
+  XCTAssertEqualObjects([NSData dataWithBytes:jpegSignature length:sizeof(jpegSignature)],
+                        [jpegData subdataWithRange:NSMakeRange(0, sizeof(jpegSignature))]);
+  XCTAssertNotNil([FBScreenshot cachedPngWithRect:CGRectMake(0, 0, 10, 10)
+                                         screenID:screenID
+                                           maxAge:FBTestCaptureMaxAge]);
+}
+
+- (void)testLossyCaptureIsNeverUpgraded
+{
+  long long screenID = 1002;
+  NSData *jpegData = [self.class jpegDataWithSize:CGSizeMake(100, 60) compressionQuality:0.5];
+  [self storeCaptureWithData:jpegData uti:UTTypeJPEG compressionQuality:0.5 screenID:screenID];
+
+  XCTAssertEqualObjects(jpegData, [FBScreenshot cachedDataWithScreenID:screenID
+                                                    compressionQuality:0.3
+                                                                   uti:UTTypeJPEG
+                                                                maxAge:FBTestCaptureMaxAge]);
+  XCTAssertNil([FBScreenshot cachedDataWithScreenID:screenID
+                                 compressionQuality:0.8
+                                                uti:UTTypeJPEG
+                                             maxAge:FBTestCaptureMaxAge]);
+  XCTAssertNil([FBScreenshot cachedDataWithScreenID:screenID
+                                 compressionQuality:1.0
+                                                uti:UTTypePNG
+                                             maxAge:FBTestCaptureMaxAge]);
+  XCTAssertNil([FBScreenshot cachedPngWithRect:CGRectMake(0, 0, 10, 10)
+                                      screenID:screenID
+                                        maxAge:FBTestCaptureMaxAge]);
+}
+
+- (void)testMaxQualityJpegCaptureIsNotLossless
+{
+  long long screenID = 1005;
+  NSData *jpegData = [self.class jpegDataWithSize:CGSizeMake(100, 60) compressionQuality:1.0];
+  [self storeCaptureWithData:jpegData uti:UTTypeJPEG compressionQuality:1.0 screenID:screenID];
+
+  XCTAssertFalse([[FBScreenCapture alloc] initWithData:jpegData
+                                                   uti:UTTypeJPEG
+                                    compressionQuality:1.0
+                                              screenID:screenID].isLossless);
+  XCTAssertEqualObjects(jpegData, [FBScreenshot cachedDataWithScreenID:screenID
+                                                    compressionQuality:0.5
+                                                                   uti:UTTypeJPEG
+                                                                maxAge:FBTestCaptureMaxAge]);
+  XCTAssertNil([FBScreenshot cachedDataWithScreenID:screenID
+                                 compressionQuality:1.0
+                                                uti:UTTypePNG
+                                             maxAge:FBTestCaptureMaxAge]);
+  XCTAssertNil([FBScreenshot cachedPngWithRect:CGRectMake(0, 0, 10, 10)
+                                      screenID:screenID
+                                        maxAge:FBTestCaptureMaxAge]);
+}
+
+- (void)testOutdatedCapturesAreIgnored
+{
+  long long screenID = 1003;
+  NSData *pngData = [self.class pngDataWithSize:CGSizeMake(100, 60)];
+  uint64_t capturedAt = clock_gettime_nsec_np(CLOCK_UPTIME_RAW) - 2 * NSEC_PER_SEC;
+  [FBScreenshot storeCapture:[[FBScreenCapture alloc] initWithData:pngData
+                                                               uti:UTTypePNG
+                                                compressionQuality:1.0
+                                                          screenID:screenID
+                                                        capturedAt:capturedAt]];
+
+  XCTAssertNotNil([FBScreenshot cachedDataWithScreenID:screenID
+                                    compressionQuality:1.0
+                                                   uti:UTTypePNG
+                                                maxAge:FBTestCaptureMaxAge]);
+  XCTAssertNil([FBScreenshot cachedDataWithScreenID:screenID
+                                 compressionQuality:1.0
+                                                uti:UTTypePNG
+                                             maxAge:1.0]);
+  XCTAssertNil([FBScreenshot cachedPngWithRect:CGRectMake(0, 0, 10, 10)
+                                      screenID:screenID
+                                        maxAge:1.0]);
+  XCTAssertNil([FBScreenshot cachedDataWithScreenID:screenID
+                                 compressionQuality:1.0
+                                                uti:UTTypePNG
+                                             maxAge:0]);
+}
+
+- (void)testCropRectIsClippedToImageBounds
+{
+  long long screenID = 1004;
+  [self storeCaptureWithData:[self.class pngDataWithSize:CGSizeMake(100, 60)]
+                         uti:UTTypePNG
+          compressionQuality:1.0
+                    screenID:screenID];
+  CGFloat scale = (CGFloat)[FBScreen scale];
+
+  NSData *croppedData = [FBScreenshot cachedPngWithRect:CGRectMake(50 / scale, 30 / scale, 100 / scale, 100 / scale)
+                                               screenID:screenID
+                                                 maxAge:FBTestCaptureMaxAge];
+  XCTAssertNotNil(croppedData);
+  CGImageRef croppedImage = [UIImage imageWithData:(NSData *)croppedData].CGImage;
+  XCTAssertEqual(CGImageGetWidth(croppedImage), 50);
+  XCTAssertEqual(CGImageGetHeight(croppedImage), 30);
+
+  XCTAssertNil([FBScreenshot cachedPngWithRect:CGRectMake(200 / scale, 0, 10, 10)
+                                      screenID:screenID
+                                        maxAge:FBTestCaptureMaxAge]);
+}
+
+@end
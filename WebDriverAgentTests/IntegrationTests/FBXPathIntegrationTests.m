@@ -12,6 +12,8 @@
 #import "FBMacros.h"
 #import "FBTestMacros.h"
 #import "FBXPath.h"
+#import "FBXPath-Private.h"
+#import "FBXPathDocumentCache.h"
 #import "FBXCAccessibilityElement.h"
 #import "FBXCodeCompatibility.h"
 #import "FBXCElementSnapshotWrapper+Helpers.h"
@@ -22,6 +24,13 @@
 #import "XCUIElement+FBUtilities.h"
 #import "XCUIElement+FBWebDriverAttributes.h"
 
+@interface FBXPath (Tests)
++ (nullable FBXPathDocument *)documentWithRootElement:(id<FBElement>)root
+                                        compiledQuery:(FBXPathCompiledQuery *)compiledQuery
+                                            useNative:(BOOL)useNativeSnapshot;
++ (nullable xmlNodePtr)matchNodeInDocument:(FBXPathDocument *)document
+                               forSnapshot:(nullable id<FBXCElementSnapshot>)snapshot;
+@end
 
 @interface FBXPathIntegrationTests : FBIntegrationTestCase
 @property (nonatomic, strong) XCUIElement *testedView;
@@ -145,6 +154,39 @@
   }
 }
 
+- (void)testContextNodeIsResolvedThroughUidIndex
+{
+  XCUIElement *button = self.testedApplication.buttons.firstMatch;
+  FBXPathCompiledQuery *compiledQuery = [FBXPath compiledQueryWithQuery:@".."];
+  XCTAssertNotNil(compiledQuery);
+  BOOL previousValue = FBConfiguration.limitXpathContextScope;
+  @try {
+    FBConfiguration.limitXpathContextScope = YES;
+    FBXPathDocument *limitedDocument = [FBXPath documentWithRootElement:button
+                                                          compiledQuery:(FBXPathCompiledQuery *)compiledQuery
+                                                              useNative:NO];
+    XCTAssertNotNil(limitedDocument);
+    // The index is not needed if the lookup scope is limited to the root element
+    XCTAssertEqual(0, limitedDocument.nodesByUid.count);
+
+    FBConfiguration.limitXpathContextScope = NO;
+    FBXPathDocument *document = [FBXPath documentWithRootElement:button
+                                                   compiledQuery:(FBXPathCompiledQuery *)compiledQuery
+                                                       useNative:NO];
+    XCTAssertNotNil(document);
+    XCTAssertGreaterThan(document.nodesByUid.count, 0);
+    xmlNodePtr contextNode = [FBXPath matchNodeInDocument:(FBXPathDocument *)document
+                                              forSnapshot:button.fb_customSnapshot];
+    XCTAssertTrue(NULL != contextNode);
+    if (NULL != contextNode) {
+      id<FBXCElementSnapshot> contextSnapshot = (__bridge id<FBXCElementSnapshot>)contextNode->_private;
+      XCTAssertEqualObjects([FBXCElementSnapshotWrapper ensureWrapped:contextSnapshot].wdType, @"XCUIElementTypeButton");
+    }
+  } @finally {
+    FBConfiguration.limitXpathContextScope = previousValue;
+  }
+}
+
 - (void)testFindMatchesInElementWithDotNotation
 {
   NSArray<id<FBXCElementSnapshot>> *matchingSnapshots = [FBXPath matchesWithRootElement:self.testedApplication forQuery:@".//XCUIElementTypeButton"];
@@ -19,6 +19,7 @@
   self = [super init];
   self->_value = @"magicValue";
   self->_label = @"testLabel";
+  self->_elementType = XCUIElementTypeOther;
   return self;
 }
 
@@ -37,11 +38,6 @@
   return @"testTitle";
 }
 
-- (XCUIElementType)elementType
-{
-  return XCUIElementTypeOther;
-}
-
 - (BOOL)isEnabled
 {
   return YES;
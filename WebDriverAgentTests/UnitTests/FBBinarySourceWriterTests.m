@@ -0,0 +1,51 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBBinarySourceWriter.h"
+
+@interface FBBinarySourceWriterTests : XCTestCase
+@end
+
+@implementation FBBinarySourceWriterTests
+
+- (void)testEmptyTree
+{
+  NSData *data = [[FBBinarySourceWriter alloc] init].data;
+  const uint8_t expected[] = {'W', 'D', 'A', 'S', FBBinarySourceFormatVersion, 1, 0, 0};
+  XCTAssertEqualObjects(data, [NSData dataWithBytes:expected length:sizeof(expected)]);
+}
+
+- (void)testNodesShareStrings
+{
+  FBBinarySourceWriter *writer = [[FBBinarySourceWriter alloc] init];
+  NSUInteger rootIndex = [writer appendNodeWithParentIndex:NSNotFound
+                                                      type:@"Button"
+                                                      rect:CGRectMake(0, -1, 2, 3)
+                                                attributes:@{@"name": @"Button"}];
+  XCTAssertEqual(rootIndex, 0);
+  NSUInteger childIndex = [writer appendNodeWithParentIndex:rootIndex
+                                                       type:@"Button"
+                                                       rect:CGRectZero
+                                                 attributes:@{}];
+  XCTAssertEqual(childIndex, 1);
+
+  const uint8_t expected[] = {
+    'W', 'D', 'A', 'S', FBBinarySourceFormatVersion, 1,
+    // strings
+    2, 6, 'B', 'u', 't', 't', 'o', 'n', 4, 'n', 'a', 'm', 'e',
+    // nodes
+    2,
+    0, 0, 0, 1, 4, 6, 1, 1, 0,
+    1, 0, 0, 0, 0, 0, 0,
+  };
+  XCTAssertEqualObjects(writer.data, [NSData dataWithBytes:expected length:sizeof(expected)]);
+}
+
+@end
@@ -8,6 +8,7 @@
 
 #import <XCTest/XCTest.h>
 
+#import "FBConfiguration.h"
 #import "FBElementCache.h"
 #import "XCUIElementDouble.h"
 #import "XCUIElement+FBCaching.h"
@@ -25,6 +26,13 @@
   self.cache = [FBElementCache new];
 }
 
+- (void)tearDown
+{
+  [FBConfiguration setElementCacheMemoryLimit:0];
+  [FBConfiguration setElementCacheTimeToLive:0];
+  [super tearDown];
+}
+
 - (void)testStoringElement
 {
   XCUIElementDouble *el1 = XCUIElementDouble.new;
@@ -121,4 +129,57 @@
   }
 }
 
+- (void)testMemoryLimitedCacheExpulsion
+{
+  [FBConfiguration setElementCacheMemoryLimit:NSUIntegerMax];
+  XCUIElementDouble *probe = XCUIElementDouble.new;
+  probe.wdUID = @"probe";
+  [self.cache storeElement:(XCUIElement *)probe];
+  NSUInteger elementSize = [self.cache.statistics[@"retainedBytes"] unsignedIntegerValue];
+  XCTAssertTrue(elementSize > 0);
+
+  [FBConfiguration setElementCacheMemoryLimit:elementSize * 3];
+  NSMutableArray *elementIds = [NSMutableArray array];
+  for (int i = 0; i < 5; i++) {
+    XCUIElementDouble *el = XCUIElementDouble.new;
+    el.wdUID = [NSString stringWithFormat:@"%@", @(i)];
+    [elementIds addObject:[self.cache storeElement:(XCUIElement *)el]];
+  }
+
+  XCTAssertFalse([self.cache hasElementWithUUID:@"probe"]);
+  XCTAssertFalse([self.cache hasElementWithUUID:elementIds[0]]);
+  XCTAssertFalse([self.cache hasElementWithUUID:elementIds[1]]);
+  for (int i = 2; i < 5; i++) {
+    XCTAssertTrue([self.cache hasElementWithUUID:elementIds[i]]);
+  }
+  NSDictionary *statistics = self.cache.statistics;
+  XCTAssertEqualObjects(statistics[@"count"], @3);
+  XCTAssertEqualObjects(statistics[@"evictions"], @3);
+  XCTAssertEqualObjects(statistics[@"retainedBytes"], @(elementSize * 3));
+}
+
+- (void)testElementSizeIsNotEstimatedWithoutMemoryLimit
+{
+  XCUIElementDouble *el = XCUIElementDouble.new;
+  el.wdUID = @"1";
+  XCTAssertNotNil([self.cache storeElement:(XCUIElement *)el]);
+  XCTAssertEqualObjects(self.cache.statistics[@"retainedBytes"], @0);
+}
+
+- (void)testExpiredElementsRemoval
+{
+  [FBConfiguration setElementCacheTimeToLive:0.1];
+  XCUIElementDouble *el1 = XCUIElementDouble.new;
+  el1.wdUID = @"1";
+  NSString *firstUUID = [self.cache storeElement:(XCUIElement *)el1];
+  [NSThread sleepForTimeInterval:0.2];
+  XCUIElementDouble *el2 = XCUIElementDouble.new;
+  el2.wdUID = @"2";
+  NSString *secondUUID = [self.cache storeElement:(XCUIElement *)el2];
+
+  XCTAssertThrows([self.cache elementForUUID:firstUUID]);
+  XCTAssertEqual((XCUIElement *)el2, [self.cache elementForUUID:secondUUID]);
+  XCTAssertEqualObjects(self.cache.statistics[@"expirations"], @1);
+}
+
 @end
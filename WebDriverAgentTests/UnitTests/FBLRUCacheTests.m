@@ -124,4 +124,142 @@
     [self assertArray:@[@"foo3", @"foo2"] equalsTo:cache.allObjects];
 }
 
+- (void)testContainsObjectDoesNotBump {
+    LRUCache *cache = [[LRUCache alloc] initWithCapacity:2];
+    [cache setObject:@"foo" forKey:@"bar"];
+    [cache setObject:@"foo2" forKey:@"bar2"];
+    XCTAssertTrue([cache containsObjectForKey:@"bar"]);
+    XCTAssertFalse([cache containsObjectForKey:@"nonExisting"]);
+    [self assertArray:@[@"foo2", @"foo"] equalsTo:cache.allObjects];
+    [cache setObject:@"foo3" forKey:@"bar3"];
+    XCTAssertFalse([cache containsObjectForKey:@"bar"]);
+    [self assertArray:@[@"foo3", @"foo2"] equalsTo:cache.allObjects];
+}
+
+- (void)testZeroCapacity {
+    LRUCache *cache = [[LRUCache alloc] initWithCapacity:0];
+    [cache setObject:@"foo" forKey:@"bar"];
+    XCTAssertNil([cache objectForKey:@"bar"]);
+    [self assertArray:@[] equalsTo:cache.allObjects];
+}
+
+- (void)testEntriesReuseAfterRemoval {
+    LRUCache *cache = [[LRUCache alloc] initWithCapacity:3];
+    for (NSUInteger i = 0; i < 100; ++i) {
+      [cache setObject:@(i) forKey:@(i)];
+      [cache removeObjectForKey:@(i - 1)];
+    }
+    [self assertArray:@[@99] equalsTo:cache.allObjects];
+    [cache setObject:@"foo" forKey:@"bar"];
+    [cache setObject:@"foo2" forKey:@"bar2"];
+    [cache setObject:@"foo3" forKey:@"bar3"];
+    [self assertArray:@[@"foo3", @"foo2", @"foo"] equalsTo:cache.allObjects];
+}
+
+- (void)testConcurrentAccess {
+    LRUCache *cache = [[LRUCache alloc] initWithCapacity:16];
+    dispatch_apply(1000, dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^(size_t i) {
+      NSNumber *key = @(i % 32);
+      [cache setObject:key forKey:key];
+      id object = [cache objectForKey:key];
+      if (nil != object) {
+        XCTAssertEqualObjects(object, key);
+      }
+      [cache removeObjectForKey:@((i + 7) % 32)];
+    });
+    XCTAssertTrue(cache.allObjects.count <= 16);
+}
+
+- (void)testTotalCostLimit {
+    LRUCache *cache = [[LRUCache alloc] initWithCapacity:10];
+    cache.totalCostLimit = 10;
+    [cache setObject:@"foo" forKey:@"bar" cost:4];
+    [cache setObject:@"foo2" forKey:@"bar2" cost:4];
+    [cache setObject:@"foo3" forKey:@"bar3" cost:4];
+    [self assertArray:@[@"foo3", @"foo2"] equalsTo:cache.allObjects];
+    XCTAssertEqual(8, cache.totalCost);
+    XCTAssertEqual(1, cache.evictionsCount);
+    [cache setObject:@"foo4" forKey:@"bar3" cost:1];
+    XCTAssertEqual(5, cache.totalCost);
+    [cache setObject:@"foo5" forKey:@"bar5" cost:20];
+    [self assertArray:@[@"foo5"] equalsTo:cache.allObjects];
+    XCTAssertEqual(20, cache.totalCost);
+    [cache removeObjectForKey:@"bar5"];
+    XCTAssertEqual(0, cache.totalCost);
+    XCTAssertEqual(0, cache.count);
+}
+
+- (void)testRemoveObjectsNotAccessedWithin {
+    LRUCache *cache = [[LRUCache alloc] initWithCapacity:3];
+    [cache setObject:@"foo" forKey:@"bar"];
+    [cache setObject:@"foo2" forKey:@"bar2"];
+    [NSThread sleepForTimeInterval:0.2];
+    XCTAssertNotNil([cache objectForKey:@"bar"]);
+    [cache setObject:@"foo3" forKey:@"bar3"];
+    XCTAssertEqual(1, [cache removeObjectsNotAccessedWithin:0.1]);
+    [self assertArray:@[@"foo3", @"foo"] equalsTo:cache.allObjects];
+    XCTAssertEqual(0, [cache removeObjectsNotAccessedWithin:0.1]);
+}
+
+- (void)testMassEvictionReleasesObjects {
+    LRUCache *cache = [[LRUCache alloc] initWithCapacity:100];
+    __weak id evictedObject = nil;
+    @autoreleasepool {
+        for (NSUInteger i = 0; i < 100; i++) {
+            NSMutableString *object = [NSMutableString stringWithFormat:@"foo%@", @(i)];
+            if (0 == i) {
+                evictedObject = object;
+            }
+            [cache setObject:object forKey:@(i) cost:1];
+        }
+        // Many more entries are evicted at once than released in a single batch
+        cache.totalCostLimit = 50;
+        [cache setObject:@"bar" forKey:@"bar" cost:1];
+    }
+    XCTAssertNil(evictedObject);
+    XCTAssertEqual(50, cache.count);
+    XCTAssertEqual(50, cache.totalCost);
+    XCTAssertEqual(51, cache.evictionsCount);
+    XCTAssertNotNil([cache objectForKey:@"bar"]);
+    [NSThread sleepForTimeInterval:0.01];
+    XCTAssertEqual(50, [cache removeObjectsNotAccessedWithin:0]);
+    XCTAssertEqual(0, cache.count);
+    XCTAssertEqual(0, cache.totalCost);
+}
+
+- (void)testLookupPerformance {
+    NSUInteger capacity = 1024;
+    NSMutableArray<NSString *> *keys = [NSMutableArray arrayWithCapacity:capacity];
+    for (NSUInteger i = 0; i < capacity; ++i) {
+      [keys addObject:NSUUID.UUID.UUIDString];
+    }
+    LRUCache *cache = [[LRUCache alloc] initWithCapacity:capacity];
+    for (NSString *key in keys) {
+      [cache setObject:key forKey:key];
+    }
+    [self measureBlock:^{
+      for (NSUInteger i = 0; i < 100; ++i) {
+        for (NSString *key in keys) {
+          [cache objectForKey:key];
+        }
+      }
+    }];
+}
+
+- (void)testInsertionPerformance {
+    NSUInteger capacity = 1024;
+    NSMutableArray<NSString *> *keys = [NSMutableArray arrayWithCapacity:capacity * 4];
+    for (NSUInteger i = 0; i < capacity * 4; ++i) {
+      [keys addObject:NSUUID.UUID.UUIDString];
+    }
+    [self measureBlock:^{
+      LRUCache *cache = [[LRUCache alloc] initWithCapacity:capacity];
+      for (NSUInteger i = 0; i < 10; ++i) {
+        for (NSString *key in keys) {
+          [cache setObject:key forKey:key];
+        }
+      }
+    }];
+}
+
 @end
@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBMjpegAdaptiveController.h"
+
+@interface FBMjpegAdaptiveControllerTests : XCTestCase
+@property (nonatomic) FBMjpegAdaptiveController *controller;
+@end
+
+@implementation FBMjpegAdaptiveControllerTests
+
+- (void)setUp
+{
+  [super setUp];
+  self.controller = [[FBMjpegAdaptiveController alloc] initWithFramerate:10 quality:50 scalingFactor:100];
+}
+
+- (void)adjust
+{
+  [self.controller adjustWithMaxFramerate:10 maxQuality:50 maxScalingFactor:100 bandwidthLimit:0];
+}
+
+- (void)testParametersAreKeptWithoutMeasurements
+{
+  [self adjust];
+  XCTAssertEqual(self.controller.framerate, 10);
+  XCTAssertEqual(self.controller.quality, 50);
+  XCTAssertEqualWithAccuracy(self.controller.scalingFactor, 100, 0.001);
+}
+
+- (void)testQualityIsLoweredFirstOnDroppedFrames
+{
+  [self.controller recordFrameWithCaptureDuration:0.01 encodeDuration:0.01 size:1000];
+  [self.controller recordDroppedFrame];
+  [self adjust];
+  XCTAssertEqual(self.controller.quality, 40);
+  XCTAssertEqual(self.controller.framerate, 10);
+  XCTAssertEqualWithAccuracy(self.controller.scalingFactor, 100, 0.001);
+}
+
+- (void)testScalingFactorIsLoweredAfterQualityIsAtMinimum
+{
+  for (NSUInteger i = 0; i < 5; i++) {
+    [self.controller recordFrameWithCaptureDuration:0.01 encodeDuration:0.01 size:1000];
+    [self.controller recordDeliveryWithSize:1000 duration:0.5];
+    [self adjust];
+  }
+  XCTAssertEqual(self.controller.quality, 10);
+  XCTAssertEqualWithAccuracy(self.controller.scalingFactor, 90, 0.001);
+  XCTAssertEqual(self.controller.framerate, 10);
+}
+
+- (void)testBandwidthLimitIsRespected
+{
+  [self.controller recordFrameWithCaptureDuration:0.01 encodeDuration:0.01 size:100000];
+  [self.controller adjustWithMaxFramerate:10 maxQuality:50 maxScalingFactor:100 bandwidthLimit:500000];
+  XCTAssertEqual(self.controller.quality, 40);
+}
+
+- (void)testFramerateFollowsProcessingDuration
+{
+  [self.controller recordFrameWithCaptureDuration:0.2 encodeDuration:0.05 size:1000];
+  [self adjust];
+  XCTAssertEqual(self.controller.framerate, 4);
+  XCTAssertEqual(self.controller.quality, 50);
+}
+
+- (void)testParametersAreRestoredUpToMaximums
+{
+  [self.controller recordFrameWithCaptureDuration:0.01 encodeDuration:0.01 size:1000];
+  [self.controller recordDroppedFrame];
+  [self adjust];
+  XCTAssertEqual(self.controller.quality, 40);
+  for (NSUInteger i = 0; i < 5; i++) {
+    [self.controller recordFrameWithCaptureDuration:0.01 encodeDuration:0.01 size:1000];
+    [self.controller recordDeliveryWithSize:1000 duration:0.001];
+    [self adjust];
+  }
+  XCTAssertEqual(self.controller.quality, 50);
+  XCTAssertEqual(self.controller.framerate, 10);
+  XCTAssertEqualWithAccuracy(self.controller.scalingFactor, 100, 0.001);
+}
+
+- (void)testLoweredMaximumsAreAppliedImmediately
+{
+  [self.controller adjustWithMaxFramerate:5 maxQuality:30 maxScalingFactor:50 bandwidthLimit:0];
+  XCTAssertEqual(self.controller.framerate, 5);
+  XCTAssertEqual(self.controller.quality, 30);
+  XCTAssertEqualWithAccuracy(self.controller.scalingFactor, 50, 0.001);
+}
+
+@end
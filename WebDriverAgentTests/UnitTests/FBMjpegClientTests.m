@@ -0,0 +1,51 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBMjpegServer-Private.h"
+#import "GCDAsyncSocket.h"
+
+static NSArray<NSData *> *FBTestFrameChunks(NSUInteger length)
+{
+  return @[[NSMutableData dataWithLength:length]];
+}
+
+@interface FBMjpegClientTests : XCTestCase
+@end
+
+@implementation FBMjpegClientTests
+
+- (void)testClientWritesOneFrameAtATime
+{
+  FBMjpegClient *client = [[FBMjpegClient alloc] initWithSocket:[[GCDAsyncSocket alloc] init]];
+  XCTAssertTrue([client enqueueFrameWithChunks:FBTestFrameChunks(1)]);
+  // The client is busy, so the frame is kept as pending
+  XCTAssertTrue([client enqueueFrameWithChunks:FBTestFrameChunks(2)]);
+  XCTAssertEqual(0, client.droppedFramesCount);
+  // The pending frame is replaced by the most recent one
+  XCTAssertFalse([client enqueueFrameWithChunks:FBTestFrameChunks(3)]);
+  XCTAssertEqual(1, client.droppedFramesCount);
+
+  NSUInteger frameSize = 0;
+  [client frameDidFinishWritingWithSize:&frameSize duration:NULL];
+  XCTAssertEqual(1, frameSize);
+  XCTAssertEqual(1, client.deliveredFramesCount);
+  [client frameDidFinishWritingWithSize:&frameSize duration:NULL];
+  XCTAssertEqual(3, frameSize);
+  XCTAssertEqual(2, client.deliveredFramesCount);
+
+  // Nothing is pending anymore, so the next frame is written immediately
+  XCTAssertTrue([client enqueueFrameWithChunks:FBTestFrameChunks(4)]);
+  [client frameDidFinishWritingWithSize:&frameSize duration:NULL];
+  XCTAssertEqual(4, frameSize);
+  XCTAssertEqual(3, client.deliveredFramesCount);
+  XCTAssertEqual(1, client.droppedFramesCount);
+}
+
+@end
@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBConfiguration.h"
+#import "FBMjpegServer-Private.h"
+#import "GCDAsyncSocket.h"
+
+static NSData *FBTestJpegData(uint8_t metadataByte, uint8_t scanByte)
+{
+  const uint8_t bytes[] = {
+    0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x03, metadataByte,
+    0xFF, 0xDA, 0x00, 0x02, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, scanByte,
+    0xFF, 0xD9,
+  };
+  return [NSData dataWithBytes:bytes length:sizeof(bytes)];
+}
+
+@interface FBMjpegClientDouble : FBMjpegClient
+@property (nonatomic, readonly) NSMutableArray<NSArray<NSData *> *> *enqueuedFrames;
+@end
+
+@implementation FBMjpegClientDouble
+
+- (instancetype)initWithSocket:(GCDAsyncSocket *)socket
+{
+  if ((self = [super initWithSocket:socket])) {
+    _enqueuedFrames = [NSMutableArray array];
+  }
+  return self;
+}
+
+- (BOOL)enqueueFrameWithChunks:(NSArray<NSData *> *)chunks
+{
+  [self.enqueuedFrames addObject:chunks];
+  return YES;
+}
+
+@end
+
+@interface FBMjpegIdleFramesTests : XCTestCase
+@property (nonatomic) NSTimeInterval maxIdleIntervalValue;
+@property (nonatomic) BOOL adaptiveStreamingValue;
+@end
+
+@implementation FBMjpegIdleFramesTests
+
+- (void)setUp
+{
+  [super setUp];
+  self.maxIdleIntervalValue = FBConfiguration.mjpegMaxIdleInterval;
+  self.adaptiveStreamingValue = FBConfiguration.mjpegAdaptiveStreaming;
+  [FBConfiguration setMjpegAdaptiveStreaming:NO];
+}
+
+- (void)tearDown
+{
+  [FBConfiguration setMjpegMaxIdleInterval:self.maxIdleIntervalValue];
+  [FBConfiguration setMjpegAdaptiveStreaming:self.adaptiveStreamingValue];
+  [super tearDown];
+}
+
+- (FBMjpegStreamProfile *)profileWithRequestLine:(NSString *)requestLine
+{
+  NSString *request = [NSString stringWithFormat:@"%@\r\nHost: localhost\r\n\r\n", requestLine];
+  return [FBMjpegStreamProfile profileWithRequestData:(NSData *)[request dataUsingEncoding:NSUTF8StringEncoding]];
+}
+
+- (FBMjpegStreamPipeline *)pipelineWithRequestLine:(NSString *)requestLine
+{
+  FBMjpegStreamPipeline *pipeline = [[FBMjpegStreamPipeline alloc] initWithProfile:[self profileWithRequestLine:requestLine]];
+  [pipeline updateParametersWithTimeStarted:NSEC_PER_SEC];
+  return pipeline;
+}
+
+#pragma mark - FBJpegFrameFingerprint
+
+- (void)testFingerprintIgnoresMetadata
+{
+  XCTAssertEqual(FBJpegFrameFingerprint(FBTestJpegData(1, 1), 50), FBJpegFrameFingerprint(FBTestJpegData(2, 1), 50));
+}
+
+- (void)testFingerprintChangesWithScanOrScalingFactor
+{
+  uint64_t fingerprint = FBJpegFrameFingerprint(FBTestJpegData(1, 1), 50);
+  XCTAssertNotEqual(fingerprint, FBJpegFrameFingerprint(FBTestJpegData(1, 2), 50));
+  XCTAssertNotEqual(fingerprint, FBJpegFrameFingerprint(FBTestJpegData(1, 1), 25));
+}
+
+- (void)testFingerprintOfDataWithoutScan
+{
+  const uint8_t bytes[] = {0x01, 0x02, 0x03};
+  const uint8_t otherBytes[] = {0x01, 0x02, 0x04};
+  XCTAssertNotEqual(FBJpegFrameFingerprint([NSData dataWithBytes:bytes length:sizeof(bytes)], 100),
+                    FBJpegFrameFingerprint([NSData dataWithBytes:otherBytes length:sizeof(otherBytes)], 100));
+}
+
+#pragma mark - FBMjpegStreamPipeline
+
+- (void)testFramesAreNotSkippedIfIdleSuppressionIsDisabled
+{
+  [FBConfiguration setMjpegMaxIdleInterval:0];
+  FBMjpegStreamPipeline *pipeline = [self pipelineWithRequestLine:@"GET / HTTP/1.1"];
+  NSData *frame = FBTestJpegData(1, 1);
+  XCTAssertFalse([pipeline shouldSkipFrameWithData:frame timeStarted:NSEC_PER_SEC]);
+  XCTAssertFalse([pipeline shouldSkipFrameWithData:frame timeStarted:NSEC_PER_SEC + NSEC_PER_MSEC]);
+}
+
+- (void)testUnchangedFramesAreRepeatedAfterIdleInterval
+{
+  [FBConfiguration setMjpegMaxIdleInterval:1.0];
+  FBMjpegStreamPipeline *pipeline = [self pipelineWithRequestLine:@"GET / HTTP/1.1"];
+  FBMjpegClientDouble *client = [[FBMjpegClientDouble alloc] initWithSocket:[[GCDAsyncSocket alloc] init]];
+  [pipeline.clients addObject:client];
+  NSData *frame = FBTestJpegData(1, 1);
+  uint64_t timeStarted = NSEC_PER_SEC;
+
+  XCTAssertFalse([pipeline shouldSkipFrameWithData:frame timeStarted:timeStarted]);
+  [pipeline sendScreenshot:frame];
+  XCTAssertEqual(1, client.enqueuedFrames.count);
+
+  XCTAssertTrue([pipeline shouldSkipFrameWithData:FBTestJpegData(2, 1) timeStarted:timeStarted + 500 * NSEC_PER_MSEC]);
+  XCTAssertEqual(1, client.enqueuedFrames.count);
+  // The recent frame is repeated as is to keep the connection alive
+  XCTAssertTrue([pipeline shouldSkipFrameWithData:frame timeStarted:timeStarted + 1500 * NSEC_PER_MSEC]);
+  XCTAssertEqual(2, client.enqueuedFrames.count);
+  XCTAssertEqual(client.enqueuedFrames.firstObject, client.enqueuedFrames.lastObject);
+  XCTAssertTrue([pipeline shouldSkipFrameWithData:frame timeStarted:timeStarted + 2000 * NSEC_PER_MSEC]);
+  XCTAssertEqual(2, client.enqueuedFrames.count);
+
+  XCTAssertFalse([pipeline shouldSkipFrameWithData:FBTestJpegData(1, 2) timeStarted:timeStarted + 2100 * NSEC_PER_MSEC]);
+  pipeline.lastFrameFingerprint = 0;
+  XCTAssertFalse([pipeline shouldSkipFrameWithData:FBTestJpegData(1, 2) timeStarted:timeStarted + 2200 * NSEC_PER_MSEC]);
+}
+
+- (void)testUnchangedFrameIsEncodedIfThereIsNothingToRepeat
+{
+  [FBConfiguration setMjpegMaxIdleInterval:1.0];
+  FBMjpegStreamPipeline *pipeline = [self pipelineWithRequestLine:@"GET / HTTP/1.1"];
+  NSData *frame = FBTestJpegData(1, 1);
+  XCTAssertFalse([pipeline shouldSkipFrameWithData:frame timeStarted:NSEC_PER_SEC]);
+  XCTAssertNil(pipeline.lastFrameChunks);
+  XCTAssertFalse([pipeline shouldSkipFrameWithData:frame timeStarted:NSEC_PER_SEC + 1500 * NSEC_PER_MSEC]);
+}
+
+@end
@@ -0,0 +1,161 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <XCTest/XCTest.h>
+#import <UIKit/UIKit.h>
+
+#import "FBConfiguration.h"
+#import "FBMjpegServer-Private.h"
+
+static NSData *FBTestJpegImage(CGFloat compressionQuality)
+{
+  UIGraphicsImageRendererFormat *format = [[UIGraphicsImageRendererFormat alloc] init];
+  format.scale = 1.0;
+  UIGraphicsImageRenderer *renderer = [[UIGraphicsImageRenderer alloc] initWithSize:CGSizeMake(64, 64) format:format];
+  return [renderer JPEGDataWithCompressionQuality:compressionQuality actions:^(UIGraphicsImageRendererContext *context) {
+    // Small colored cells make the encoded size depend on the compression quality
+    for (NSUInteger i = 0; i < 64 * 64 / 4; i++) {
+      [[UIColor colorWithHue:(i * 37 % 101) / 100.0 saturation:1.0 brightness:1.0 alpha:1.0] setFill];
+      [context fillRect:CGRectMake(i % 32 * 2, i / 32 * 2, 2, 2)];
+    }
+  }];
+}
+
+@interface FBMjpegStreamPipelineTests : XCTestCase
+@property (nonatomic) NSTimeInterval maxIdleIntervalValue;
+@property (nonatomic) BOOL adaptiveStreamingValue;
+@end
+
+@implementation FBMjpegStreamPipelineTests
+
+- (void)setUp
+{
+  [super setUp];
+  self.maxIdleIntervalValue = FBConfiguration.mjpegMaxIdleInterval;
+  self.adaptiveStreamingValue = FBConfiguration.mjpegAdaptiveStreaming;
+  [FBConfiguration setMjpegAdaptiveStreaming:NO];
+}
+
+- (void)tearDown
+{
+  [FBConfiguration setMjpegMaxIdleInterval:self.maxIdleIntervalValue];
+  [FBConfiguration setMjpegAdaptiveStreaming:self.adaptiveStreamingValue];
+  [super tearDown];
+}
+
+- (FBMjpegStreamProfile *)profileWithRequestLine:(NSString *)requestLine
+{
+  NSString *request = [NSString stringWithFormat:@"%@\r\nHost: localhost\r\n\r\n", requestLine];
+  return [FBMjpegStreamProfile profileWithRequestData:(NSData *)[request dataUsingEncoding:NSUTF8StringEncoding]];
+}
+
+- (FBMjpegStreamPipeline *)pipelineWithRequestLine:(NSString *)requestLine
+{
+  FBMjpegStreamPipeline *pipeline = [[FBMjpegStreamPipeline alloc] initWithProfile:[self profileWithRequestLine:requestLine]];
+  [pipeline updateParametersWithTimeStarted:NSEC_PER_SEC];
+  return pipeline;
+}
+
+#pragma mark - FBMjpegStreamProfile
+
+- (void)testProfileParsing
+{
+  FBMjpegStreamProfile *profile = [self profileWithRequestLine:@"GET /?framerate=5&quality=40&scalingFactor=25.5&foo=1 HTTP/1.1"];
+  XCTAssertEqualObjects(@5, profile.framerate);
+  XCTAssertEqualObjects(@40, profile.quality);
+  XCTAssertEqualObjects(@25.5, profile.scalingFactor);
+  XCTAssertEqual(5, profile.maxFramerate);
+  XCTAssertEqual(40, profile.maxQuality);
+  XCTAssertEqualWithAccuracy(25.5, profile.maxScalingFactor, 0.001);
+}
+
+- (void)testProfileValuesAreClamped
+{
+  FBMjpegStreamProfile *profile = [self profileWithRequestLine:@"GET /?framerate=1000&quality=200&scalingFactor=150 HTTP/1.1"];
+  XCTAssertEqualObjects(@60, profile.framerate);
+  XCTAssertEqualObjects(@100, profile.quality);
+  XCTAssertEqualObjects(@100, profile.scalingFactor);
+
+  profile = [self profileWithRequestLine:@"GET /?framerate=0.5&quality=0.5 HTTP/1.1"];
+  XCTAssertEqualObjects(@1, profile.framerate);
+  XCTAssertEqualObjects(@1, profile.quality);
+}
+
+- (void)testInvalidProfileValuesFollowConfiguration
+{
+  FBMjpegStreamProfile *profile = [self profileWithRequestLine:@"GET /?framerate=0&quality=-5&scalingFactor=abc HTTP/1.1"];
+  XCTAssertNil(profile.framerate);
+  XCTAssertNil(profile.quality);
+  XCTAssertNil(profile.scalingFactor);
+  XCTAssertEqual(FBConfiguration.mjpegServerScreenshotQuality, profile.maxQuality);
+  XCTAssertEqualWithAccuracy(FBConfiguration.mjpegScalingFactor, profile.maxScalingFactor, 0.001);
+
+  profile = [FBMjpegStreamProfile profileWithRequestData:(NSData *)[@"garbage" dataUsingEncoding:NSUTF8StringEncoding]];
+  XCTAssertNil(profile.framerate);
+  XCTAssertNil(profile.quality);
+  XCTAssertNil(profile.scalingFactor);
+}
+
+- (void)testProfileEquality
+{
+  FBMjpegStreamProfile *profile = [self profileWithRequestLine:@"GET /?framerate=5&scalingFactor=10 HTTP/1.1"];
+  FBMjpegStreamProfile *sameProfile = [self profileWithRequestLine:@"GET /stream?scalingFactor=10&framerate=5 HTTP/1.0"];
+  XCTAssertEqualObjects(profile, sameProfile);
+  XCTAssertEqual(profile.hash, sameProfile.hash);
+  XCTAssertNotEqualObjects(profile, [self profileWithRequestLine:@"GET /?framerate=5 HTTP/1.1"]);
+  XCTAssertNotEqualObjects(profile, [self profileWithRequestLine:@"GET /?framerate=5&scalingFactor=10&quality=10 HTTP/1.1"]);
+  XCTAssertEqualObjects([self profileWithRequestLine:@"GET / HTTP/1.1"], [self profileWithRequestLine:@"GET /?foo=bar HTTP/1.1"]);
+}
+
+#pragma mark - FBMjpegStreamPipeline
+
+- (void)testFrameIsDueAtPipelineFramerate
+{
+  FBMjpegStreamPipeline *pipeline = [self pipelineWithRequestLine:@"GET /?framerate=10 HTTP/1.1"];
+  uint64_t tickInterval = NSEC_PER_SEC / 60;
+  uint64_t timeStarted = NSEC_PER_SEC;
+  XCTAssertTrue([pipeline isFrameDueWithTimeStarted:timeStarted tickInterval:tickInterval]);
+  XCTAssertFalse([pipeline isFrameDueWithTimeStarted:timeStarted + 50 * NSEC_PER_MSEC tickInterval:tickInterval]);
+  // Less than a half of the tick is missing to the frame interval
+  XCTAssertTrue([pipeline isFrameDueWithTimeStarted:timeStarted + 92 * NSEC_PER_MSEC tickInterval:tickInterval]);
+  // The frame time is counted from the recently due tick
+  XCTAssertFalse([pipeline isFrameDueWithTimeStarted:timeStarted + 150 * NSEC_PER_MSEC tickInterval:tickInterval]);
+  XCTAssertTrue([pipeline isFrameDueWithTimeStarted:timeStarted + 200 * NSEC_PER_MSEC tickInterval:tickInterval]);
+}
+
+- (NSData *)sentFrameWithPipeline:(FBMjpegStreamPipeline *)pipeline
+{
+  NSPredicate *predicate = [NSPredicate predicateWithBlock:^BOOL(FBMjpegStreamPipeline *evaluatedPipeline, NSDictionary *bindings) {
+    return nil != evaluatedPipeline.lastFrameChunks;
+  }];
+  [self waitForExpectations:@[[[XCTNSPredicateExpectation alloc] initWithPredicate:predicate object:pipeline]]
+                    timeout:5.0];
+  return (NSData *)pipeline.lastFrameChunks[1];
+}
+
+- (void)testCaptureIsReencodedToQualityOfEachPipeline
+{
+  [FBConfiguration setMjpegMaxIdleInterval:0];
+  FBMjpegStreamPipeline *highQualityPipeline = [self pipelineWithRequestLine:@"GET /?quality=100&scalingFactor=100 HTTP/1.1"];
+  FBMjpegStreamPipeline *lowQualityPipeline = [self pipelineWithRequestLine:@"GET /?quality=10&scalingFactor=100 HTTP/1.1"];
+  // The screen is captured with the highest quality among due pipelines
+  NSData *capture = FBTestJpegImage(1.0);
+  for (FBMjpegStreamPipeline *pipeline in @[highQualityPipeline, lowQualityPipeline]) {
+    [pipeline submitScreenshot:capture
+            compressionQuality:1.0
+                   timeStarted:NSEC_PER_SEC
+                  timeCaptured:NSEC_PER_SEC];
+  }
+
+  XCTAssertEqualObjects(capture, [self sentFrameWithPipeline:highQualityPipeline]);
+  NSData *lowQualityFrame = [self sentFrameWithPipeline:lowQualityPipeline];
+  XCTAssertLessThan(lowQualityFrame.length, capture.length);
+  XCTAssertNotNil([UIImage imageWithData:lowQualityFrame]);
+}
+
+@end
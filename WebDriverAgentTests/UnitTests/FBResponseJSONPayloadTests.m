@@ -0,0 +1,140 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBConfiguration.h"
+#import "FBResponseJSONPayload-Private.h"
+#import "HTTPResponse.h"
+#import "RouteResponse.h"
+
+static BOOL FBIsValidUTF8Bytes(NSArray<NSNumber *> *values)
+{
+  NSMutableData *data = [NSMutableData dataWithLength:values.count];
+  uint8_t *bytes = (uint8_t *)data.mutableBytes;
+  for (NSUInteger i = 0; i < values.count; i++) {
+    bytes[i] = values[i].unsignedCharValue;
+  }
+  return FBIsValidUTF8((const uint8_t *)data.bytes, data.length);
+}
+
+@interface FBResponseJSONPayloadTests : XCTestCase
+@property (nonatomic) BOOL compactJsonResponsesValue;
+@end
+
+@implementation FBResponseJSONPayloadTests
+
+- (void)setUp
+{
+  [super setUp];
+  self.compactJsonResponsesValue = FBConfiguration.compactJsonResponses;
+}
+
+- (void)tearDown
+{
+  [FBConfiguration setCompactJsonResponses:self.compactJsonResponsesValue];
+  [super tearDown];
+}
+
+- (void)testValidUTF8
+{
+  XCTAssertTrue(FBIsValidUTF8Bytes(@[]));
+  XCTAssertTrue(FBIsValidUTF8Bytes(@[@0x00, @0x41, @0x7F]));
+  // U+00E9, U+20AC and U+1F600
+  XCTAssertTrue(FBIsValidUTF8Bytes(@[@0xC3, @0xA9, @0xE2, @0x82, @0xAC, @0xF0, @0x9F, @0x98, @0x80]));
+  // The smallest and the largest code points of each sequence length
+  XCTAssertTrue(FBIsValidUTF8Bytes(@[@0xC2, @0x80, @0xDF, @0xBF]));
+  XCTAssertTrue(FBIsValidUTF8Bytes(@[@0xE0, @0xA0, @0x80, @0xEF, @0xBF, @0xBF]));
+  XCTAssertTrue(FBIsValidUTF8Bytes(@[@0xF0, @0x90, @0x80, @0x80, @0xF4, @0x8F, @0xBF, @0xBF]));
+  // The code points right before and after surrogates
+  XCTAssertTrue(FBIsValidUTF8Bytes(@[@0xED, @0x9F, @0xBF, @0xEE, @0x80, @0x80]));
+}
+
+- (void)testInvalidUTF8
+{
+  // Unexpected continuation bytes and invalid lead bytes
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0x80]));
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0x41, @0xBF]));
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0xF8, @0x88, @0x80, @0x80, @0x80]));
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0xFF]));
+  // A lead byte followed by a non-continuation byte
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0xC3, @0x41]));
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0xE2, @0x82, @0x41]));
+}
+
+- (void)testOverlongUTF8Sequences
+{
+  // '/' encoded with two, three and four bytes
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0xC0, @0xAF]));
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0xE0, @0x80, @0xAF]));
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0xF0, @0x80, @0x80, @0xAF]));
+  // The largest overlong code points of each sequence length
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0xC1, @0xBF]));
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0xE0, @0x9F, @0xBF]));
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0xF0, @0x8F, @0xBF, @0xBF]));
+}
+
+- (void)testSurrogatesAndOutOfRangeUTF8Sequences
+{
+  // U+D800 and U+DFFF
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0xED, @0xA0, @0x80]));
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0xED, @0xBF, @0xBF]));
+  // An encoded surrogate pair of U+1F600
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0xED, @0xA0, @0xBD, @0xED, @0xB8, @0x80]));
+  // U+110000
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0xF4, @0x90, @0x80, @0x80]));
+}
+
+- (void)testTruncatedUTF8Sequences
+{
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0xC3]));
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0xE2, @0x82]));
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0xF0, @0x9F, @0x98]));
+  XCTAssertFalse(FBIsValidUTF8Bytes(@[@0x41, @0xF0, @0x9F]));
+  // The length must be respected even if there are more bytes in the buffer
+  const uint8_t bytes[] = {0xC3, 0xA9};
+  XCTAssertFalse(FBIsValidUTF8(bytes, 1));
+}
+
+- (NSData *)dispatchPayloadWithDictionary:(NSDictionary *)dictionary compact:(BOOL)compact
+{
+  [FBConfiguration setCompactJsonResponses:compact];
+  FBResponseJSONPayload *payload = [[FBResponseJSONPayload alloc] initWithDictionary:dictionary
+                                                                      httpStatusCode:kHTTPStatusCodeOK];
+  RouteResponse *response = [[RouteResponse alloc] initWithConnection:nil];
+  [payload dispatchWithResponse:response];
+  XCTAssertEqual(200, response.statusCode);
+
+  NSMutableData *body = [NSMutableData data];
+  while (![response.response isDone]) {
+    [body appendData:[response.response readDataOfLength:1024]];
+  }
+  return body.copy;
+}
+
+- (void)testCompactAndPrettyOutputsMatch
+{
+  NSDictionary *dictionary = @{
+    @"value": @{
+      @"string": @"é€\U0001F600<>&\"\\\n",
+      @"number": @1.5,
+      @"list": @[@YES, NSNull.null, @{@"nested": @[]}],
+    },
+    @"sessionId": @"123",
+  };
+  NSData *compactData = [self dispatchPayloadWithDictionary:dictionary compact:YES];
+  NSData *prettyData = [self dispatchPayloadWithDictionary:dictionary compact:NO];
+  XCTAssertLessThan(compactData.length, prettyData.length);
+  XCTAssertFalse([[[NSString alloc] initWithData:compactData encoding:NSUTF8StringEncoding] containsString:@"\n"]);
+  id compactResult = [NSJSONSerialization JSONObjectWithData:compactData options:0 error:nil];
+  XCTAssertNotNil(compactResult);
+  XCTAssertEqualObjects(compactResult, [NSJSONSerialization JSONObjectWithData:prettyData options:0 error:nil]);
+  XCTAssertEqualObjects(dictionary, compactResult);
+}
+
+@end
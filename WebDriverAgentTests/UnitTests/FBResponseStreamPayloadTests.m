@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBConfiguration.h"
+#import "FBResponseStreamPayload.h"
+#import "HTTPResponse.h"
+#import "RouteResponse.h"
+
+@interface FBResponseStreamPayloadTests : XCTestCase
+@end
+
+@implementation FBResponseStreamPayloadTests
+
+- (NSDictionary *)dispatchPayloadWithValue:(NSString *)value chunkLength:(NSUInteger)chunkLength
+{
+  FBResponseStreamPayload *payload = [[FBResponseStreamPayload alloc] initWithValueData:[value dataUsingEncoding:NSUTF8StringEncoding]
+                                                                               sessionId:@"123"
+                                                                          httpStatusCode:kHTTPStatusCodeOK];
+  RouteResponse *response = [[RouteResponse alloc] initWithConnection:nil];
+  [payload dispatchWithResponse:response];
+  XCTAssertTrue([response.response isChunked]);
+  XCTAssertEqual(200, response.statusCode);
+
+  NSMutableData *body = [NSMutableData data];
+  while (![response.response isDone]) {
+    NSData *chunk = [response.response readDataOfLength:chunkLength];
+    XCTAssertTrue(chunk.length > 0);
+    [body appendData:chunk];
+  }
+  return [NSJSONSerialization JSONObjectWithData:body options:0 error:nil];
+}
+
+- (void)testStreamedValueIsEscaped
+{
+  NSString *value = @"<?xml version=\"1.0\"?>\n<a b=\"\\c\">\t\u00e9\u0001</a>";
+  for (NSNumber *chunkLength in @[@1, @7, @64, @65536]) {
+    NSDictionary *result = [self dispatchPayloadWithValue:value chunkLength:chunkLength.unsignedIntegerValue];
+    XCTAssertEqualObjects(value, result[@"value"]);
+    XCTAssertEqualObjects(@"123", result[@"sessionId"]);
+  }
+}
+
+- (void)testCompactStreamedValue
+{
+  [FBConfiguration setCompactJsonResponses:YES];
+  NSDictionary *result = [self dispatchPayloadWithValue:@"<a/>" chunkLength:1024];
+  [FBConfiguration setCompactJsonResponses:NO];
+  XCTAssertEqualObjects(@"<a/>", result[@"value"]);
+  XCTAssertEqualObjects(@"123", result[@"sessionId"]);
+}
+
+- (void)testEmptyValue
+{
+  NSDictionary *result = [self dispatchPayloadWithValue:@"" chunkLength:1024];
+  XCTAssertEqualObjects(@"", result[@"value"]);
+}
+
+@end
@@ -8,7 +8,11 @@
 
 #import <XCTest/XCTest.h>
 
+@import UniformTypeIdentifiers;
+
 #import "FBRoute.h"
+#import "FBRouteRequest.h"
+#import "FBScreenshot-Private.h"
 
 @class RouteResponse;
 
@@ -73,6 +77,21 @@
   [self waitForExpectationsWithTimeout:0.0 handler:nil];
 }
 
+- (void)testRouteRequiresMainThreadByDefault
+{
+  FBRoute *route = [[FBRoute GET:@"/"] respondWithBlock:^id<FBResponsePayload>(FBRouteRequest *request) {
+    return nil;
+  }];
+  XCTAssertTrue(route.requiresMainThread);
+}
+
+- (void)testRouteWithoutMainThread
+{
+  FBHandlerMock *mock = [FBHandlerMock new];
+  FBRoute *route = [[FBRoute GET:@"/"].withoutMainThread respondWithTarget:mock action:@selector(someSelector:)];
+  XCTAssertFalse(route.requiresMainThread);
+}
+
 - (void)testRouteWithSessionWithSlash
 {
   FBRoute *route = [[FBRoute POST:@"/deactivateApp"] respondWithTarget:self action:@selector(dummyHandler:)];
@@ -126,4 +145,31 @@
   return nil;
 }
 
+- (BOOL)isCaptureKeptAfterRoute:(FBRoute *)route
+{
+  long long screenID = 2001;
+  NSData *data = [NSData dataWithBytes:"capture" length:7];
+  [FBScreenshot storeCapture:[[FBScreenCapture alloc] initWithData:data
+                                                               uti:UTTypePNG
+                                                compressionQuality:1.0
+                                                          screenID:screenID]];
+  FBRouteRequest *request = [FBRouteRequest routeRequestWithURL:(NSURL *)[NSURL URLWithString:@"/"]
+                                                     parameters:@{}
+                                                      arguments:@{}];
+  [route payloadForRequest:request];
+  return nil != [FBScreenshot cachedDataWithScreenID:screenID
+                                  compressionQuality:1.0
+                                                 uti:UTTypePNG
+                                              maxAge:60];
+}
+
+- (void)testRoutesWithSideEffectsInvalidateScreenCaptures
+{
+  id<FBResponsePayload> (^handler)(FBRouteRequest *) = ^id<FBResponsePayload>(FBRouteRequest *request) {
+    return nil;
+  };
+  XCTAssertFalse([self isCaptureKeptAfterRoute:[[FBRoute POST:@"/"].withoutSession respondWithBlock:handler]]);
+  XCTAssertTrue([self isCaptureKeptAfterRoute:[[FBRoute GET:@"/"].withoutSession.withoutSideEffects respondWithBlock:handler]]);
+}
+
 @end
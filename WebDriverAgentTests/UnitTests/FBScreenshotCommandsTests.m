@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBResponsePayload.h"
+#import "FBRoute.h"
+#import "FBRouteRequest.h"
+#import "FBScreenshotCommands.h"
+
+@interface FBScreenshotCommandsTests : XCTestCase
+@end
+
+@implementation FBScreenshotCommandsTests
+
+- (id<FBResponsePayload>)regionScreenshotPayloadWithArguments:(NSDictionary *)arguments
+{
+  FBRoute *regionRoute = nil;
+  for (FBRoute *route in [FBScreenshotCommands routes]) {
+    if ([route.path isEqualToString:@"/wda/screenshot/region"]) {
+      regionRoute = route;
+      break;
+    }
+  }
+  XCTAssertNotNil(regionRoute);
+  FBRouteRequest *request = [FBRouteRequest routeRequestWithURL:(NSURL *)[NSURL URLWithString:@"/wda/screenshot/region"]
+                                                     parameters:@{}
+                                                      arguments:arguments];
+  return [regionRoute payloadForRequest:request];
+}
+
+- (void)assertInvalidArgumentWithArguments:(NSDictionary *)arguments
+{
+  id<FBResponsePayload> payload = [self regionScreenshotPayloadWithArguments:arguments];
+  XCTAssertEqual(400, payload.httpStatusCode);
+  XCTAssertEqualObjects(@"invalid argument", payload.value[@"error"]);
+}
+
+- (void)testRegionScreenshotArgumentsValidation
+{
+  NSDictionary *rect = @{@"x": @0, @"y": @0, @"width": @10, @"height": @10};
+  [self assertInvalidArgumentWithArguments:@{}];
+  [self assertInvalidArgumentWithArguments:@{@"rect": @"0,0,10,10"}];
+  [self assertInvalidArgumentWithArguments:@{@"rect": @{@"x": @0, @"y": @0, @"width": @0, @"height": @10}}];
+  [self assertInvalidArgumentWithArguments:@{@"rect": @{@"x": @0, @"y": @0, @"width": @10, @"height": @-10}}];
+  [self assertInvalidArgumentWithArguments:@{@"rect": @{@"x": @"0", @"y": @0, @"width": @10, @"height": @10}}];
+  [self assertInvalidArgumentWithArguments:@{@"rect": @{@"x": @-1, @"y": @0, @"width": @10, @"height": @10}}];
+  [self assertInvalidArgumentWithArguments:@{@"rect": @{@"x": @0, @"y": @-1, @"width": @10, @"height": @10}}];
+  [self assertInvalidArgumentWithArguments:@{@"rect": @{@"x": @0, @"width": @10, @"height": @10}}];
+  [self assertInvalidArgumentWithArguments:@{@"rect": @{@"x": @0, @"y": @0, @"width": @"10", @"height": @10}}];
+  [self assertInvalidArgumentWithArguments:@{@"rect": rect, @"scale": @0}];
+  [self assertInvalidArgumentWithArguments:@{@"rect": rect, @"scale": @-0.5}];
+  [self assertInvalidArgumentWithArguments:@{@"rect": rect, @"scale": @"0.5"}];
+  [self assertInvalidArgumentWithArguments:@{@"rect": rect, @"quality": @0}];
+  [self assertInvalidArgumentWithArguments:@{@"rect": rect, @"quality": @-10}];
+  [self assertInvalidArgumentWithArguments:@{@"rect": rect, @"quality": @[@80]}];
+  [self assertInvalidArgumentWithArguments:@{@"rect": rect, @"format": @"gif"}];
+  [self assertInvalidArgumentWithArguments:@{@"rect": rect, @"format": @1}];
+  [self assertInvalidArgumentWithArguments:@{@"rect": rect, @"format": @[@"png"]}];
+  // Element screenshots are not available without a session
+  [self assertInvalidArgumentWithArguments:@{@"element": @"some-uuid"}];
+  // The padding is validated before the session presence
+  for (id padding in @[@-5, @"5"]) {
+    id<FBResponsePayload> payload = [self regionScreenshotPayloadWithArguments:@{@"element": @"some-uuid", @"padding": padding}];
+    XCTAssertEqual(400, payload.httpStatusCode);
+    XCTAssertTrue([payload.value[@"message"] containsString:@"'padding'"]);
+  }
+}
+
+@end
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBSourceDiffer.h"
+
+@interface FBSourceDifferTests : XCTestCase
+@property (nonatomic) FBSourceDiffer *differ;
+@property (nonatomic) NSArray<NSDictionary *> *baseNodes;
+@end
+
+@implementation FBSourceDifferTests
+
+- (void)setUp
+{
+  [super setUp];
+  self.differ = [[FBSourceDiffer alloc] initWithCapacity:2];
+  self.baseNodes = @[
+    @{@"uid": @"1", @"type": @"Window", @"children": @[@"2", @"3"]},
+    @{@"uid": @"2", @"type": @"Button", @"label": @"OK", @"children": @[]},
+    @{@"uid": @"3", @"type": @"StaticText", @"value": @"Hello", @"children": @[]},
+  ];
+}
+
+- (void)testWholeTreeIsInsertedWithoutBase
+{
+  NSDictionary *diff = [self.differ diffWithNodes:self.baseNodes baseToken:nil excludedAttributes:nil];
+  XCTAssertNotNil(diff[@"token"]);
+  XCTAssertEqualObjects(diff[@"base"], NSNull.null);
+  XCTAssertEqualObjects(diff[@"inserted"], self.baseNodes);
+  XCTAssertEqualObjects(diff[@"removed"], @[]);
+  XCTAssertEqualObjects(diff[@"changed"], @[]);
+}
+
+- (void)testStructuralChanges
+{
+  NSString *baseToken = [self.differ diffWithNodes:self.baseNodes baseToken:nil excludedAttributes:nil][@"token"];
+  NSArray *nodes = @[
+    @{@"uid": @"1", @"type": @"Window", @"children": @[@"2", @"4"]},
+    @{@"uid": @"2", @"type": @"Button", @"children": @[]},
+    @{@"uid": @"4", @"type": @"Alert", @"children": @[]},
+  ];
+  NSDictionary *diff = [self.differ diffWithNodes:nodes baseToken:baseToken excludedAttributes:nil];
+  XCTAssertEqualObjects(diff[@"base"], baseToken);
+  XCTAssertNotEqualObjects(diff[@"token"], baseToken);
+  XCTAssertEqualObjects(diff[@"inserted"], @[nodes[2]]);
+  XCTAssertEqualObjects(diff[@"removed"], @[@"3"]);
+  NSArray *expectedChanges = @[
+    @{@"uid": @"1", @"children": @[@"2", @"4"]},
+    @{@"uid": @"2", @"label": NSNull.null},
+  ];
+  XCTAssertEqualObjects(diff[@"changed"], expectedChanges);
+}
+
+- (void)testWholeTreeIsInsertedIfExcludedAttributesDiffer
+{
+  NSString *baseToken = [self.differ diffWithNodes:self.baseNodes baseToken:nil excludedAttributes:nil][@"token"];
+  NSDictionary *diff = [self.differ diffWithNodes:self.baseNodes
+                                        baseToken:baseToken
+                               excludedAttributes:[NSSet setWithObject:@"visible"]];
+  XCTAssertEqualObjects(diff[@"base"], NSNull.null);
+  XCTAssertEqual([diff[@"inserted"] count], self.baseNodes.count);
+}
+
+- (void)testOldTreesAreForgotten
+{
+  NSString *baseToken = [self.differ diffWithNodes:self.baseNodes baseToken:nil excludedAttributes:nil][@"token"];
+  [self.differ diffWithNodes:self.baseNodes baseToken:nil excludedAttributes:nil];
+  [self.differ diffWithNodes:self.baseNodes baseToken:nil excludedAttributes:nil];
+  NSDictionary *diff = [self.differ diffWithNodes:self.baseNodes baseToken:baseToken excludedAttributes:nil];
+  XCTAssertEqualObjects(diff[@"base"], NSNull.null);
+}
+
+@end
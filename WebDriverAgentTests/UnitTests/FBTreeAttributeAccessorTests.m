@@ -0,0 +1,361 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBBinarySourceWriter.h"
+#import "FBElementHelpers.h"
+#import "FBElementTypeTransformer.h"
+#import "FBMacros.h"
+#import "FBSourceDiffer.h"
+#import "FBXCElementSnapshotWrapper+Helpers.h"
+#import "XCElementSnapshotDouble.h"
+#import "XCUIApplication+FBHelpers-Private.h"
+#import "XCUIElement+FBWebDriverAttributes.h"
+
+@interface XCUIApplication (FBTreeAttributeAccessorTests)
++ (NSDictionary *)dictionaryForElement:(id<FBXCElementSnapshot>)snapshot
+                             recursive:(BOOL)recursive
+                    attributeAccessors:(NSArray<FBTreeAttributeAccessor *> *)attributeAccessors;
++ (NSUInteger)fb_appendElement:(id<FBXCElementSnapshot>)snapshot
+                 toBinarySource:(FBBinarySourceWriter *)writer
+                    parentIndex:(NSUInteger)parentIndex
+             attributeAccessors:(NSArray<FBTreeAttributeAccessor *> *)attributeAccessors;
++ (void)fb_appendElement:(id<FBXCElementSnapshot>)snapshot
+                 withUid:(NSString *)uid
+               parentUid:(nullable NSString *)parentUid
+              toFlatTree:(NSMutableArray<NSDictionary *> *)nodes
+                usedUids:(NSMutableSet<NSString *> *)usedUids
+      attributeAccessors:(NSArray<FBTreeAttributeAccessor *> *)attributeAccessors;
+@end
+
+@interface FBRecordingBinarySourceWriter : FBBinarySourceWriter
+@property (nonatomic, readonly) NSMutableArray<NSDictionary<NSString *, NSString *> *> *recordedAttributes;
+@end
+
+@implementation FBRecordingBinarySourceWriter
+
+- (instancetype)init
+{
+  if ((self = [super init])) {
+    _recordedAttributes = [NSMutableArray array];
+  }
+  return self;
+}
+
+- (NSUInteger)appendNodeWithParentIndex:(NSUInteger)parentIndex
+                                   type:(NSString *)type
+                                   rect:(CGRect)rect
+                             attributes:(NSDictionary<NSString *, NSString *> *)attributes
+{
+  [self.recordedAttributes addObject:attributes];
+  return [super appendNodeWithParentIndex:parentIndex type:type rect:rect attributes:attributes];
+}
+
+@end
+
+@interface FBTreeAttributeAccessorTests : XCTestCase
+@end
+
+@implementation FBTreeAttributeAccessorTests
+
+- (XCElementSnapshotDouble *)snapshotWithType:(XCUIElementType)elementType
+{
+  XCElementSnapshotDouble *snapshot = [XCElementSnapshotDouble new];
+  snapshot.elementType = elementType;
+  return snapshot;
+}
+
+- (NSDictionary *)treeWithSnapshot:(XCElementSnapshotDouble *)snapshot
+                excludedAttributes:(nullable NSSet<NSString *> *)excludedAttributes
+{
+  return [XCUIApplication dictionaryForElement:(id<FBXCElementSnapshot>)snapshot
+                                     recursive:YES
+                            attributeAccessors:FBTreeAttributeAccessorsExcluding(excludedAttributes)];
+}
+
+- (NSDictionary *)flatTreeNodeWithSnapshot:(XCElementSnapshotDouble *)snapshot
+                        excludedAttributes:(nullable NSSet<NSString *> *)excludedAttributes
+{
+  NSMutableArray<NSDictionary *> *nodes = [NSMutableArray array];
+  [XCUIApplication fb_appendElement:(id<FBXCElementSnapshot>)snapshot
+                            withUid:@"/0"
+                          parentUid:nil
+                         toFlatTree:nodes
+                           usedUids:[NSMutableSet setWithObject:@"/0"]
+                 attributeAccessors:FBTreeAttributeAccessorsExcluding(excludedAttributes)];
+  XCTAssertEqual(1, nodes.count);
+  return nodes.firstObject;
+}
+
+- (NSDictionary<NSString *, NSString *> *)binaryAttributesWithSnapshot:(XCElementSnapshotDouble *)snapshot
+                                                    excludedAttributes:(nullable NSSet<NSString *> *)excludedAttributes
+{
+  FBRecordingBinarySourceWriter *writer = [[FBRecordingBinarySourceWriter alloc] init];
+  [XCUIApplication fb_appendElement:(id<FBXCElementSnapshot>)snapshot
+                     toBinarySource:writer
+                        parentIndex:NSNotFound
+                 attributeAccessors:FBBinarySourceAttributeAccessorsExcluding(excludedAttributes)];
+  XCTAssertEqual(1, writer.recordedAttributes.count);
+  return writer.recordedAttributes.firstObject;
+}
+
+#pragma mark - Legacy attributes
+
+// Mirrors the per-attribute blocks map, which was used before the accessors table was introduced
+- (NSDictionary<NSString *, id> *)legacyAttributesWithSnapshot:(XCElementSnapshotDouble *)snapshot
+                                            excludedAttributes:(nullable NSSet<NSString *> *)excludedAttributes
+                                                  skippedFrame:(BOOL)skippedFrame
+{
+  FBXCElementSnapshotWrapper *wrappedSnapshot = [FBXCElementSnapshotWrapper ensureWrapped:(id<FBXCElementSnapshot>)snapshot];
+  NSMutableDictionary<NSString *, id(^)(void)> *blocks = [@{
+    @"frame": ^{
+      return NSStringFromCGRect(wrappedSnapshot.wdFrame);
+    },
+    @"nativeFrame": ^{
+      return NSStringFromCGRect(wrappedSnapshot.wdNativeFrame);
+    },
+    @"enabled": ^{
+      return [@([wrappedSnapshot isWDEnabled]) stringValue];
+    },
+    @"visible": ^{
+      return [@([wrappedSnapshot isWDVisible]) stringValue];
+    },
+    @"accessible": ^{
+      return [@([wrappedSnapshot isWDAccessible]) stringValue];
+    },
+    @"focused": ^{
+      return [@([wrappedSnapshot isWDFocused]) stringValue];
+    },
+    @"traits": ^{
+      return wrappedSnapshot.wdTraits;
+    },
+  } mutableCopy];
+  XCUIElementType elementType = wrappedSnapshot.elementType;
+  if (FBDoesElementSupportInnerText(elementType)) {
+    blocks[@"placeholderValue"] = ^id {
+      return FBValueOrNull(wrappedSnapshot.wdPlaceholderValue);
+    };
+  }
+  if (FBDoesElementSupportMinMaxValue(elementType)) {
+    blocks[@"minValue"] = ^id {
+      return wrappedSnapshot.wdMinValue;
+    };
+    blocks[@"maxValue"] = ^id {
+      return wrappedSnapshot.wdMaxValue;
+    };
+  }
+
+  NSSet<NSString *> *nonPrefixedKeys = [NSSet setWithObjects:@"frame", @"placeholderValue", @"nativeFrame",
+                                        @"traits", @"minValue", @"maxValue", nil];
+  NSMutableDictionary<NSString *, id> *result = [NSMutableDictionary dictionary];
+  for (NSString *key in blocks) {
+    if ((skippedFrame && [key isEqualToString:@"frame"])
+        || (nil != excludedAttributes && [excludedAttributes containsObject:key])) {
+      continue;
+    }
+    NSString *name = [nonPrefixedKeys containsObject:key]
+      ? key
+      : [NSString stringWithFormat:@"is%@", [key capitalizedString]];
+    result[name] = blocks[key]();
+  }
+  return result.copy;
+}
+
+- (NSDictionary *)legacyTreeWithSnapshot:(XCElementSnapshotDouble *)snapshot
+                      excludedAttributes:(nullable NSSet<NSString *> *)excludedAttributes
+{
+  FBXCElementSnapshotWrapper *wrappedSnapshot = [FBXCElementSnapshotWrapper ensureWrapped:(id<FBXCElementSnapshot>)snapshot];
+  NSMutableDictionary *info = [NSMutableDictionary dictionary];
+  info[@"type"] = [FBElementTypeTransformer shortStringWithElementType:snapshot.elementType];
+  info[@"rawIdentifier"] = FBValueOrNull([snapshot.identifier isEqual:@""] ? nil : snapshot.identifier);
+  info[@"name"] = FBValueOrNull(wrappedSnapshot.wdName);
+  info[@"value"] = FBValueOrNull(wrappedSnapshot.wdValue);
+  info[@"label"] = FBValueOrNull(wrappedSnapshot.wdLabel);
+  info[@"rect"] = wrappedSnapshot.wdRect;
+  [info addEntriesFromDictionary:[self legacyAttributesWithSnapshot:snapshot
+                                                 excludedAttributes:excludedAttributes
+                                                       skippedFrame:NO]];
+  return info.copy;
+}
+
+- (NSDictionary<NSString *, NSString *> *)legacyBinaryAttributesWithSnapshot:(XCElementSnapshotDouble *)snapshot
+                                                          excludedAttributes:(nullable NSSet<NSString *> *)excludedAttributes
+{
+  FBXCElementSnapshotWrapper *wrappedSnapshot = [FBXCElementSnapshotWrapper ensureWrapped:(id<FBXCElementSnapshot>)snapshot];
+  NSMutableDictionary<NSString *, NSString *> *attributes = [NSMutableDictionary dictionary];
+  void (^addAttribute)(NSString *, id) = ^(NSString *name, id value) {
+    if (nil == value || [value isKindOfClass:NSNull.class]) {
+      return;
+    }
+    attributes[name] = [value isKindOfClass:NSString.class] ? value : [value description];
+  };
+  addAttribute(@"rawIdentifier", [snapshot.identifier isEqual:@""] ? nil : snapshot.identifier);
+  addAttribute(@"name", wrappedSnapshot.wdName);
+  addAttribute(@"value", wrappedSnapshot.wdValue);
+  addAttribute(@"label", wrappedSnapshot.wdLabel);
+  [[self legacyAttributesWithSnapshot:snapshot
+                   excludedAttributes:excludedAttributes
+                         skippedFrame:YES] enumerateKeysAndObjectsUsingBlock:^(NSString *name, id value, BOOL *stop) {
+    addAttribute(name, value);
+  }];
+  return attributes.copy;
+}
+
+#pragma mark - Tests
+
+- (void)testAccessorsTable
+{
+  NSArray<FBTreeAttributeAccessor *> *accessors = FBTreeAttributeAccessorsExcluding(nil);
+  NSArray *expectedKeys = @[@"frame", @"nativeFrame", @"enabled", @"visible", @"accessible",
+                            @"focused", @"traits", @"placeholderValue", @"minValue", @"maxValue"];
+  XCTAssertEqualObjects([accessors valueForKey:@"key"], expectedKeys);
+  NSArray *expectedNames = @[@"frame", @"nativeFrame", @"isEnabled", @"isVisible", @"isAccessible",
+                             @"isFocused", @"traits", @"placeholderValue", @"minValue", @"maxValue"];
+  XCTAssertEqualObjects([accessors valueForKey:@"name"], expectedNames);
+  XCTAssertEqualObjects(FBTreeAttributeAccessorsExcluding([NSSet set]), accessors);
+
+  for (FBTreeAttributeAccessor *accessor in accessors) {
+    if ([accessor.key isEqualToString:@"placeholderValue"]) {
+      XCTAssertTrue(accessor.isSupportedByType == FBDoesElementSupportInnerText);
+    } else if ([accessor.key isEqualToString:@"minValue"] || [accessor.key isEqualToString:@"maxValue"]) {
+      XCTAssertTrue(accessor.isSupportedByType == FBDoesElementSupportMinMaxValue);
+    } else {
+      XCTAssertTrue(NULL == accessor.isSupportedByType, @"%@ must be supported by all types", accessor.key);
+    }
+  }
+}
+
+- (void)testBinarySourceAccessorsSkipFrame
+{
+  NSArray *keys = [FBBinarySourceAttributeAccessorsExcluding(nil) valueForKey:@"key"];
+  XCTAssertFalse([keys containsObject:@"frame"]);
+  XCTAssertTrue([keys containsObject:@"nativeFrame"]);
+
+  keys = [FBBinarySourceAttributeAccessorsExcluding([NSSet setWithObject:@"traits"]) valueForKey:@"key"];
+  XCTAssertFalse([keys containsObject:@"frame"]);
+  XCTAssertFalse([keys containsObject:@"traits"]);
+  XCTAssertEqual(FBTreeAttributeAccessorsExcluding(nil).count - 2, keys.count);
+}
+
+- (void)testPrefixedAttributeNames
+{
+  XCElementSnapshotDouble *snapshot = [self snapshotWithType:XCUIElementTypeOther];
+  NSDictionary *tree = [self treeWithSnapshot:snapshot excludedAttributes:nil];
+  NSDictionary *flatNode = [self flatTreeNodeWithSnapshot:snapshot excludedAttributes:nil];
+  NSDictionary *binaryAttributes = [self binaryAttributesWithSnapshot:snapshot excludedAttributes:nil];
+
+  for (NSDictionary *node in @[tree, flatNode, binaryAttributes]) {
+    XCTAssertEqualObjects(node[@"isEnabled"], @"1");
+    XCTAssertEqualObjects(node[@"isFocused"], @"1");
+    XCTAssertNotNil(node[@"isVisible"]);
+    XCTAssertNotNil(node[@"isAccessible"]);
+    XCTAssertEqualObjects(node[@"traits"], @"Button");
+    XCTAssertEqualObjects(node[@"nativeFrame"], NSStringFromCGRect(CGRectZero));
+    for (NSString *key in @[@"enabled", @"visible", @"accessible", @"focused", @"isTraits", @"isNativeFrame"]) {
+      XCTAssertNil(node[key]);
+    }
+  }
+  XCTAssertEqualObjects(tree[@"frame"], NSStringFromCGRect(CGRectZero));
+  XCTAssertEqualObjects(flatNode[@"frame"], NSStringFromCGRect(CGRectZero));
+  XCTAssertNil(binaryAttributes[@"frame"]);
+}
+
+- (void)testExcludedAttributes
+{
+  XCElementSnapshotDouble *snapshot = [self snapshotWithType:XCUIElementTypeTextField];
+  NSSet<NSString *> *excludedAttributes = [NSSet setWithObjects:@"visible", @"enabled", @"nativeFrame", @"placeholderValue", nil];
+  NSDictionary *tree = [self treeWithSnapshot:snapshot excludedAttributes:excludedAttributes];
+  NSDictionary *flatNode = [self flatTreeNodeWithSnapshot:snapshot excludedAttributes:excludedAttributes];
+  NSDictionary *binaryAttributes = [self binaryAttributesWithSnapshot:snapshot excludedAttributes:excludedAttributes];
+
+  for (NSDictionary *node in @[tree, flatNode, binaryAttributes]) {
+    XCTAssertNil(node[@"isVisible"]);
+    XCTAssertNil(node[@"isEnabled"]);
+    XCTAssertNil(node[@"nativeFrame"]);
+    XCTAssertNil(node[@"placeholderValue"]);
+    XCTAssertNotNil(node[@"isAccessible"]);
+    XCTAssertNotNil(node[@"isFocused"]);
+    XCTAssertNotNil(node[@"traits"]);
+    XCTAssertEqualObjects(node[@"label"], @"testLabel");
+  }
+  XCTAssertNotNil(tree[@"frame"]);
+  XCTAssertNotNil(flatNode[@"frame"]);
+
+  // Excluded attributes are matched by their keys rather than by the resulting names
+  tree = [self treeWithSnapshot:snapshot excludedAttributes:[NSSet setWithObjects:@"isVisible", @"frame", nil]];
+  XCTAssertNotNil(tree[@"isVisible"]);
+  XCTAssertNil(tree[@"frame"]);
+}
+
+- (void)testTypeFilteredAttributes
+{
+  XCElementSnapshotDouble *textField = [self snapshotWithType:XCUIElementTypeTextField];
+  NSDictionary *tree = [self treeWithSnapshot:textField excludedAttributes:nil];
+  NSDictionary *flatNode = [self flatTreeNodeWithSnapshot:textField excludedAttributes:nil];
+  NSDictionary *binaryAttributes = [self binaryAttributesWithSnapshot:textField excludedAttributes:nil];
+  for (NSDictionary *node in @[tree, flatNode, binaryAttributes]) {
+    XCTAssertEqualObjects(node[@"placeholderValue"], @"testPlaceholderValue");
+  }
+
+  XCElementSnapshotDouble *other = [self snapshotWithType:XCUIElementTypeOther];
+  tree = [self treeWithSnapshot:other excludedAttributes:nil];
+  flatNode = [self flatTreeNodeWithSnapshot:other excludedAttributes:nil];
+  binaryAttributes = [self binaryAttributesWithSnapshot:other excludedAttributes:nil];
+  for (NSDictionary *node in @[tree, flatNode, binaryAttributes]) {
+    XCTAssertNil(node[@"placeholderValue"]);
+    XCTAssertNil(node[@"minValue"]);
+    XCTAssertNil(node[@"maxValue"]);
+  }
+
+  XCElementSnapshotDouble *slider = [self snapshotWithType:XCUIElementTypeSlider];
+  XCTAssertNil([self treeWithSnapshot:slider excludedAttributes:nil][@"placeholderValue"]);
+}
+
+- (void)testOutputsMatchLegacyAttributes
+{
+  NSArray<NSNumber *> *elementTypes = @[
+    @(XCUIElementTypeOther),
+    @(XCUIElementTypeButton),
+    @(XCUIElementTypeTextField),
+    @(XCUIElementTypeSecureTextField),
+    @(XCUIElementTypeSlider),
+  ];
+  // NSNull stands for nil excluded attributes
+  NSArray *exclusions = @[
+    NSNull.null,
+    [NSSet set],
+    [NSSet setWithObject:@"visible"],
+    [NSSet setWithObjects:@"placeholderValue", @"minValue", nil],
+    [NSSet setWithObjects:@"frame", @"enabled", @"traits", @"nativeFrame", nil],
+    [NSSet setWithObjects:@"accessible", @"focused", @"maxValue", @"unknown", nil],
+  ];
+  for (NSNumber *elementType in elementTypes) {
+    XCElementSnapshotDouble *snapshot = [self snapshotWithType:(XCUIElementType)elementType.unsignedIntegerValue];
+    for (id exclusion in exclusions) {
+      NSSet<NSString *> *excluded = [exclusion isKindOfClass:NSSet.class] ? exclusion : nil;
+      NSDictionary *expectedTree = [self legacyTreeWithSnapshot:snapshot excludedAttributes:excluded];
+
+      XCTAssertEqualObjects([self treeWithSnapshot:snapshot excludedAttributes:excluded], expectedTree,
+                            @"Tree mismatch for type %@ excluding %@", elementType, excluded);
+
+      NSMutableDictionary *expectedFlatNode = expectedTree.mutableCopy;
+      expectedFlatNode[FBSourceDifferUidKey] = @"/0";
+      expectedFlatNode[@"parent"] = NSNull.null;
+      expectedFlatNode[@"children"] = @[];
+      XCTAssertEqualObjects([self flatTreeNodeWithSnapshot:snapshot excludedAttributes:excluded], expectedFlatNode,
+                            @"Flat tree mismatch for type %@ excluding %@", elementType, excluded);
+
+      XCTAssertEqualObjects([self binaryAttributesWithSnapshot:snapshot excludedAttributes:excluded],
+                            [self legacyBinaryAttributesWithSnapshot:snapshot excludedAttributes:excluded],
+                            @"Binary source mismatch for type %@ excluding %@", elementType, excluded);
+    }
+  }
+}
+
+@end
@@ -0,0 +1,240 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "FBCommandHandler.h"
+#import "FBExceptions.h"
+#import "FBWebServer-Private.h"
+#import "HTTPMessage.h"
+#import "RoutingHTTPServer.h"
+
+static const NSTimeInterval FBWebServerTestTimeout = 5.;
+static RoutingHTTPServer *FBTestRoutingServer;
+
+/**
+ Routes the request synchronously and returns the parsed response body
+ or nil if there is no route for the given path
+ */
+static NSDictionary *FBRouteTestRequest(NSString *method, NSString *path, id body)
+{
+  NSURL *url = [NSURL URLWithString:path];
+  HTTPMessage *message = [[HTTPMessage alloc] initRequestWithMethod:method URL:url version:HTTPVersion1_1];
+  if (nil != body) {
+    [message setBody:[NSJSONSerialization dataWithJSONObject:body options:0 error:nil]];
+  }
+  RouteResponse *response = [FBTestRoutingServer routeMethod:method
+                                                    withPath:url.path
+                                                  parameters:@{}
+                                                     request:message
+                                                  connection:nil];
+  if (nil == response) {
+    return nil;
+  }
+  NSMutableData *data = [NSMutableData data];
+  while (nil != response.response && !response.response.isDone) {
+    [data appendData:[response.response readDataOfLength:1024]];
+  }
+  return [NSJSONSerialization JSONObjectWithData:data options:0 error:nil];
+}
+
+@interface FBWebServerTestCommands : NSObject <FBCommandHandler>
+@end
+
+@implementation FBWebServerTestCommands
+
++ (BOOL)shouldRegisterAutomatically
+{
+  return NO;
+}
+
++ (NSArray *)routes
+{
+  return
+  @[
+    [[FBRoute GET:@"/test/mainThread"].withoutSession respondWithBlock:^id<FBResponsePayload>(FBRouteRequest *request) {
+      return FBResponseWithObject(@(NSThread.isMainThread));
+    }],
+    [[FBRoute GET:@"/test/backgroundThread"].withoutSession.withoutMainThread respondWithBlock:^id<FBResponsePayload>(FBRouteRequest *request) {
+      return FBResponseWithObject(@(NSThread.isMainThread));
+    }],
+    [[FBRoute POST:@"/test/waitForBackgroundRoute"].withoutSession respondWithBlock:^id<FBResponsePayload>(FBRouteRequest *request) {
+      // Keeps the main thread busy until a background route responds
+      dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+      dispatch_async(dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+        if (nil != FBRouteTestRequest(@"GET", @"/test/backgroundThread", nil)) {
+          dispatch_semaphore_signal(semaphore);
+        }
+      });
+      intptr_t timedOut = dispatch_semaphore_wait(semaphore, dispatch_time(DISPATCH_TIME_NOW, (int64_t)(FBWebServerTestTimeout * NSEC_PER_SEC)));
+      return FBResponseWithObject(@(0 == timedOut));
+    }],
+    [[FBRoute GET:@"/test/echo/:value"].withoutSession.withoutMainThread respondWithBlock:^id<FBResponsePayload>(FBRouteRequest *request) {
+      return FBResponseWithObject(request.parameters[@"value"]);
+    }],
+    [[FBRoute POST:@"/test/arguments"].withoutSession.withoutMainThread respondWithBlock:^id<FBResponsePayload>(FBRouteRequest *request) {
+      return FBResponseWithObject(request.arguments);
+    }],
+    [[FBRoute GET:@"/test/error"].withoutSession.withoutMainThread respondWithBlock:^id<FBResponsePayload>(FBRouteRequest *request) {
+      [[NSException exceptionWithName:FBInvalidArgumentException reason:@"Test error" userInfo:nil] raise];
+      return FBResponseWithOK();
+    }],
+    [[FBRoute GET:@"/test/unserializable"].withoutSession.withoutMainThread respondWithBlock:^id<FBResponsePayload>(FBRouteRequest *request) {
+      // NaN values make JSON serialization throw while the payload is being dispatched
+      return FBResponseWithObject(@(NAN));
+    }],
+  ];
+}
+
+@end
+
+@interface FBWebServerTests : XCTestCase
+@property (nonatomic) FBWebServer *webServer;
+@end
+
+@implementation FBWebServerTests
+
+- (void)setUp
+{
+  [super setUp];
+  self.webServer = [[FBWebServer alloc] init];
+  [self.webServer setUpServerWithCommandHandlers:@[FBWebServerTestCommands.class]];
+  FBTestRoutingServer = self.webServer.server;
+}
+
+- (void)tearDown
+{
+  FBTestRoutingServer = nil;
+  [super tearDown];
+}
+
+/**
+ Main thread routes are dispatched synchronously to the main queue, thus requests
+ are sent from a background queue while the main run loop keeps spinning
+ */
+- (NSDictionary *)responseWithMethod:(NSString *)method path:(NSString *)path body:(nullable id)body
+{
+  XCTestExpectation *expectation = [self expectationWithDescription:path];
+  __block NSDictionary *result;
+  dispatch_async(dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0), ^{
+    result = FBRouteTestRequest(method, path, body);
+    [expectation fulfill];
+  });
+  [self waitForExpectationsWithTimeout:FBWebServerTestTimeout * 2 handler:nil];
+  return result;
+}
+
+- (void)testRoutesAreDispatchedToTheirQueues
+{
+  XCTAssertEqualObjects(@YES, [self responseWithMethod:@"GET" path:@"/test/mainThread" body:nil][@"value"]);
+  XCTAssertEqualObjects(@NO, [self responseWithMethod:@"GET" path:@"/test/backgroundThread" body:nil][@"value"]);
+}
+
+- (void)testBackgroundRouteRespondsWhileMainThreadIsBusy
+{
+  XCTAssertEqualObjects(@YES, [self responseWithMethod:@"POST" path:@"/test/waitForBackgroundRoute" body:nil][@"value"]);
+}
+
+- (void)testUnknownRoute
+{
+  NSDictionary *response = [self responseWithMethod:@"GET" path:@"/test/unknown" body:nil];
+  XCTAssertEqualObjects(@"unknown command", response[@"value"][@"error"]);
+}
+
+- (void)testPayloadDispatchErrorIsResponded
+{
+  NSDictionary *response = [self responseWithMethod:@"GET" path:@"/test/unserializable" body:nil];
+  XCTAssertEqualObjects(@"unknown error", response[@"value"][@"error"]);
+}
+
+- (NSArray<NSDictionary *> *)batchResultsWithCommands:(NSArray *)commands stopOnError:(BOOL)stopOnError
+{
+  NSDictionary *response = [self responseWithMethod:@"POST"
+                                               path:@"/wda/batch"
+                                               body:@{@"commands": commands, @"stopOnError": @(stopOnError)}];
+  XCTAssertTrue([response[@"value"] isKindOfClass:NSArray.class]);
+  return response[@"value"];
+}
+
+- (void)testBatchResultsKeepCommandsOrder
+{
+  NSArray<NSDictionary *> *results = [self batchResultsWithCommands:@[
+    @{@"method": @"GET", @"path": @"/test/echo/1"},
+    @{@"method": @"post", @"path": @"/test/arguments", @"body": @{@"a": @2}},
+    @{@"method": @"GET", @"path": @"/test/echo/3"},
+  ] stopOnError:NO];
+  NSArray *expected = @[
+    @{@"status": @200, @"value": @"1"},
+    @{@"status": @200, @"value": @{@"a": @2}},
+    @{@"status": @200, @"value": @"3"},
+  ];
+  XCTAssertEqualObjects(expected, results);
+}
+
+- (void)testBatchStopOnError
+{
+  NSArray *commands = @[
+    @{@"method": @"GET", @"path": @"/test/echo/1"},
+    @{@"method": @"GET", @"path": @"/test/error"},
+    @{@"method": @"GET", @"path": @"/test/echo/3"},
+  ];
+  NSArray<NSDictionary *> *results = [self batchResultsWithCommands:commands stopOnError:YES];
+  XCTAssertEqual(2, results.count);
+  XCTAssertEqualObjects(@400, results.lastObject[@"status"]);
+  XCTAssertEqualObjects(@"Test error", results.lastObject[@"value"][@"message"]);
+
+  results = [self batchResultsWithCommands:commands stopOnError:NO];
+  XCTAssertEqual(3, results.count);
+  XCTAssertEqualObjects(@400, results[1][@"status"]);
+  XCTAssertEqualObjects(@"3", results[2][@"value"]);
+}
+
+- (void)testNestedBatchIsRejected
+{
+  NSArray<NSDictionary *> *results = [self batchResultsWithCommands:@[
+    @{@"method": @"POST", @"path": @"/wda/batch", @"body": @{@"commands": @[]}},
+  ] stopOnError:NO];
+  XCTAssertEqual(1, results.count);
+  XCTAssertEqualObjects(@400, results.firstObject[@"status"]);
+  XCTAssertEqualObjects(@"invalid argument", results.firstObject[@"value"][@"error"]);
+}
+
+- (void)testMalformedBatchItems
+{
+  NSArray<NSDictionary *> *results = [self batchResultsWithCommands:@[
+    @"/test/echo/1",
+    @{@"path": @"/test/echo/1"},
+    @{@"method": @"GET"},
+    @{@"method": @"POST", @"path": @"/test/arguments", @"body": @[@1]},
+  ] stopOnError:NO];
+  XCTAssertEqual(4, results.count);
+  for (NSDictionary *result in results) {
+    XCTAssertEqualObjects(@400, result[@"status"]);
+    XCTAssertEqualObjects(@"invalid argument", result[@"value"][@"error"]);
+  }
+
+  NSDictionary *response = [self responseWithMethod:@"POST" path:@"/wda/batch" body:@{@"commands": @"invalid"}];
+  XCTAssertEqualObjects(@"invalid argument", response[@"value"][@"error"]);
+}
+
+- (void)testUnknownBatchEndpoint
+{
+  NSArray<NSDictionary *> *results = [self batchResultsWithCommands:@[
+    @{@"method": @"GET", @"path": @"/test/unknown"},
+    @{@"method": @"GET", @"path": @"/health"},
+    @{@"method": @"GET", @"path": @"/test/echo/3"},
+  ] stopOnError:NO];
+  XCTAssertEqual(3, results.count);
+  XCTAssertEqualObjects(@404, results[0][@"status"]);
+  XCTAssertEqualObjects(@"unknown command", results[0][@"value"][@"error"]);
+  XCTAssertEqualObjects(@404, results[1][@"status"]);
+  XCTAssertEqualObjects(@"unknown command", results[1][@"value"][@"error"]);
+  XCTAssertEqualObjects(@"3", results[2][@"value"]);
+}
+
+@end
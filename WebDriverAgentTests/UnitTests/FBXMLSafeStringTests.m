@@ -32,4 +32,32 @@
   XCTAssertEqualObjects([validString fb_xmlSafeStringWithReplacement:@""], validString);
 }
 
+- (void)testSafeXmlStringIsReturnedAsIs {
+  NSString *validString = @"Tab\tnew\nline \u00e9 👿";
+  XCTAssertEqual([validString fb_xmlSafeStringWithReplacement:@""], validString);
+}
+
+- (void)testSafeXmlStringTransformationWithLoneSurrogates {
+  unichar chars[] = {'a', 0xd83d, 'b', 0x1, 0xde00, 0xd83d, 0xdc7f};
+  NSString *withInvalidChars = [NSString stringWithCharacters:chars length:sizeof(chars) / sizeof(unichar)];
+  XCTAssertEqualObjects([withInvalidChars fb_xmlSafeStringWithReplacement:@"<>"], @"a<>b<><>👿");
+}
+
+- (void)testSafeXmlStringPerformanceForBigTree {
+  // Attribute values of a synthetic 5000 nodes tree
+  NSMutableArray<NSString *> *values = [NSMutableArray array];
+  for (NSUInteger i = 0; i < 5000; i++) {
+    [values addObject:[NSString stringWithFormat:@"XCUIElementTypeCell_%lu", (unsigned long)i]];
+    [values addObject:[NSString stringWithFormat:@"Label %lu with some longer text 👿", (unsigned long)i]];
+    [values addObject:0 == i % 100
+     ? [NSString stringWithFormat:@"value%@%lu", @"\uFFFF", (unsigned long)i]
+     : [NSString stringWithFormat:@"value %lu", (unsigned long)i]];
+  }
+  [self measureBlock:^{
+    for (NSString *value in values) {
+      [value fb_xmlSafeStringWithReplacement:@""];
+    }
+  }];
+}
+
 @end
@@ -8,9 +8,12 @@
 
 #import <XCTest/XCTest.h>
 
+#import "FBConfiguration.h"
 #import "FBMacros.h"
 #import "FBXPath.h"
 #import "FBXPath-Private.h"
+#import "FBXPathDocumentCache.h"
+#import "FBXPathQueryCache.h"
 #import "XCUIElementDouble.h"
 #import "XCElementSnapshotDouble.h"
 #import "FBXCElementSnapshotWrapper+Helpers.h"
@@ -27,14 +30,12 @@
   xmlDocPtr doc;
   
   xmlTextWriterPtr writer = xmlNewTextWriterDoc(&doc, 0);
-  NSMutableDictionary *elementStore = [NSMutableDictionary dictionary];
   int buffersize;
   xmlChar *xmlbuff = NULL;
   int rc = xmlTextWriterStartDocument(writer, NULL, "UTF-8", NULL);
   if (rc >= 0) {
     rc = [FBXPath xmlRepresentationWithRootElement:snapshot
                                             writer:writer
-                                      elementStore:elementStore
                                              query:query
                                excludingAttributes:excludedAttributes];
     if (rc >= 0) {
@@ -48,7 +49,6 @@
   xmlFreeDoc(doc);
   
   XCTAssertTrue(rc >= 0);
-  XCTAssertEqual(1, [elementStore count]);
 
   NSString *result = [NSString stringWithCString:(const char *)xmlbuff encoding:NSUTF8StringEncoding];
   xmlFree(xmlbuff);
@@ -63,7 +63,7 @@
                                         xpathQuery:nil
                                excludingAttributes:nil];
   NSLog(@"[DefaultXPath] Result XML:\n%@", resultXml);
-  NSString *expectedXml = [NSString stringWithFormat:@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<%@ type=\"%@\" value=\"%@\" name=\"%@\" label=\"%@\" enabled=\"%@\" visible=\"%@\" accessible=\"%@\" x=\"%@\" y=\"%@\" width=\"%@\" height=\"%@\" index=\"%lu\" traits=\"%@\" private_indexPath=\"top\"/>\n",
+  NSString *expectedXml = [NSString stringWithFormat:@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<%@ type=\"%@\" value=\"%@\" name=\"%@\" label=\"%@\" enabled=\"%@\" visible=\"%@\" accessible=\"%@\" x=\"%@\" y=\"%@\" width=\"%@\" height=\"%@\" index=\"%lu\" traits=\"%@\"/>\n",
                            element.wdType, element.wdType, element.wdValue, element.wdName, element.wdLabel, FBBoolToString(element.wdEnabled), FBBoolToString(element.wdVisible), FBBoolToString(element.wdAccessible), element.wdRect[@"x"], element.wdRect[@"y"], element.wdRect[@"width"], element.wdRect[@"height"], element.wdIndex, element.wdTraits];
   XCTAssertTrue([resultXml isEqualToString: expectedXml]);
 }
@@ -75,7 +75,7 @@
   NSString *resultXml = [self xmlStringWithElement:(id<FBXCElementSnapshot>)element
                                         xpathQuery:nil
                                excludingAttributes:@[@"type", @"visible", @"value", @"index", @"traits", @"nativeFrame"]];
-  NSString *expectedXml = [NSString stringWithFormat:@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<%@ name=\"%@\" label=\"%@\" enabled=\"%@\" accessible=\"%@\" x=\"%@\" y=\"%@\" width=\"%@\" height=\"%@\" private_indexPath=\"top\"/>\n",
+  NSString *expectedXml = [NSString stringWithFormat:@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<%@ name=\"%@\" label=\"%@\" enabled=\"%@\" accessible=\"%@\" x=\"%@\" y=\"%@\" width=\"%@\" height=\"%@\"/>\n",
                            element.wdType, element.wdName, element.wdLabel, FBBoolToString(element.wdEnabled), FBBoolToString(element.wdAccessible), element.wdRect[@"x"], element.wdRect[@"y"], element.wdRect[@"width"], element.wdRect[@"height"]];
   XCTAssertEqualObjects(resultXml, expectedXml);
 }
@@ -89,7 +89,7 @@
   NSString *resultXml = [self xmlStringWithElement:(id<FBXCElementSnapshot>)element
                                         xpathQuery:[NSString stringWithFormat:@"//%@[@*]", element.wdType]
                                excludingAttributes:@[@"visible"]];
-  NSString *expectedXml = [NSString stringWithFormat:@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<%@ type=\"%@\" value=\"%@\" name=\"%@\" label=\"%@\" enabled=\"%@\" visible=\"%@\" accessible=\"%@\" x=\"%@\" y=\"%@\" width=\"%@\" height=\"%@\" index=\"%lu\" hittable=\"%@\" traits=\"%@\" nativeFrame=\"%@\" private_indexPath=\"top\"/>\n",
+  NSString *expectedXml = [NSString stringWithFormat:@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<%@ type=\"%@\" value=\"%@\" name=\"%@\" label=\"%@\" enabled=\"%@\" visible=\"%@\" accessible=\"%@\" x=\"%@\" y=\"%@\" width=\"%@\" height=\"%@\" index=\"%lu\" hittable=\"%@\" traits=\"%@\" nativeFrame=\"%@\"/>\n",
                            element.wdType, element.wdType, @"йоло&lt;&gt;&amp;&quot;", element.wdName, @"a&#10;b", FBBoolToString(element.wdEnabled), FBBoolToString(element.wdVisible), FBBoolToString(element.wdAccessible), element.wdRect[@"x"], element.wdRect[@"y"], element.wdRect[@"width"], element.wdRect[@"height"], element.wdIndex, FBBoolToString(element.wdHittable), element.wdTraits, NSStringFromCGRect(element.wdNativeFrame)];
   XCTAssertEqualObjects(expectedXml, resultXml);
 }
@@ -101,52 +101,89 @@
   NSString *resultXml = [self xmlStringWithElement:(id<FBXCElementSnapshot>)element
                                         xpathQuery:[NSString stringWithFormat:@"//%@[@%@ and contains(@%@, 'blabla')]", element.wdType, @"value", @"name"]
                                excludingAttributes:nil];
-  NSString *expectedXml = [NSString stringWithFormat:@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<%@ value=\"%@\" name=\"%@\" private_indexPath=\"top\"/>\n",
+  NSString *expectedXml = [NSString stringWithFormat:@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<%@ value=\"%@\" name=\"%@\"/>\n",
                            element.wdType, element.wdValue, element.wdName];
   XCTAssertTrue([resultXml isEqualToString: expectedXml]);
 }
 
-- (void)testSnapshotXPathResultsMatching
+- (void)testSnapshotXPathResultsMatchingWithDirectTree
 {
-  xmlDocPtr doc;
-
-  xmlTextWriterPtr writer = xmlNewTextWriterDoc(&doc, 0);
-  NSMutableDictionary *elementStore = [NSMutableDictionary dictionary];
+  xmlDocPtr doc = xmlNewDoc((const xmlChar *)"1.0");
+  doc->dict = xmlDictCreate();
+  NSMutableArray *snapshotsStore = [NSMutableArray array];
   XCElementSnapshotDouble *snapshot = [XCElementSnapshotDouble new];
   id<FBElement> root = (id<FBElement>)[FBXCElementSnapshotWrapper ensureWrapped:(id)snapshot];
-  NSString *query = [NSString stringWithFormat:@"//%@", root.wdType];
-  int rc = xmlTextWriterStartDocument(writer, NULL, "UTF-8", NULL);
-  if (rc >= 0) {
-    rc = [FBXPath xmlRepresentationWithRootElement:(id<FBXCElementSnapshot>)root
-                                            writer:writer
-                                      elementStore:elementStore
-                                             query:query
-                               excludingAttributes:nil];
-    if (rc >= 0) {
-      rc = xmlTextWriterEndDocument(writer);
-    }
-  }
+  NSString *query = [NSString stringWithFormat:@"//%@[@name]", root.wdType];
+  FBXPathCompiledQuery *compiledQuery = [FBXPath compiledQueryWithQuery:query];
+  XCTAssertNotNil(compiledQuery);
+  NSUInteger hits = FBXPathQueryCache.sharedCache.hits;
+  int rc = [FBXPath xmlTreeWithRootElement:(id<FBXCElementSnapshot>)root
+                                  document:doc
+                            snapshotsStore:snapshotsStore
+                                nodesIndex:nil
+                             compiledQuery:compiledQuery
+                       excludingAttributes:nil];
   if (rc < 0) {
-    xmlFreeTextWriter(writer);
     xmlFreeDoc(doc);
-    XCTFail(@"Unable to create the source XML document");
+    XCTFail(@"Unable to create the source XML tree");
+    return;
   }
+  XCTAssertEqual(1, [snapshotsStore count]);
+  // The tree builder must reuse the given compiled query instead of looking it up again
+  XCTAssertEqual(hits, FBXPathQueryCache.sharedCache.hits);
 
-  xmlXPathObjectPtr queryResult = [FBXPath evaluate:query document:doc contextNode:NULL];
+  xmlXPathObjectPtr queryResult = [FBXPath evaluateCompiledQuery:(FBXPathCompiledQuery *)compiledQuery
+                                                        document:doc
+                                                     contextNode:NULL];
   if (NULL == queryResult) {
-    xmlFreeTextWriter(writer);
     xmlFreeDoc(doc);
-    XCTAssertNotEqual(NULL, queryResult);
+    XCTFail(@"Unable to evaluate the XPath query");
+    return;
   }
 
-  NSArray *matchingSnapshots = [FBXPath collectMatchingSnapshots:queryResult->nodesetval
-                                                    elementStore:elementStore];
+  NSArray *matchingSnapshots = [FBXPath collectMatchingSnapshots:queryResult->nodesetval];
   xmlXPathFreeObject(queryResult);
-  xmlFreeTextWriter(writer);
   xmlFreeDoc(doc);
 
-  XCTAssertNotNil(matchingSnapshots);
   XCTAssertEqual(1, [matchingSnapshots count]);
+  XCTAssertEqual(root, matchingSnapshots.firstObject);
+}
+
+- (void)testXPathDocumentCache
+{
+  FBXPathDocumentCache *cache = [FBXPathDocumentCache new];
+  FBXPathDocument *document = [[FBXPathDocument alloc] initWithDocument:xmlNewDoc((const xmlChar *)"1.0")
+                                                              snapshots:@[]
+                                                             nodesByUid:@{}];
+  [FBConfiguration setXpathDocumentCacheMaxAge:0];
+  [cache setDocument:document forKey:@"key"];
+  XCTAssertNil([cache documentForKey:@"key"]);
+
+  [FBConfiguration setXpathDocumentCacheMaxAge:60];
+  [cache setDocument:document forKey:@"key"];
+  XCTAssertEqual(document, [cache documentForKey:@"key"]);
+  XCTAssertNil([cache documentForKey:@"otherKey"]);
+
+  NSUInteger generation = cache.generation;
+  [cache invalidate];
+  XCTAssertNil([cache documentForKey:@"key"]);
+  XCTAssertEqual(generation + 1, cache.generation);
+  [FBConfiguration setXpathDocumentCacheMaxAge:0];
+}
+
+- (void)testCompiledQueryCaching
+{
+  NSString *query = [NSString stringWithFormat:@"//XCUIElementTypeButton[@hittable='true' and @name='%@']", NSUUID.UUID.UUIDString];
+  NSUInteger hits = FBXPathQueryCache.sharedCache.hits;
+  FBXPathCompiledQuery *compiledQuery = [FBXPath compiledQueryWithQuery:query];
+  XCTAssertNotNil(compiledQuery);
+  XCTAssertTrue(compiledQuery.useNativeSnapshot);
+  XCTAssertEqual(2, [compiledQuery.attributes count]);
+  XCTAssertEqual(hits, FBXPathQueryCache.sharedCache.hits);
+
+  XCTAssertEqual(compiledQuery, [FBXPath compiledQueryWithQuery:query]);
+  XCTAssertEqual(hits + 1, FBXPathQueryCache.sharedCache.hits);
+  XCTAssertNil([FBXPath compiledQueryWithQuery:@"//XCUIElementTypeButton[@name="]);
 }
 
 @end
@@ -31,4 +31,31 @@
   XCTAssertEqualObjects(d, d.fb_utf8SafeDictionary);
 }
 
+- (void)testSafeStringConversion
+{
+  NSString *clean = @"abc \u00e9\U0001F600";
+  XCTAssertEqual(clean, [clean fb_utf8SafeStringWithReplacement:0xfffd]);
+
+  unichar chars[] = {'a', 0xd83d, 'b', 0xde00, 0xd83d, 0xde00, 0xd83d};
+  NSString *broken = [NSString stringWithCharacters:chars length:sizeof(chars) / sizeof(unichar)];
+  unichar expectedChars[] = {'a', '?', 'b', '?', 0xd83d, 0xde00, '?'};
+  NSString *expected = [NSString stringWithCharacters:expectedChars length:sizeof(expectedChars) / sizeof(unichar)];
+  XCTAssertEqualObjects(expected, [broken fb_utf8SafeStringWithReplacement:'?']);
+}
+
+- (void)testSafeStringConversionPerformance
+{
+  NSMutableString *label = [NSMutableString string];
+  unichar loneSurrogate = 0xd83d;
+  for (NSUInteger i = 0; i < 1000; i++) {
+    [label appendString:@"Some label text \u00e9"];
+    [label appendString:[NSString stringWithCharacters:&loneSurrogate length:1]];
+  }
+  [self measureBlock:^{
+    for (NSUInteger i = 0; i < 100; i++) {
+      [label fb_utf8SafeStringWithReplacement:0xfffd];
+    }
+  }];
+}
+
 @end
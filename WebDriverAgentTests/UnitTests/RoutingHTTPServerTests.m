@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2015-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#import <XCTest/XCTest.h>
+
+#import "HTTPMessage.h"
+#import "Route.h"
+#import "RoutingHTTPServer.h"
+
+@interface RoutingHTTPServerTests : XCTestCase
+@property (nonatomic) RoutingHTTPServer *server;
+@property (nonatomic) NSMutableArray<NSString *> *calls;
+@property (nonatomic) NSDictionary *lastParams;
+@end
+
+@implementation RoutingHTTPServerTests
+
+- (void)setUp
+{
+  [super setUp];
+  self.server = [[RoutingHTTPServer alloc] init];
+  self.calls = [NSMutableArray array];
+}
+
+- (void)registerRoute:(NSString *)path method:(NSString *)method
+{
+  __weak typeof(self) weakSelf = self;
+  [self.server handleMethod:method withPath:path block:^(RouteRequest *request, RouteResponse *response) {
+    [weakSelf.calls addObject:path];
+    weakSelf.lastParams = request.params;
+  }];
+}
+
+- (NSString *)dispatch:(NSString *)path method:(NSString *)method
+{
+  [self.calls removeAllObjects];
+  RouteResponse *response = [self.server routeMethod:method
+                                            withPath:path
+                                          parameters:@{}
+                                             request:[[HTTPMessage alloc] initEmptyRequest]
+                                          connection:nil];
+  return nil == response ? nil : self.calls.firstObject;
+}
+
+- (void)testLiteralAndParameterRoutes
+{
+  [self registerRoute:@"/status" method:@"GET"];
+  [self registerRoute:@"/session/:sessionID/element/:uuid/text" method:@"GET"];
+  [self registerRoute:@"/session/:sessionID/element/active" method:@"GET"];
+
+  XCTAssertEqualObjects(@"/status", [self dispatch:@"/STATUS" method:@"GET"]);
+  XCTAssertEqualObjects(@"/status", [self dispatch:@"/status" method:@"HEAD"]);
+  XCTAssertNil([self dispatch:@"/status/" method:@"GET"]);
+  XCTAssertNil([self dispatch:@"/status" method:@"POST"]);
+
+  XCTAssertEqualObjects(@"/session/:sessionID/element/:uuid/text", [self dispatch:@"/session/abc/element/DEF/text" method:@"GET"]);
+  XCTAssertEqualObjects(@"abc", self.lastParams[@"sessionID"]);
+  XCTAssertEqualObjects(@"DEF", self.lastParams[@"uuid"]);
+  XCTAssertNil([self dispatch:@"/session//element/DEF/text" method:@"GET"]);
+  XCTAssertEqualObjects(@"/session/:sessionID/element/active", [self dispatch:@"/session/abc/element/active" method:@"GET"]);
+}
+
+- (void)testEarliestRegisteredRouteWins
+{
+  [self registerRoute:@"/element/:uuid" method:@"GET"];
+  [self registerRoute:@"/element/active" method:@"GET"];
+  [self registerRoute:@"/*" method:@"GET"];
+  [self registerRoute:@"/other" method:@"GET"];
+
+  XCTAssertEqualObjects(@"/element/:uuid", [self dispatch:@"/element/active" method:@"GET"]);
+  XCTAssertEqualObjects(@"/*", [self dispatch:@"/other" method:@"GET"]);
+  XCTAssertEqualObjects(@"/*", [self dispatch:@"/unknown/path" method:@"GET"]);
+  XCTAssertEqualObjects(@[@"unknown/path"], self.lastParams[@"wildcards"]);
+}
+
+- (void)testCustomRegexRoutes
+{
+  [self registerRoute:@"{^/files/(\\w+)\\.json$}" method:@"GET"];
+  [self registerRoute:@"/files/:name" method:@"GET"];
+
+  XCTAssertEqualObjects(@"{^/files/(\\w+)\\.json$}", [self dispatch:@"/files/abc.json" method:@"GET"]);
+  XCTAssertEqualObjects(@[@"abc"], self.lastParams[@"captures"]);
+  XCTAssertEqualObjects(@"/files/:name", [self dispatch:@"/files/abc.xml" method:@"GET"]);
+  XCTAssertEqualObjects(@"abc.xml", self.lastParams[@"name"]);
+}
+
+- (void)testRouteLookupWithoutInvocation
+{
+  Route *route = [self.server handleMethod:@"GET" withPath:@"/element/:uuid" block:^(RouteRequest *request, RouteResponse *response) {
+    XCTFail(@"The route must not be invoked");
+  }];
+  NSDictionary *params = @{@"query": @"1"};
+  XCTAssertEqual(route, [self.server routeForMethod:@"GET" withPath:@"/element/abc" parameters:&params]);
+  XCTAssertEqualObjects((@{@"query": @"1", @"uuid": @"abc"}), params);
+
+  params = @{};
+  XCTAssertNil([self.server routeForMethod:@"POST" withPath:@"/element/abc" parameters:&params]);
+  XCTAssertNil([self.server routeForMethod:@"GET" withPath:@"/other" parameters:&params]);
+}
+
+@end
@@ -3,5 +3,6 @@ export { NoSessionProxy } from './lib/no-session-proxy';
 export { WebDriverAgent } from './lib/webdriveragent';
 export { WDA_BASE_URL, WDA_RUNNER_BUNDLE_ID, PROJECT_FILE } from './lib/constants';
 export { resetTestProcesses, BOOTSTRAP_PATH } from './lib/utils';
+export { decodeBinarySource } from './lib/binary-source';
 
 export * from './lib/types';
@@ -0,0 +1,150 @@
+const MAGIC = 'WDAS';
+const SUPPORTED_VERSION = 1;
+
+/**
+ * @typedef {Object} BinarySourceRect
+ * @property {number} x
+ * @property {number} y
+ * @property {number} width
+ * @property {number} height
+ */
+
+/**
+ * A decoded element. Besides the listed properties, each node has a string property
+ * per element attribute, for example `name`, `label` or `enabled`
+ *
+ * @typedef {Object} BinarySourceNode
+ * @property {string} type The element type, for example 'Button'
+ * @property {BinarySourceRect} rect The element rect in points
+ * @property {BinarySourceNode[]} [children] Child elements if there are any
+ */
+
+class BinarySourceReader {
+  /**
+   * @param {Buffer} buffer
+   */
+  constructor (buffer) {
+    this.buffer = buffer;
+    this.offset = 0;
+  }
+
+  /**
+   * @returns {number}
+   */
+  readByte () {
+    if (this.offset >= this.buffer.length) {
+      throw new Error(`Unexpected end of the binary source at offset ${this.offset}`);
+    }
+    return this.buffer[this.offset++];
+  }
+
+  /**
+   * Reads an unsigned LEB128 varint
+   *
+   * @returns {number}
+   */
+  readVarint () {
+    let result = 0;
+    let multiplier = 1;
+    let byte;
+    do {
+      byte = this.readByte();
+      result += (byte & 0x7f) * multiplier;
+      multiplier *= 0x80;
+    } while (byte & 0x80);
+    return result;
+  }
+
+  /**
+   * Reads a zigzag-encoded signed varint
+   *
+   * @returns {number}
+   */
+  readSignedVarint () {
+    const value = this.readVarint();
+    return value % 2 === 0 ? value / 2 : -(value + 1) / 2;
+  }
+
+  /**
+   * @param {number} length
+   * @returns {string}
+   */
+  readUtf8 (length) {
+    if (this.offset + length > this.buffer.length) {
+      throw new Error(`Unexpected end of the binary source at offset ${this.offset}`);
+    }
+    const result = this.buffer.toString('utf8', this.offset, this.offset + length);
+    this.offset += length;
+    return result;
+  }
+}
+
+/**
+ * Decodes the page source retrieved from WDA with the `binary` format into a nested
+ * structure of `{type, rect, ...attributes, children?}` nodes. It differs from the `json` format:
+ * - attribute values are always strings;
+ * - absent attributes, like a missing `name` or `value`, are omitted instead of being null;
+ * - there is no `frame` attribute, the same information is only available as `rect`.
+ * See WebDriverAgentLib/Utilities/FBBinarySourceWriter.h for the format description.
+ *
+ * @param {Buffer|string} source The binary source buffer or its base64 representation
+ * as returned by the `/source?format=binary` endpoint
+ * @returns {BinarySourceNode|null} The root element or null if the tree is empty
+ * @throws {Error} If the given source cannot be decoded
+ */
+export function decodeBinarySource (source) {
+  const buffer = Buffer.isBuffer(source) ? source : Buffer.from(source, 'base64');
+  const reader = new BinarySourceReader(buffer);
+  const magic = reader.readUtf8(MAGIC.length);
+  if (magic !== MAGIC) {
+    throw new Error('The given data is not a binary page source');
+  }
+  const version = reader.readByte();
+  if (version !== SUPPORTED_VERSION) {
+    throw new Error(`The binary page source version ${version} is not supported. ` +
+      `Only version ${SUPPORTED_VERSION} is`);
+  }
+  const precision = reader.readVarint();
+  /** @type {string[]} */
+  const strings = [];
+  for (let stringsCount = reader.readVarint(); stringsCount > 0; --stringsCount) {
+    strings.push(reader.readUtf8(reader.readVarint()));
+  }
+  const stringAt = (/** @type {number} */ index) => {
+    if (index >= strings.length) {
+      throw new Error(`The string index ${index} is out of range`);
+    }
+    return strings[index];
+  };
+
+  /** @type {BinarySourceNode[]} */
+  const nodes = [];
+  for (let nodesCount = reader.readVarint(); nodesCount > 0; --nodesCount) {
+    const parentIndex = reader.readVarint() - 1;
+    /** @type {BinarySourceNode} */
+    const node = {
+      type: stringAt(reader.readVarint()),
+      rect: {
+        x: reader.readSignedVarint() / precision,
+        y: reader.readSignedVarint() / precision,
+        width: reader.readSignedVarint() / precision,
+        height: reader.readSignedVarint() / precision,
+      },
+    };
+    for (let attributesCount = reader.readVarint(); attributesCount > 0; --attributesCount) {
+      const name = stringAt(reader.readVarint());
+      node[name] = stringAt(reader.readVarint());
+    }
+    if (parentIndex >= 0) {
+      const parent = nodes[parentIndex];
+      if (!parent) {
+        throw new Error(`The parent index ${parentIndex} of the node #${nodes.length} is invalid`);
+      }
+      (parent.children ??= []).push(node);
+    } else if (nodes.length > 0) {
+      throw new Error('The binary page source must only have one root node');
+    }
+    nodes.push(node);
+  }
+  return nodes[0] ?? null;
+}
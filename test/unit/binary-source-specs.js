@@ -0,0 +1,47 @@
+import { decodeBinarySource } from '../../lib/binary-source';
+
+describe('decodeBinarySource', function () {
+  let chai;
+
+  before(async function() {
+    chai = await import('chai');
+    chai.should();
+  });
+
+  // Matches the tree produced by FBBinarySourceWriterTests
+  const source = Buffer.from([
+    0x57, 0x44, 0x41, 0x53, 1, 1,
+    2, 6, 0x42, 0x75, 0x74, 0x74, 0x6f, 0x6e, 4, 0x6e, 0x61, 0x6d, 0x65,
+    2,
+    0, 0, 0, 1, 4, 6, 1, 1, 0,
+    1, 0, 0, 0, 0, 0, 0,
+  ]);
+
+  it('should decode nested nodes', function () {
+    decodeBinarySource(source).should.eql({
+      type: 'Button',
+      rect: {x: 0, y: -1, width: 2, height: 3},
+      name: 'Button',
+      children: [{
+        type: 'Button',
+        rect: {x: 0, y: 0, width: 0, height: 0},
+      }],
+    });
+  });
+
+  it('should decode base64 encoded source', function () {
+    decodeBinarySource(source.toString('base64')).type.should.eql('Button');
+  });
+
+  it('should return null for an empty tree', function () {
+    (decodeBinarySource(Buffer.from([0x57, 0x44, 0x41, 0x53, 1, 1, 0, 0])) === null).should.be.true;
+  });
+
+  it('should fail on truncated source', function () {
+    (() => decodeBinarySource(source.subarray(0, source.length - 1))).should.throw(/Unexpected end/);
+  });
+
+  it('should fail on unknown data', function () {
+    (() => decodeBinarySource(Buffer.from('<xml/>'))).should.throw(/not a binary page source/);
+  });
+});